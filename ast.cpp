@@ -3,6 +3,7 @@
 PyObject *IntNode::accept(NodeVisitor *visitor) { return visitor->visitIntNode(this); }
 PyObject *FloatNode::accept(NodeVisitor *visitor) { return visitor->visitFloatNode(this); }
 PyObject *StringNode::accept(NodeVisitor *visitor) { return visitor->visitStringNode(this); }
+PyObject *FStringNode::accept(NodeVisitor *visitor) { return visitor->visitFStringNode(this); }
 PyObject *BooleanNode::accept(NodeVisitor *visitor) { return visitor->visitBooleanNode(this); }
 PyObject *NullNode::accept(NodeVisitor *visitor) { return visitor->visitNullNode(this); }
 PyObject *NameNode::accept(NodeVisitor *visitor) { return visitor->visitNameNode(this); }
@@ -18,8 +19,19 @@ PyObject *ContinueNode::accept(NodeVisitor *visitor) { return visitor->visitCont
 PyObject *ReturnNode::accept(NodeVisitor *visitor) { return visitor->visitReturnNode(this); }
 PyObject *IfNode::accept(NodeVisitor *visitor) { return visitor->visitIfNode(this); }
 PyObject *WhileNode::accept(NodeVisitor *visitor) { return visitor->visitWhileNode(this); }
+PyObject *ForNode::accept(NodeVisitor *visitor) { return visitor->visitForNode(this); }
 PyObject *FunctionNode::accept(NodeVisitor *visitor) { return visitor->visitFunctionNode(this); }
 PyObject *CallNode::accept(NodeVisitor *visitor) { return visitor->visitCallNode(this); }
+PyObject *InlinedCallNode::accept(NodeVisitor *visitor) { return visitor->visitInlinedCallNode(this); }
+PyObject *ParamNode::accept(NodeVisitor *visitor) { return visitor->visitParamNode(this); }
 PyObject *PropertyNode::accept(NodeVisitor *visitor) { return visitor->visitPropertyNode(this); }
 PyObject *ClassNode::accept(NodeVisitor *visitor) { return visitor->visitClassNode(this); }
-PyObject *PropertyAssignNode::accept(NodeVisitor *visitor) { return visitor->visitPropertyAssignNode(this); }
\ No newline at end of file
+PyObject *PropertyAssignNode::accept(NodeVisitor *visitor) { return visitor->visitPropertyAssignNode(this); }
+PyObject *ListNode::accept(NodeVisitor *visitor) { return visitor->visitListNode(this); }
+PyObject *DictNode::accept(NodeVisitor *visitor) { return visitor->visitDictNode(this); }
+PyObject *SubscriptNode::accept(NodeVisitor *visitor) { return visitor->visitSubscriptNode(this); }
+PyObject *SliceNode::accept(NodeVisitor *visitor) { return visitor->visitSliceNode(this); }
+PyObject *SubscriptAssignNode::accept(NodeVisitor *visitor) { return visitor->visitSubscriptAssignNode(this); }
+PyObject *TupleNode::accept(NodeVisitor *visitor) { return visitor->visitTupleNode(this); }
+PyObject *UnpackAssignNode::accept(NodeVisitor *visitor) { return visitor->visitUnpackAssignNode(this); }
+PyObject *AugAssignNode::accept(NodeVisitor *visitor) { return visitor->visitAugAssignNode(this); }
\ No newline at end of file
@@ -14,6 +14,7 @@ enum class AstNodeType
     Block,
     Print,
     While,
+    For,
     Break,
     Continue,
     Pass,
@@ -25,15 +26,39 @@ enum class AstNodeType
     UnaryOp,
     BinaryOp,
     Assign,
+    PropertyAssign,
+    List,
+    Dict,
+    Subscript,
+    Slice,
+    SubscriptAssign,
+    Tuple,
+    UnpackAssign,
+    AugAssign,
     Call,
+    InlinedCall,
+    Param,
     Name,
     String,
+    FString,
     Int,
     Float,
     Boolean,
     Null
 };
 
+// Result type of an expression as proven by TypeInferencePass.
+// Int means the value is always a PyInt, Float a PyFloat, and so on.
+enum class StaticType : unsigned char
+{
+    Unknown,
+    Int,
+    Float,
+    Bool,
+    Str,
+    None
+};
+
 class AstNode
 {
 public:
@@ -41,6 +66,8 @@ public:
     virtual ~AstNode() = default;
     virtual PyObject *accept(NodeVisitor *visitor) = 0;
     AstNodeType type;
+    StaticType staticType = StaticType::Unknown;
+    int site = -1; // Feedback slot (see profile.hpp); -1 if not profiled
 };
 
 class PassNode : public AstNode
@@ -98,6 +125,29 @@ public:
     AstNode *body;
 };
 
+// Whether a range loop may keep one int box for its variable and update
+// it in place instead of binding a new object every iteration. Decided by
+// TypeInferencePass; without it loops always rebind.
+enum class TargetReuse : unsigned char
+{
+    Never,
+    Always,
+    IfLocal // Only when the variable lives in the current function frame
+};
+
+// for target in iterable: body
+class ForNode : public AstNode
+{
+public:
+    ForNode(Token target, AstNode *iterable, AstNode *body)
+        : AstNode(AstNodeType::For), target(target), iterable(iterable), body(body) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    Token target;
+    AstNode *iterable;
+    AstNode *body;
+    TargetReuse reuse = TargetReuse::Never;
+};
+
 class FunctionNode : public AstNode
 {
 public:
@@ -119,6 +169,33 @@ public:
     std::vector<AstNode *> args;
 };
 
+// A call to a small global function whose body has been substituted at
+// the call site. The inlined expression is evaluated directly with the
+// arguments bound to ParamNodes; if `name` no longer resolves to the
+// function defined by `body`, the original call is executed instead.
+class InlinedCallNode : public AstNode
+{
+public:
+    InlinedCallNode(CallNode *call, const std::string &name, AstNode *body, AstNode *inlined)
+        : AstNode(AstNodeType::InlinedCall), call(call), name(name), body(body), inlined(inlined) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    CallNode *call;
+    std::string name;
+    AstNode *body;
+    AstNode *inlined;
+};
+
+// Reference to the index-th argument of the enclosing InlinedCallNode
+class ParamNode : public AstNode
+{
+public:
+    ParamNode(size_t index, const std::string &name)
+        : AstNode(AstNodeType::Param), index(index), name(name) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    size_t index;
+    std::string name;
+};
+
 class PropertyNode : public AstNode
 {
 public:
@@ -145,6 +222,7 @@ public:
     IntNode(Token value) : AstNode(AstNodeType::Int), value(value) {}
     PyObject *accept(NodeVisitor *visitor) override;
     Token value;
+    PyObject *constant = nullptr; // Boxed value, created on first evaluation
 };
 
 class FloatNode : public AstNode
@@ -153,6 +231,7 @@ public:
     FloatNode(Token value) : AstNode(AstNodeType::Float), value(value) {}
     PyObject *accept(NodeVisitor *visitor) override;
     Token value;
+    PyObject *constant = nullptr; // Boxed value, created on first evaluation
 };
 
 class StringNode : public AstNode
@@ -161,6 +240,50 @@ public:
     StringNode(Token value) : AstNode(AstNodeType::String), value(value) {}
     PyObject *accept(NodeVisitor *visitor) override;
     Token value;
+    PyObject *constant = nullptr; // Boxed value, created on first evaluation
+};
+
+// ==================== F-Strings ====================
+// [[fill]align][sign][#][0][width][grouping][.precision][type], parsed
+// once by the parser. Which fields apply depends on the value's type,
+// which is only known when the f-string is evaluated.
+struct FormatSpec
+{
+    bool empty = true;
+    char fill = ' ';
+    char align = 0; // '<', '>', '^', '=' or 0 for the type's default
+    char sign = '-';
+    bool alternate = false;
+    bool zeroPad = false;
+    size_t width = 0;
+    char grouping = 0;  // ',' or '_'
+    int precision = -1; // -1 if omitted
+    char type = 0;      // Presentation type, 0 if omitted
+};
+
+// Literal text followed by a replacement field; the last segment of an
+// f-string has no field
+struct FStringSegment
+{
+    std::string literal;
+    AstNode *expression = nullptr;
+    std::string source; // The field's expression as written
+    char conversion = 0; // 'r', 's', 'a' or 0
+    FormatSpec spec;
+};
+
+class FStringNode : public AstNode
+{
+public:
+    FStringNode(std::vector<FStringSegment> segments)
+        : AstNode(AstNodeType::FString), segments(std::move(segments))
+    {
+        for (const FStringSegment &segment : this->segments)
+            literalSize += segment.literal.size();
+    }
+    PyObject *accept(NodeVisitor *visitor) override;
+    std::vector<FStringSegment> segments;
+    size_t literalSize = 0; // The output is at least this long
 };
 
 class BooleanNode : public AstNode
@@ -169,6 +292,7 @@ public:
     BooleanNode(Token value) : AstNode(AstNodeType::Boolean), value(value) {}
     PyObject *accept(NodeVisitor *visitor) override;
     Token value;
+    PyObject *constant = nullptr; // Boxed value, created on first evaluation
 };
 
 class NullNode : public AstNode
@@ -221,13 +345,115 @@ class PropertyAssignNode : public AstNode
 {
 public:
     PropertyAssignNode(AstNode *object, const std::string &property, AstNode *value)
-        : AstNode(AstNodeType::Assign), object(object), property(property), value(value) {}
+        : AstNode(AstNodeType::PropertyAssign), object(object), property(property), value(value) {}
     PyObject *accept(NodeVisitor *visitor) override;
     AstNode *object;
     std::string property;
     AstNode *value;
 };
 
+// [a, b, c]; evaluates to a new PyList every time
+class ListNode : public AstNode
+{
+public:
+    ListNode(std::vector<AstNode *> elements)
+        : AstNode(AstNodeType::List), elements(elements) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    std::vector<AstNode *> elements;
+};
+
+// {k: v, ...}; evaluates to a new PyDict every time
+class DictNode : public AstNode
+{
+public:
+    DictNode(std::vector<AstNode *> keys, std::vector<AstNode *> values)
+        : AstNode(AstNodeType::Dict), keys(keys), values(values) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    std::vector<AstNode *> keys;
+    std::vector<AstNode *> values;
+};
+
+// object[index]; index is a SliceNode for object[start:stop:step]
+class SubscriptNode : public AstNode
+{
+public:
+    SubscriptNode(AstNode *object, AstNode *index)
+        : AstNode(AstNodeType::Subscript), object(object), index(index) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    AstNode *object;
+    AstNode *index;
+};
+
+// start:stop:step inside a subscript; omitted parts are nullptr
+class SliceNode : public AstNode
+{
+public:
+    SliceNode(AstNode *start, AstNode *stop, AstNode *step)
+        : AstNode(AstNodeType::Slice), start(start), stop(stop), step(step) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    AstNode *start;
+    AstNode *stop;
+    AstNode *step;
+};
+
+class SubscriptAssignNode : public AstNode
+{
+public:
+    SubscriptAssignNode(AstNode *object, AstNode *index, AstNode *value)
+        : AstNode(AstNodeType::SubscriptAssign), object(object), index(index), value(value) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    AstNode *object;
+    AstNode *index;
+    AstNode *value;
+};
+
+// (a, b) or a bare `a, b` in an assignment or return; evaluates to a new
+// PyTuple unless the interpreter can bind the elements directly
+class TupleNode : public AstNode
+{
+public:
+    TupleNode(std::vector<AstNode *> elements)
+        : AstNode(AstNodeType::Tuple), elements(elements) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    std::vector<AstNode *> elements;
+};
+
+// a, b = value; each target is a Name, Property or (non-slice) Subscript
+class UnpackAssignNode : public AstNode
+{
+public:
+    UnpackAssignNode(std::vector<AstNode *> targets, AstNode *value)
+        : AstNode(AstNodeType::UnpackAssign), targets(targets), value(value) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    std::vector<AstNode *> targets;
+    AstNode *value;
+};
+
+// target op= value, for a Name, Property or Subscript target. `operation`
+// is `target op value` with the target node itself as the left operand;
+// it carries the profiling site and inferred type of the arithmetic. The
+// interpreter evaluates the target's object and index once and reads and
+// writes the item through them.
+class AugAssignNode : public AstNode
+{
+public:
+    AugAssignNode(AstNode *target, Token op, AstNode *value)
+        : AstNode(AstNodeType::AugAssign), target(target), operation(new BinaryOpNode(target, op, value)) {}
+    PyObject *accept(NodeVisitor *visitor) override;
+    AstNode *target;
+    BinaryOpNode *operation;
+
+    // For Name targets, decided by TypeInferencePass; both stay false
+    // without it. A stable binding is not moved by evaluating the value
+    // (which binds no names), so the variable is looked up only once.
+    // reuseBox means no reference to the variable's value can escape its
+    // function frame, so an Int or Float result may overwrite the last
+    // object this node stored (kept by the interpreter, per operation
+    // site) while the variable still holds it.
+    bool stableBinding = false;
+    bool reuseBox = false;
+};
+
 class BlockNode : public AstNode
 {
 public:
@@ -251,6 +477,11 @@ public:
         : AstNode(AstNodeType::Program), statements(statements) {}
     PyObject *accept(NodeVisitor *visitor) override;
     std::vector<AstNode *> statements;
+    // Sites are numbered from siteBase, which is nonzero for a program
+    // compiled to run after another in one interpreter (see embed.hpp);
+    // siteCount, set by assignSites(), is one past the last
+    int siteBase = 0;
+    int siteCount = -1;
 };
 
 class PrintNode : public AstNode
@@ -275,13 +506,17 @@ public:
     virtual PyObject *visitReturnNode(ReturnNode *node) = 0;
     virtual PyObject *visitIfNode(IfNode *node) = 0;
     virtual PyObject *visitWhileNode(WhileNode *node) = 0;
+    virtual PyObject *visitForNode(ForNode *node) = 0;
     virtual PyObject *visitFunctionNode(FunctionNode *node) = 0;
     virtual PyObject *visitCallNode(CallNode *node) = 0;
+    virtual PyObject *visitInlinedCallNode(InlinedCallNode *node) = 0;
+    virtual PyObject *visitParamNode(ParamNode *node) = 0;
     virtual PyObject *visitPropertyNode(PropertyNode *node) = 0;
     virtual PyObject *visitClassNode(ClassNode *node) = 0;
     virtual PyObject *visitIntNode(IntNode *node) = 0;
     virtual PyObject *visitFloatNode(FloatNode *node) = 0;
     virtual PyObject *visitStringNode(StringNode *node) = 0;
+    virtual PyObject *visitFStringNode(FStringNode *node) = 0;
     virtual PyObject *visitBooleanNode(BooleanNode *node) = 0;
     virtual PyObject *visitNullNode(NullNode *node) = 0;
     virtual PyObject *visitNameNode(NameNode *node) = 0;
@@ -289,4 +524,12 @@ public:
     virtual PyObject *visitUnaryOpNode(UnaryOpNode *node) = 0;
     virtual PyObject *visitAssignNode(AssignNode *node) = 0;
     virtual PyObject *visitPropertyAssignNode(PropertyAssignNode *node) = 0;
+    virtual PyObject *visitListNode(ListNode *node) = 0;
+    virtual PyObject *visitDictNode(DictNode *node) = 0;
+    virtual PyObject *visitSubscriptNode(SubscriptNode *node) = 0;
+    virtual PyObject *visitSliceNode(SliceNode *node) = 0;
+    virtual PyObject *visitSubscriptAssignNode(SubscriptAssignNode *node) = 0;
+    virtual PyObject *visitTupleNode(TupleNode *node) = 0;
+    virtual PyObject *visitUnpackAssignNode(UnpackAssignNode *node) = 0;
+    virtual PyObject *visitAugAssignNode(AugAssignNode *node) = 0;
 };
\ No newline at end of file
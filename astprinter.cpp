@@ -0,0 +1,367 @@
+#include "astprinter.hpp"
+
+void AstPrinter::print(AstNode *node)
+{
+    depth = 0;
+    child(node);
+}
+
+void AstPrinter::line(const std::string &text)
+{
+    out << std::string(depth * 2, ' ') << text << '\n';
+}
+
+void AstPrinter::child(AstNode *node)
+{
+    if (node)
+        node->accept(this);
+    else
+        line("<null>");
+}
+
+void AstPrinter::labelled(const std::string &label, AstNode *node)
+{
+    line(label + ":");
+    depth++;
+    child(node);
+    depth--;
+}
+
+PyObject *AstPrinter::visitProgramNode(ProgramNode *node)
+{
+    line("Program");
+    depth++;
+    for (AstNode *stmt : node->statements)
+        child(stmt);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitBlockNode(BlockNode *node)
+{
+    line("Block");
+    depth++;
+    for (AstNode *stmt : node->statements)
+        child(stmt);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitPrintNode(PrintNode *node)
+{
+    line("Print");
+    depth++;
+    child(node->expression);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitPassNode(PassNode *)
+{
+    line("Pass");
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitBreakNode(BreakNode *)
+{
+    line("Break");
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitContinueNode(ContinueNode *)
+{
+    line("Continue");
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitReturnNode(ReturnNode *node)
+{
+    line("Return");
+    if (node->value)
+    {
+        depth++;
+        child(node->value);
+        depth--;
+    }
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitIfNode(IfNode *node)
+{
+    line("If");
+    depth++;
+    labelled("condition", node->condition);
+    labelled("then", node->thenBranch);
+    for (auto &elifPair : node->elifBranches)
+    {
+        labelled("elif", elifPair.first);
+        labelled("then", elifPair.second);
+    }
+    if (node->elseBranch)
+        labelled("else", node->elseBranch);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitWhileNode(WhileNode *node)
+{
+    line("While");
+    depth++;
+    labelled("condition", node->condition);
+    labelled("body", node->body);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitForNode(ForNode *node)
+{
+    const char *reuse = node->reuse == TargetReuse::Always    ? " [in place]"
+                        : node->reuse == TargetReuse::IfLocal ? " [in place if local]"
+                                                              : "";
+    line("For " + node->target.lexeme + reuse);
+    depth++;
+    labelled("iterable", node->iterable);
+    labelled("body", node->body);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitFunctionNode(FunctionNode *node)
+{
+    std::string params;
+    for (size_t i = 0; i < node->params.size(); ++i)
+        params += (i ? ", " : "") + node->params[i];
+    line("Function " + node->name + "(" + params + ")");
+    depth++;
+    child(node->body);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitCallNode(CallNode *node)
+{
+    line("Call");
+    depth++;
+    labelled("callee", node->callee);
+    for (AstNode *arg : node->args)
+        labelled("arg", arg);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitInlinedCallNode(InlinedCallNode *node)
+{
+    line("InlinedCall " + node->name);
+    depth++;
+    for (AstNode *arg : node->call->args)
+        labelled("arg", arg);
+    labelled("body", node->inlined);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitParamNode(ParamNode *node)
+{
+    line("Param " + std::to_string(node->index) + " " + node->name);
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitPropertyNode(PropertyNode *node)
+{
+    line("Property ." + node->property);
+    depth++;
+    child(node->object);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitClassNode(ClassNode *node)
+{
+    line("Class " + node->name);
+    depth++;
+    child(node->body);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitIntNode(IntNode *node)
+{
+    line("Int " + node->value.lexeme);
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitFloatNode(FloatNode *node)
+{
+    line("Float " + node->value.lexeme);
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitStringNode(StringNode *node)
+{
+    line("String \"" + node->value.lexeme + "\"");
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitFStringNode(FStringNode *node)
+{
+    line("FString");
+    depth++;
+    for (const FStringSegment &segment : node->segments)
+    {
+        if (!segment.literal.empty())
+            line("Text \"" + segment.literal + "\"");
+        if (!segment.expression)
+            continue;
+        std::string label = "field {" + segment.source;
+        if (segment.conversion)
+            label += std::string("!") + segment.conversion;
+        labelled(label + "}", segment.expression);
+    }
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitBooleanNode(BooleanNode *node)
+{
+    line(std::string("Boolean ") + (node->value.type == TokenType::True ? "True" : "False"));
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitNullNode(NullNode *)
+{
+    line("None");
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitNameNode(NameNode *node)
+{
+    line("Name " + node->name.lexeme);
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitBinaryOpNode(BinaryOpNode *node)
+{
+    line("BinaryOp " + node->op.lexeme);
+    depth++;
+    child(node->left);
+    child(node->right);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitUnaryOpNode(UnaryOpNode *node)
+{
+    line("UnaryOp " + node->op.lexeme);
+    depth++;
+    child(node->operand);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitAssignNode(AssignNode *node)
+{
+    line("Assign " + node->name.lexeme);
+    depth++;
+    child(node->value);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitPropertyAssignNode(PropertyAssignNode *node)
+{
+    line("PropertyAssign ." + node->property);
+    depth++;
+    labelled("object", node->object);
+    labelled("value", node->value);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitListNode(ListNode *node)
+{
+    line("List");
+    depth++;
+    for (AstNode *element : node->elements)
+        child(element);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitDictNode(DictNode *node)
+{
+    line("Dict");
+    depth++;
+    for (size_t i = 0; i < node->keys.size(); ++i)
+    {
+        labelled("key", node->keys[i]);
+        labelled("value", node->values[i]);
+    }
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitSubscriptNode(SubscriptNode *node)
+{
+    line("Subscript");
+    depth++;
+    labelled("object", node->object);
+    labelled("index", node->index);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitSliceNode(SliceNode *node)
+{
+    line("Slice");
+    depth++;
+    if (node->start)
+        labelled("start", node->start);
+    if (node->stop)
+        labelled("stop", node->stop);
+    if (node->step)
+        labelled("step", node->step);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitSubscriptAssignNode(SubscriptAssignNode *node)
+{
+    line("SubscriptAssign");
+    depth++;
+    labelled("object", node->object);
+    labelled("index", node->index);
+    labelled("value", node->value);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitTupleNode(TupleNode *node)
+{
+    line("Tuple");
+    depth++;
+    for (AstNode *element : node->elements)
+        child(element);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitUnpackAssignNode(UnpackAssignNode *node)
+{
+    line("UnpackAssign");
+    depth++;
+    for (AstNode *target : node->targets)
+        labelled("target", target);
+    labelled("value", node->value);
+    depth--;
+    return nullptr;
+}
+
+PyObject *AstPrinter::visitAugAssignNode(AugAssignNode *node)
+{
+    line("AugAssign " + node->operation->op.lexeme + "=" + (node->reuseBox ? " [in place]" : ""));
+    depth++;
+    labelled("target", node->target);
+    labelled("value", node->operation->right);
+    depth--;
+    return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ast.hpp"
+#include <ostream>
+#include <string>
+
+// Prints an indented tree of the AST, one node per line (--dump-ast)
+class AstPrinter : public NodeVisitor
+{
+public:
+    AstPrinter(std::ostream &out) : out(out) {}
+    void print(AstNode *node);
+
+    PyObject *visitProgramNode(ProgramNode *node) override;
+    PyObject *visitBlockNode(BlockNode *node) override;
+    PyObject *visitPrintNode(PrintNode *node) override;
+    PyObject *visitPassNode(PassNode *node) override;
+    PyObject *visitBreakNode(BreakNode *node) override;
+    PyObject *visitContinueNode(ContinueNode *node) override;
+    PyObject *visitReturnNode(ReturnNode *node) override;
+    PyObject *visitIfNode(IfNode *node) override;
+    PyObject *visitWhileNode(WhileNode *node) override;
+    PyObject *visitForNode(ForNode *node) override;
+    PyObject *visitFunctionNode(FunctionNode *node) override;
+    PyObject *visitCallNode(CallNode *node) override;
+    PyObject *visitInlinedCallNode(InlinedCallNode *node) override;
+    PyObject *visitParamNode(ParamNode *node) override;
+    PyObject *visitPropertyNode(PropertyNode *node) override;
+    PyObject *visitClassNode(ClassNode *node) override;
+    PyObject *visitIntNode(IntNode *node) override;
+    PyObject *visitFloatNode(FloatNode *node) override;
+    PyObject *visitStringNode(StringNode *node) override;
+    PyObject *visitFStringNode(FStringNode *node) override;
+    PyObject *visitBooleanNode(BooleanNode *node) override;
+    PyObject *visitNullNode(NullNode *node) override;
+    PyObject *visitNameNode(NameNode *node) override;
+    PyObject *visitBinaryOpNode(BinaryOpNode *node) override;
+    PyObject *visitUnaryOpNode(UnaryOpNode *node) override;
+    PyObject *visitAssignNode(AssignNode *node) override;
+    PyObject *visitPropertyAssignNode(PropertyAssignNode *node) override;
+    PyObject *visitListNode(ListNode *node) override;
+    PyObject *visitDictNode(DictNode *node) override;
+    PyObject *visitSubscriptNode(SubscriptNode *node) override;
+    PyObject *visitSliceNode(SliceNode *node) override;
+    PyObject *visitSubscriptAssignNode(SubscriptAssignNode *node) override;
+    PyObject *visitTupleNode(TupleNode *node) override;
+    PyObject *visitUnpackAssignNode(UnpackAssignNode *node) override;
+    PyObject *visitAugAssignNode(AugAssignNode *node) override;
+
+private:
+    void line(const std::string &text);
+    void child(AstNode *node);
+    void labelled(const std::string &label, AstNode *node);
+
+    std::ostream &out;
+    int depth = 0;
+};
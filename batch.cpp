@@ -0,0 +1,112 @@
+#include "batch.hpp"
+#include "embed.hpp"
+#include "output.hpp"
+#include "workpool.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace
+{
+struct ScriptResult
+{
+    std::string output;
+    std::string error;
+    bool finished = false;
+    bool failed = false;
+};
+
+// Writes finished results in script order. Results are released once
+// written, so a long batch holds only the output of scripts that are
+// waiting on an earlier, slower one.
+class OrderedEmitter
+{
+public:
+    OrderedEmitter(std::vector<ScriptResult> &results, const std::vector<std::string> &paths)
+        : results(results), paths(paths), out(STDOUT_FILENO, Output::Mode::Full)
+    {
+    }
+
+    void finish(size_t index)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        results[index].finished = true;
+        while (next < results.size() && results[next].finished)
+        {
+            ScriptResult &result = results[next];
+            out.write(result.output);
+            if (result.failed)
+            {
+                // Script output first, then its error
+                out.flush();
+                std::cerr << "Error: " << paths[next] << ": " << result.error << std::endl;
+            }
+            result.output = std::string();
+            result.error = std::string();
+            ++next;
+        }
+        out.flush();
+    }
+
+private:
+    std::vector<ScriptResult> &results;
+    const std::vector<std::string> &paths;
+    std::mutex lock;
+    Output out;
+    size_t next = 0;
+};
+}
+
+int runBatch(const std::vector<std::string> &paths, const OptimizerOptions &options, size_t jobs)
+{
+    std::vector<ScriptResult> results(paths.size());
+    OrderedEmitter emitter(results, paths);
+
+    // No more threads than scripts; 0 stays 0 for the pool to decide
+    WorkPool pool(std::min(jobs, std::max<size_t>(paths.size(), 1)));
+    pool.run(paths.size(), [&](size_t index)
+    {
+        ScriptResult &result = results[index];
+        Output &out = Output::standard();
+        out.capture(&result.output);
+        try
+        {
+            Session session(Program::compileFile(paths[index], options));
+            session.run();
+            out.flush();
+        }
+        catch (const std::exception &e)
+        {
+            result.error = e.what();
+            result.failed = true;
+        }
+        out.capture(nullptr);
+        emitter.finish(index);
+    });
+
+    for (const ScriptResult &result : results)
+        if (result.failed)
+            return 1;
+    return 0;
+}
+
+std::vector<std::string> readManifest(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+        throw std::runtime_error("could not open manifest '" + path + "'");
+    std::vector<std::string> paths;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        paths.push_back(line.substr(start, end - start + 1));
+    }
+    return paths;
+}
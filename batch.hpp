@@ -0,0 +1,24 @@
+#pragma once
+
+#include "optimizer.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ==================== Batch Mode ====================
+// Runs many scripts in one process (`--jobs N`), so process start-up and
+// first-touch page faults are paid once instead of once per script.
+// Scripts are compiled and run on a WorkPool, each in a Session of its
+// own: nothing a script defines or prints is visible to another. Each
+// script's stdout is captured whole and written out in the order the
+// scripts were given, as soon as every earlier script has been written;
+// a failed script's error follows its output on stderr as
+// "Error: <path>: <message>" and the batch goes on.
+
+// `jobs` counts threads, 0 meaning one per hardware thread. Returns the
+// exit status: 0 if every script ran, 1 otherwise.
+int runBatch(const std::vector<std::string> &paths, const OptimizerOptions &options, size_t jobs);
+
+// Script paths listed in a manifest file, one per line; blank lines and
+// lines starting with '#' are skipped. Throws if the file cannot be read.
+std::vector<std::string> readManifest(const std::string &path);
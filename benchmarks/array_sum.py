@@ -0,0 +1,9 @@
+# Sums and a dot product over a million-element float array, in the
+# vectorized builtins.
+values = array('d', range(1000000))
+total = 0.0
+round = 0
+while round < 20:
+    total = total + sum(values) + dot(values, values)
+    round = round + 1
+print(total)
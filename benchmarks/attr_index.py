@@ -0,0 +1,35 @@
+# The pre-list workaround for list_index.py: numbered attributes on an
+# instance, selected with an if/elif chain on the index.
+class Slots:
+    pass
+
+slots = Slots()
+slots.s0 = 0
+slots.s1 = 0
+slots.s2 = 0
+slots.s3 = 0
+slots.s4 = 0
+slots.s5 = 0
+slots.s6 = 0
+slots.s7 = 0
+i = 0
+while i < 1000000:
+    k = i % 8
+    if k == 0:
+        slots.s0 = slots.s0 + i
+    elif k == 1:
+        slots.s1 = slots.s1 + i
+    elif k == 2:
+        slots.s2 = slots.s2 + i
+    elif k == 3:
+        slots.s3 = slots.s3 + i
+    elif k == 4:
+        slots.s4 = slots.s4 + i
+    elif k == 5:
+        slots.s5 = slots.s5 + i
+    elif k == 6:
+        slots.s6 = slots.s6 + i
+    elif k == 7:
+        slots.s7 = slots.s7 + i
+    i = i + 1
+print(slots.s0 + slots.s7)
@@ -0,0 +1,13 @@
+# while_count.py inside a function, with augmented assignment: from -O1
+# the counter and the total are updated in place instead of being rebound
+# to a new int on every iteration.
+def count(n):
+    total = 0
+    i = 0
+    while i < n:
+        total += i
+        i += 1
+    return total
+
+
+print(count(3000000))
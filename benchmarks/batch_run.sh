@@ -0,0 +1,46 @@
+#!/bin/sh
+# Runs many small scripts one process each, then all of them in one
+# `--jobs` process, checks that the outputs match and prints both times.
+# Usage: benchmarks/batch_run.sh [interpreter] [scripts] [jobs]
+cd "$(dirname "$0")/.." || exit 1
+bin=${1:-./your_program}
+count=${2:-2000}
+jobs=${3:-$(nproc)}
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+
+i=0
+while [ $i -lt "$count" ]; do
+    cat > "$dir/s$i.py" <<SCRIPT
+def checksum(n):
+    total = 0
+    k = 0
+    while k < n:
+        total += k * $i % 7
+        k += 1
+    return total
+
+items = []
+k = 0
+while k < $((i % 50 + 10)):
+    items.append(f"item{k}")
+    k += 1
+print(f"script $i: {checksum($((i % 300 + 100)))} {len(items)}")
+SCRIPT
+    echo "$dir/s$i.py" >> "$dir/manifest"
+    i=$((i + 1))
+done
+
+start=$(date +%s%N)
+while read -r script; do
+    "$bin" "$script" || exit 1
+done < "$dir/manifest" > "$dir/spawned.txt"
+end=$(date +%s%N)
+printf '%d scripts, one process each:  %8d ms\n' "$count" $(((end - start) / 1000000))
+
+start=$(date +%s%N)
+"$bin" --jobs "$jobs" --manifest="$dir/manifest" > "$dir/batch.txt" || exit 1
+end=$(date +%s%N)
+printf '%d scripts, --jobs %-2d:         %8d ms\n' "$count" "$jobs" $(((end - start) / 1000000))
+
+cmp -s "$dir/spawned.txt" "$dir/batch.txt" || { echo "outputs differ"; exit 1; }
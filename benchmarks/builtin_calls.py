@@ -0,0 +1,30 @@
+# math.hypot, a bound native builtin, against the same function written
+# in the script, a million calls each, timed with time.perf_counter_ns().
+def script_hypot(x, y):
+    return (x * x + y * y) ** 0.5
+
+def native(n):
+    total = 0.0
+    i = 0
+    while i < n:
+        total += math.hypot(i, 3)
+        i += 1
+    return total
+
+def scripted(n):
+    total = 0.0
+    i = 0
+    while i < n:
+        total += script_hypot(i, 3)
+        i += 1
+    return total
+
+start = time.perf_counter_ns()
+a = native(1000000)
+middle = time.perf_counter_ns()
+b = scripted(1000000)
+end = time.perf_counter_ns()
+print(int(a))
+print(int(b))
+print(f"math.hypot:   {(middle - start) // 1000000} ms")
+print(f"script hypot: {(end - middle) // 1000000} ms")
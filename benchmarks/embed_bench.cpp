@@ -0,0 +1,78 @@
+// Embedding benchmark: evaluating a script function through the library
+// (compile once, then call) against spawning your_program for each
+// evaluation, which is what a host without the library has to do.
+// Build with `make bench`, run from the repository root as
+// benchmarks/embed_bench [calls].
+#include "embed.hpp"
+#include "output.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static const char *script = R"(def score(x, name):
+    total = 0
+    for c in name.split(","):
+        total += len(c) * weight
+    return clamp(total + x, 0, 100)
+)";
+
+static long long clamp(long long value, long long low, long long high)
+{
+    return value < low ? low : value > high ? high : value;
+}
+
+static double microseconds(Clock::duration elapsed)
+{
+    return std::chrono::duration<double, std::micro>(elapsed).count();
+}
+
+int main(int argc, char **argv)
+{
+    int calls = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int spawns = 50;
+
+    auto start = Clock::now();
+    std::shared_ptr<Program> program = Program::compile(script);
+    Session session(program);
+    session.define<"clamp", clamp>();
+    session.setGlobal("weight", 3);
+    session.run();
+    double setup = microseconds(Clock::now() - start);
+
+    if (session.call<long long>("score", 1, "ab,c") != 10 || session.call<long long>("score", 90, "abcd") != 100)
+    {
+        std::printf("score() returned the wrong result\n");
+        return 1;
+    }
+    start = Clock::now();
+    long long total = 0;
+    for (int i = 0; i < calls; ++i)
+        total += session.call<long long>("score", i % 50, "alpha,beta,gamma");
+    double embedded = microseconds(Clock::now() - start) / calls;
+
+    // The same evaluation as a process per call
+    const char *path = "/tmp/embed_bench_score.py";
+    std::ofstream(path) << script << "weight = 3\n"
+                        << "def clamp(v, lo, hi):\n    return min(max(v, lo), hi)\n"
+                        << "print(score(7, \"alpha,beta,gamma\"))\n";
+    std::string command = std::string("./your_program ") + path + " > /dev/null";
+    start = Clock::now();
+    for (int i = 0; i < spawns; ++i)
+        if (std::system(command.c_str()) != 0)
+        {
+            std::printf("could not run '%s' (run from the repository root after make)\n", command.c_str());
+            return 1;
+        }
+    double spawned = microseconds(Clock::now() - start) / spawns;
+    std::remove(path);
+
+    std::printf("compile and run top level: %10.1f us\n", setup);
+    std::printf("Session::call:             %10.2f us per call (%d calls, checksum %lld)\n", embedded, calls, total);
+    std::printf("your_program per process:  %10.1f us per call (%d spawns)\n", spawned, spawns);
+    Output::standard().flush();
+    return 0;
+}
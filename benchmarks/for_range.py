@@ -0,0 +1,6 @@
+# Counted loop with for/range: the counter lives in native code and the
+# loop variable is updated in place. Compare with while_count.py.
+total = 0
+for i in range(3000000):
+    total = total + i
+print(total)
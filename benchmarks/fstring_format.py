@@ -0,0 +1,11 @@
+# Formats 300000 report lines with f-strings: padded ints, a left-aligned
+# name, a fixed-precision float and a hex field per line.
+names = ["alpha", "beta", "gamma", "delta"]
+out = ""
+i = 0
+while i < 300000:
+    name = names[i % 4]
+    out += f"{i:>8} {name:<6} {i / 7:10.3f} {i:#06x};"
+    i += 1
+print(len(out))
+print(out[0:35])
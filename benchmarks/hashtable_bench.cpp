@@ -0,0 +1,153 @@
+// Lookup/insert microbenchmark: HashTable against std::unordered_map.
+// Build with `make bench`, run as benchmarks/hashtable_bench [N].
+#include "hashtable.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static volatile size_t sink;
+
+template <typename F>
+static double measure(F body)
+{
+    auto start = Clock::now();
+    body();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <typename Key>
+static std::vector<Key> makeKeys(size_t n, size_t offset);
+
+template <>
+std::vector<long long> makeKeys(size_t n, size_t offset)
+{
+    std::vector<long long> keys;
+    for (size_t i = 0; i < n; ++i)
+        keys.push_back(static_cast<long long>((i + offset) * 7919));
+    return keys;
+}
+
+// Identifier-like names, the shape of scope and attribute keys
+template <>
+std::vector<std::string> makeKeys(size_t n, size_t offset)
+{
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i)
+        keys.push_back("name_" + std::to_string(i + offset));
+    return keys;
+}
+
+struct Result
+{
+    double insert, hit, miss;
+};
+
+template <typename Map, typename Key>
+static Result run(const std::vector<Key> &keys, const std::vector<Key> &absent, int rounds)
+{
+    Result result{0, 0, 0};
+    for (int round = 0; round < rounds; ++round)
+    {
+        Map map;
+        result.insert += measure([&]
+                                 {
+            for (size_t i = 0; i < keys.size(); ++i)
+                map[keys[i]] = static_cast<int>(i); });
+        result.hit += measure([&]
+                              {
+            size_t total = 0;
+            for (const Key &key : keys)
+                total += map.find(key) != decltype(map.find(key)){};
+            sink = total; });
+        result.miss += measure([&]
+                               {
+            size_t total = 0;
+            for (const Key &key : absent)
+                total += map.find(key) != decltype(map.find(key)){};
+            sink = total; });
+    }
+    return result;
+}
+
+// std::unordered_map::find returns an iterator; adapt it to HashTable's
+// pointer-or-null interface so both run the same loops
+template <typename Key>
+struct StdMap
+{
+    std::unordered_map<Key, int> map;
+    int &operator[](const Key &key) { return map[key]; }
+    const int *find(const Key &key) const
+    {
+        auto it = map.find(key);
+        return it == map.end() ? nullptr : &it->second;
+    }
+};
+
+template <typename Key>
+static bool verify(const std::vector<Key> &keys)
+{
+    HashTable<Key, int> table;
+    std::unordered_map<Key, int> reference;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        table.insert(keys[i], static_cast<int>(i));
+        reference[keys[i]] = static_cast<int>(i);
+        if (i % 3 == 0)
+        {
+            table.erase(keys[i / 2]);
+            reference.erase(keys[i / 2]);
+        }
+    }
+    if (table.size() != reference.size())
+        return false;
+    for (const Key &key : keys)
+    {
+        const int *value = table.find(key);
+        auto it = reference.find(key);
+        if ((value == nullptr) != (it == reference.end()) || (value && *value != it->second))
+            return false;
+    }
+    size_t iterated = 0;
+    for (auto &entry : table)
+        iterated += reference.count(entry.first);
+    return iterated == reference.size();
+}
+
+template <typename Key>
+static void report(const char *label, size_t n, int rounds)
+{
+    std::vector<Key> keys = makeKeys<Key>(n, 0);
+    std::vector<Key> absent = makeKeys<Key>(n, n);
+    if (!verify(keys))
+    {
+        std::printf("%s: HashTable disagrees with std::unordered_map\n", label);
+        std::exit(1);
+    }
+
+    Result table = run<HashTable<Key, int>>(keys, absent, rounds);
+    Result reference = run<StdMap<Key>>(keys, absent, rounds);
+    auto line = [&](const char *what, double ours, double theirs)
+    {
+        std::printf("%-8s %-7s %10.2f ns %10.2f ns %6.2fx\n", label, what, ours * 1e6 / (n * rounds),
+                    theirs * 1e6 / (n * rounds), theirs / ours);
+    };
+    line("insert", table.insert, reference.insert);
+    line("hit", table.hit, reference.hit);
+    line("miss", table.miss, reference.miss);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int rounds = 20;
+    std::printf("%zu keys, %d rounds\n", n, rounds);
+    std::printf("%-8s %-7s %13s %13s %7s\n", "keys", "op", "HashTable", "unordered_map", "speedup");
+    report<long long>("int", n, rounds);
+    report<std::string>("string", n, rounds);
+    return 0;
+}
@@ -0,0 +1,20 @@
+# The pre-tuple workaround for tuple_return.py: the results travel back in
+# a freshly allocated instance.
+class Pair:
+    pass
+
+def divmod10(n):
+    pair = Pair()
+    pair.q = n // 10
+    pair.r = n % 10
+    return pair
+
+digits = 0
+remainders = 0
+i = 0
+while i < 500000:
+    pair = divmod10(i)
+    digits = digits + pair.q
+    remainders = remainders + pair.r
+    i = i + 1
+print(digits + remainders)
@@ -0,0 +1,9 @@
+# Indexed read-modify-write on a list: one subscript load and one store
+# per iteration. Compare with attr_index.py.
+slots = [0, 0, 0, 0, 0, 0, 0, 0]
+i = 0
+while i < 1000000:
+    k = i % 8
+    slots[k] = slots[k] + i
+    i = i + 1
+print(slots[0] + slots[7])
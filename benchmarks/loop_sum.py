@@ -0,0 +1,8 @@
+# The interpreted equivalent of array_sum.py, one round instead of twenty.
+values = array('d', range(1000000))
+total = 0.0
+product = 0.0
+for v in values:
+    total = total + v
+    product = product + v * v
+print(total + product)
@@ -0,0 +1,180 @@
+// Numeric conversion microbenchmark: the from_chars/to_chars layer in
+// numconv.cpp against std::to_string, snprintf, std::stoll and strtod.
+// Every float must round-trip through writeFloat/parseFloat before any timing.
+// Build with `make bench`, run as benchmarks/numconv_bench [N].
+#include "numconv.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static volatile size_t sink;
+
+template <typename F>
+static double measure(size_t n, F body)
+{
+    auto start = Clock::now();
+    body();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(n);
+}
+
+static bool sameBits(double a, double b) { return std::memcmp(&a, &b, sizeof a) == 0; }
+
+// Doubles over the whole exponent range plus the short decimals that
+// scripts actually print
+static std::vector<double> makeFloats(size_t n, unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<double> values;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i % 2)
+        {
+            uint64_t bits = rng();
+            double value;
+            std::memcpy(&value, &bits, sizeof value);
+            values.push_back(std::isfinite(value) ? value : 0.5);
+        }
+        else
+        {
+            values.push_back(static_cast<double>(rng() % 100000) / 100.0);
+        }
+    }
+    return values;
+}
+
+static bool verify(const std::vector<double> &floats, const std::vector<long long> &ints)
+{
+    char buffer[maxNumberChars];
+    for (double value : floats)
+    {
+        double back;
+        char *end = writeFloat(buffer, value);
+        if (parseFloat(std::string_view(buffer, end - buffer), back) != ParseResult::Ok || !sameBits(back, value))
+        {
+            std::printf("float %a does not round-trip through '%.*s'\n", value, static_cast<int>(end - buffer), buffer);
+            return false;
+        }
+    }
+    for (long long value : ints)
+    {
+        long long back;
+        char *end = writeInt(buffer, value);
+        if (parseInt(std::string_view(buffer, end - buffer), back) != ParseResult::Ok || back != value ||
+            std::string(buffer, end) != std::to_string(value))
+        {
+            std::printf("int %lld does not round-trip\n", value);
+            return false;
+        }
+    }
+    const char *cases[][2] = {{"0.1", "0.1"}, {"1e16", "1e+16"}, {"1e-5", "1e-05"}, {"123456789012345678.0", "1.2345678901234568e+17"},
+                              {"-0.0", "-0.0"}, {"1_000.5", "1000.5"}, {"5e-324", "5e-324"}, {"1e400", "inf"}};
+    for (auto &c : cases)
+    {
+        double value;
+        if (parseFloat(c[0], value) != ParseResult::Ok || floatToString(value) != c[1])
+        {
+            std::printf("'%s' prints as '%s', expected '%s'\n", c[0], floatToString(value).c_str(), c[1]);
+            return false;
+        }
+    }
+    long long value;
+    return parseInt("9223372036854775808", value) == ParseResult::Overflow &&
+           parseInt("1__0", value) == ParseResult::Invalid && parseInt("_1", value) == ParseResult::Invalid;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::vector<double> floats = makeFloats(n, 1);
+    std::vector<long long> ints;
+    std::mt19937_64 rng(2);
+    for (size_t i = 0; i < n; ++i)
+        ints.push_back(static_cast<long long>(rng()) >> (rng() % 64));
+    if (!verify(floats, ints))
+        return 1;
+
+    std::vector<std::string> floatText, intText;
+    for (size_t i = 0; i < n; ++i)
+    {
+        floatText.push_back(floatToString(floats[i]));
+        intText.push_back(intToString(ints[i]));
+    }
+
+    char buffer[maxNumberChars];
+    std::printf("%zu values, ns per conversion\n", n);
+    std::printf("%-14s %12s %12s\n", "", "numconv", "std");
+    double ours = measure(n, [&]
+    {
+        size_t total = 0;
+        for (long long value : ints)
+            total += static_cast<size_t>(writeInt(buffer, value) - buffer);
+        sink = total;
+    });
+    double theirs = measure(n, [&]
+    {
+        size_t total = 0;
+        for (long long value : ints)
+            total += std::to_string(value).size();
+        sink = total;
+    });
+    std::printf("%-14s %12.1f %12.1f  (std::to_string)\n", "format int", ours, theirs);
+
+    ours = measure(n, [&]
+    {
+        size_t total = 0;
+        for (double value : floats)
+            total += static_cast<size_t>(writeFloat(buffer, value) - buffer);
+        sink = total;
+    });
+    theirs = measure(n, [&]
+    {
+        size_t total = 0;
+        for (double value : floats)
+            total += static_cast<size_t>(std::snprintf(buffer, sizeof buffer, "%.17g", value));
+        sink = total;
+    });
+    std::printf("%-14s %12.1f %12.1f  (snprintf %%.17g)\n", "format float", ours, theirs);
+
+    ours = measure(n, [&]
+    {
+        size_t total = 0;
+        long long value;
+        for (const std::string &text : intText)
+            if (parseInt(text, value) == ParseResult::Ok)
+                total += static_cast<size_t>(value);
+        sink = total;
+    });
+    theirs = measure(n, [&]
+    {
+        size_t total = 0;
+        for (const std::string &text : intText)
+            total += static_cast<size_t>(std::stoll(text));
+        sink = total;
+    });
+    std::printf("%-14s %12.1f %12.1f  (std::stoll)\n", "parse int", ours, theirs);
+
+    ours = measure(n, [&]
+    {
+        double total = 0, value;
+        for (const std::string &text : floatText)
+            if (parseFloat(text, value) == ParseResult::Ok)
+                total += value;
+        sink = static_cast<size_t>(total != 0);
+    });
+    theirs = measure(n, [&]
+    {
+        double total = 0;
+        for (const std::string &text : floatText)
+            total += std::strtod(text.c_str(), nullptr);
+        sink = static_cast<size_t>(total != 0);
+    });
+    std::printf("%-14s %12.1f %12.1f  (std::strtod)\n", "parse float", ours, theirs);
+    return 0;
+}
@@ -0,0 +1,34 @@
+# pmap against a sequential loop over the same pure function: Collatz
+# step counts for 20000 starting values. With one thread per core, pmap
+# should approach a core-count speedup; --threads=N sets the pool size.
+def collatz(n):
+    steps = 0
+    while n != 1:
+        if n % 2 == 0:
+            n = n // 2
+        else:
+            n = 3 * n + 1
+        steps += 1
+    return steps
+
+def loop(count):
+    out = []
+    for k in range(1, count + 1):
+        out.append(collatz(k))
+    return out
+
+def total(values):
+    s = 0
+    for v in values:
+        s += v
+    return s
+
+start = time.perf_counter_ns()
+sequential = loop(20000)
+middle = time.perf_counter_ns()
+parallel = pmap(collatz, range(1, 20001))
+end = time.perf_counter_ns()
+print(total(sequential))
+print(total(parallel))
+print(f"loop: {(middle - start) // 1000000} ms")
+print(f"pmap: {(end - middle) // 1000000} ms")
@@ -0,0 +1,8 @@
+# Prints a million short lines: ints, strings and f-strings. Run with
+# stdout redirected; --unbuffered shows the cost of a write per line.
+i = 0
+while i < 1000000:
+    print(i)
+    print("line")
+    print(f"{i:>8}|{i % 7}")
+    i += 3
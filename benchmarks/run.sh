@@ -0,0 +1,16 @@
+#!/bin/sh
+# Times each benchmark at every optimization level.
+# Usage: benchmarks/run.sh [interpreter] [benchmark.py...]
+cd "$(dirname "$0")/.." || exit 1
+bin=${1:-./your_program}
+[ $# -gt 0 ] && shift
+[ $# -gt 0 ] || set -- benchmarks/*.py
+
+for script in "$@"; do
+    for level in -O0 -O1 -O2; do
+        start=$(date +%s%N)
+        "$bin" "$level" "$script" > /dev/null || exit 1
+        end=$(date +%s%N)
+        printf '%-28s %s %8d ms\n' "$(basename "$script")" "$level" $(((end - start) / 1000000))
+    done
+done
@@ -0,0 +1,139 @@
+// Client for `your_program --serve`. With a socket and a script it runs
+// the script once on the server, copying its output and error and
+// exiting with its status, like running your_program on the file. Given
+// a request count (and optionally a number of connections, default 1),
+// it becomes a load test: each connection sends its share of requests
+// back to back, and the tool reports throughput and latency percentiles.
+// Build with `make bench`; start a server first, e.g.
+//     ./your_program --serve=/tmp/py.sock &
+//     benchmarks/serve_client /tmp/py.sock benchmarks/while_count.py 2000 8
+#include "server.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Sends one request and reads its response; returns the exit status.
+// Output goes to `out` unless it is null.
+static int request(int fd, const std::string &source, std::string *out, std::string &error)
+{
+    wire::sendRequest(fd, source);
+    char type;
+    std::string payload;
+    while (wire::readFrame(fd, type, payload))
+    {
+        if (type == 'O' && out)
+            out->append(payload);
+        else if (type == 'E')
+            error = payload;
+        else if (type == 'X')
+            return payload.empty() ? 1 : payload[0];
+    }
+    throw std::runtime_error("Server closed the connection");
+}
+
+static double percentile(std::vector<double> &sorted, double fraction)
+{
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " socket script.py [requests [connections]]\n";
+        return 2;
+    }
+    std::string socketPath = argv[1];
+    std::ifstream file(argv[2]);
+    if (!file)
+    {
+        std::cerr << "Error: could not open file '" << argv[2] << "'\n";
+        return 1;
+    }
+    std::string source((std::istreambuf_iterator<char>(file)), {});
+
+    try
+    {
+        if (argc == 3)
+        {
+            int fd = wire::connectTo(socketPath);
+            std::string out, error;
+            int status = request(fd, source, &out, error);
+            ::close(fd);
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            std::fflush(stdout);
+            if (status != 0)
+                std::cerr << "Error: " << error << "\n";
+            return status;
+        }
+
+        int requests = std::atoi(argv[3]);
+        int connections = argc > 4 ? std::atoi(argv[4]) : 1;
+        if (requests <= 0 || connections <= 0)
+        {
+            std::cerr << "requests and connections must be positive\n";
+            return 2;
+        }
+
+        std::mutex lock;
+        std::vector<double> latencies;
+        int failures = 0;
+        auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (int c = 0; c < connections; ++c)
+            threads.emplace_back([&, c]
+            {
+                std::vector<double> own;
+                int failed = 0;
+                try
+                {
+                    int fd = wire::connectTo(socketPath);
+                    for (int r = c; r < requests; r += connections)
+                    {
+                        std::string error;
+                        auto sent = Clock::now();
+                        if (request(fd, source, nullptr, error) != 0)
+                            ++failed;
+                        own.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+                    }
+                    ::close(fd);
+                }
+                catch (const std::exception &e)
+                {
+                    std::cerr << "connection " << c << ": " << e.what() << "\n";
+                    ++failed;
+                }
+                std::lock_guard<std::mutex> guard(lock);
+                latencies.insert(latencies.end(), own.begin(), own.end());
+                failures += failed;
+            });
+        for (std::thread &thread : threads)
+            thread.join();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (latencies.empty())
+            return 1;
+        std::sort(latencies.begin(), latencies.end());
+        std::printf("%zu requests on %d connections in %.2f s: %.1f requests/s, %d failed\n", latencies.size(),
+                    connections, seconds, static_cast<double>(latencies.size()) / seconds, failures);
+        std::printf("latency us: p50 %.0f  p90 %.0f  p99 %.0f  max %.0f\n", percentile(latencies, 0.5),
+                    percentile(latencies, 0.9), percentile(latencies, 0.99), latencies.back());
+        return failures == 0 ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,207 @@
+// Array and string kernel microbenchmark: every SIMD level the CPU
+// supports against the scalar kernels. Results must agree bit for bit
+// before any timing.
+// Build with `make bench`, run as benchmarks/simd_bench [N].
+#include "simd.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static volatile double sink;
+
+template <typename F>
+static double measure(int rounds, F body)
+{
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; ++round)
+        body();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / rounds;
+}
+
+struct Data
+{
+    std::vector<double> x, y;
+    std::vector<long long> p, q;
+};
+
+// Integers near the int64 limits make the exact sum leave 64 bits and
+// the element-wise sums overflow
+static Data makeData(size_t n, bool extreme, unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    Data data;
+    for (size_t i = 0; i < n; ++i)
+    {
+        data.x.push_back(real(rng));
+        data.y.push_back(real(rng));
+        long long range = extreme ? (1LL << 62) : (1LL << 20);
+        data.p.push_back(static_cast<long long>(rng() % range) * (i % 3 == 0 ? -2 : 1));
+        data.q.push_back(static_cast<long long>(rng() % range));
+    }
+    return data;
+}
+
+static bool sameBits(double a, double b) { return std::memcmp(&a, &b, sizeof a) == 0; }
+
+static bool verify(const ArrayKernels &k, const ArrayKernels &ref, const Data &d)
+{
+    size_t n = d.x.size();
+    if (!sameBits(k.sumFloat(d.x.data(), n), ref.sumFloat(d.x.data(), n)) ||
+        !sameBits(k.dotFloat(d.x.data(), d.y.data(), n), ref.dotFloat(d.x.data(), d.y.data(), n)) ||
+        k.sumInt(d.p.data(), n) != ref.sumInt(d.p.data(), n))
+        return false;
+    if (n && (k.minFloat(d.x.data(), n) != ref.minFloat(d.x.data(), n) ||
+              k.maxFloat(d.x.data(), n) != ref.maxFloat(d.x.data(), n) ||
+              k.minInt(d.p.data(), n) != ref.minInt(d.p.data(), n) ||
+              k.maxInt(d.p.data(), n) != ref.maxInt(d.p.data(), n)))
+        return false;
+
+    std::vector<double> f1(n), f2(n);
+    k.addFloat(d.x.data(), d.y.data(), f1.data(), n);
+    ref.addFloat(d.x.data(), d.y.data(), f2.data(), n);
+    if (f1 != f2)
+        return false;
+    k.mulFloat(d.x.data(), d.y.data(), f1.data(), n);
+    ref.mulFloat(d.x.data(), d.y.data(), f2.data(), n);
+    if (f1 != f2)
+        return false;
+    k.scaleFloat(d.x.data(), 0.75, f1.data(), n);
+    ref.scaleFloat(d.x.data(), 0.75, f2.data(), n);
+    if (f1 != f2)
+        return false;
+
+    std::vector<long long> i1(n), i2(n);
+    bool ok1 = k.addInt(d.p.data(), d.q.data(), i1.data(), n);
+    bool ok2 = ref.addInt(d.p.data(), d.q.data(), i2.data(), n);
+    if (ok1 != ok2 || (ok1 && i1 != i2))
+        return false;
+    ok1 = k.prefixSumInt(d.p.data(), i1.data(), n);
+    ok2 = ref.prefixSumInt(d.p.data(), i2.data(), n);
+    return ok1 == ok2 && (!ok1 || i1 == i2);
+}
+
+// Words over a small alphabet so that needles match often, separated by
+// every kind of whitespace
+static std::string makeText(size_t n, unsigned seed)
+{
+    static const char bytes[] = "abcab \t\n\x1c\x1fxy";
+    std::mt19937 rng(seed);
+    std::string text(n, ' ');
+    for (char &c : text)
+        c = bytes[rng() % (sizeof bytes - 1)];
+    return text;
+}
+
+static bool verifyStrings(const StringKernels &k, const StringKernels &ref, const std::string &text)
+{
+    const char *data = text.data();
+    size_t n = text.size();
+    for (char c : {'a', 'x', ' ', '\0'})
+        if (k.countByte(data, n, c) != ref.countByte(data, n, c))
+            return false;
+    std::vector<uint64_t> bits(spaceWords(n) + 1, ~uint64_t(0)), refBits = bits;
+    k.spaceBits(data, n, bits.data());
+    ref.spaceBits(data, n, refBits.data());
+    if (bits != refBits)
+        return false;
+    for (size_t start = 0; start < n; start += 7)
+        for (size_t m = 1; m <= 40 && start + m <= n; m += 3)
+        {
+            const char *needle = data + start;
+            for (size_t from = 0; from <= start; from += 5)
+                if (k.find(data + from, n - from, needle, m) != ref.find(data + from, n - from, needle, m))
+                    return false;
+        }
+    return k.find(data, n, "zz", 2) == notFound;
+}
+
+static void benchStrings(size_t n)
+{
+    std::vector<const StringKernels *> levels;
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2})
+        if (const StringKernels *kernels = stringKernels(level))
+            levels.push_back(kernels);
+
+    std::string text;
+    for (size_t line = 0; text.size() < n; ++line)
+        text += "2024-01-01 12:00:" + std::to_string(line % 60) + " INFO request served in " +
+                std::to_string(line % 997) + " ms\n";
+    std::vector<uint64_t> bits(spaceWords(text.size()));
+    const char *needle = " ERROR ";
+    int rounds = static_cast<int>(std::max<size_t>(20, 100000000 / (text.size() + 1)));
+    std::printf("\n%zu bytes of log text, selected level: %s, ns per byte\n", text.size(), stringKernels().name);
+    std::printf("%-8s %9s %9s %9s\n", "level", "find", "count", "split");
+    for (const StringKernels *k : levels)
+    {
+        const char *data = text.data();
+        size_t size = text.size();
+        double find = measure(rounds, [&] { sink = static_cast<double>(k->find(data, size, needle, std::strlen(needle))); });
+        double count = measure(rounds, [&] { sink = static_cast<double>(k->countByte(data, size, '\n')); });
+        double split = measure(rounds, [&]
+        {
+            k->spaceBits(data, size, bits.data());
+            size_t words = 0;
+            forEachWord(bits.data(), size, [&](size_t, size_t) { return ++words != 0; });
+            sink = static_cast<double>(words);
+        });
+        auto perByte = [size](double ms) { return ms * 1e6 / static_cast<double>(size); };
+        std::printf("%-8s %9.3f %9.3f %9.3f\n", k->name, perByte(find), perByte(count), perByte(split));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const ArrayKernels &scalar = *arrayKernels(SimdLevel::Scalar);
+    std::vector<const ArrayKernels *> levels;
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2})
+        if (const ArrayKernels *kernels = arrayKernels(level))
+            levels.push_back(kernels);
+
+    for (const ArrayKernels *kernels : levels)
+        for (size_t size : {size_t(0), size_t(1), size_t(7), size_t(9), size_t(1001)})
+            for (bool extreme : {false, true})
+                if (!verify(*kernels, scalar, makeData(size, extreme, static_cast<unsigned>(size))))
+                {
+                    std::printf("%s disagrees with scalar (n=%zu%s)\n", kernels->name, size,
+                                extreme ? ", extreme" : "");
+                    return 1;
+                }
+    const StringKernels &scalarStrings = *stringKernels(SimdLevel::Scalar);
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2})
+        if (const StringKernels *kernels = stringKernels(level))
+            for (size_t size : {size_t(0), size_t(1), size_t(15), size_t(33), size_t(517)})
+                if (!verifyStrings(*kernels, scalarStrings, makeText(size, static_cast<unsigned>(size))))
+                {
+                    std::printf("%s string kernels disagree with scalar (n=%zu)\n", kernels->name, size);
+                    return 1;
+                }
+
+    Data data = makeData(n, false, 1);
+    std::vector<double> out(n);
+    std::vector<long long> outInt(n);
+    int rounds = static_cast<int>(std::max<size_t>(20, 100000000 / (n + 1)));
+    std::printf("%zu elements, selected level: %s, ns per element\n", n, arrayKernels().name);
+    std::printf("%-8s %9s %9s %9s %9s %9s\n", "level", "sum d", "sum q", "dot d", "add d", "prefix q");
+    for (const ArrayKernels *k : levels)
+    {
+        double sumD = measure(rounds, [&] { sink = k->sumFloat(data.x.data(), n); });
+        double sumQ = measure(rounds, [&] { sink = static_cast<double>(k->sumInt(data.p.data(), n)); });
+        double dotD = measure(rounds, [&] { sink = k->dotFloat(data.x.data(), data.y.data(), n); });
+        double addD = measure(rounds, [&] { k->addFloat(data.x.data(), data.y.data(), out.data(), n); });
+        double prefixQ = measure(rounds, [&] { sink = k->prefixSumInt(data.p.data(), outInt.data(), n); });
+        auto perElement = [n](double ms) { return ms * 1e6 / static_cast<double>(n); };
+        std::printf("%-8s %9.3f %9.3f %9.3f %9.3f %9.3f\n", k->name, perElement(sumD), perElement(sumQ),
+                    perElement(dotD), perElement(addD), perElement(prefixQ));
+    }
+    benchStrings(n * 8);
+    return 0;
+}
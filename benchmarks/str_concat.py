@@ -0,0 +1,10 @@
+# Builds a 10 MB string one 64-byte line at a time with `s = s + line`,
+# then doubles a short piece the same way with repetition.
+line = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.\n"
+s = ""
+i = 0
+while i < 163840:
+    s = s + line
+    i = i + 1
+print(len(s))
+print(len("0123456789" * 1000000))
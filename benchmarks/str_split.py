@@ -0,0 +1,20 @@
+# Log processing with the native str methods: splits 8 MB of log text
+# into lines, then splits, searches and counts each line.
+a = "2024-01-01 12:00:01 INFO request served in 12 ms path=/index.html\n"
+b = "2024-01-01 12:00:02 ERROR upstream timed out after 3000 ms path=/api\n"
+c = "2024-01-01 12:00:03 WARN  slow response from cache tier path=/static\n"
+log = (a + a + b + a + c + a + a + a) * 15000
+lines = log.split("\n")
+words = 0
+errors = 0
+slow = 0
+for line in lines:
+    words += len(line.split())
+    if line.find("ERROR") >= 0:
+        errors += 1
+    slow += line.count("ms")
+print(len(lines))
+print(words)
+print(errors)
+print(slow)
+print(len(" ".join(lines[0:4]).replace("path=", "")))
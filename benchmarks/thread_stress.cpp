@@ -0,0 +1,110 @@
+// Thread stress test: one compiled Program run by many sessions at once,
+// each on its own thread with its own input. The script exercises the
+// state that used to live in the shared tree: string literals appended
+// to, in-place augmented assignment, boxed literals, type feedback and
+// per-thread print buffers. Every thread's results must match a
+// single-threaded run of the same inputs.
+// Build with `make bench`, run as benchmarks/thread_stress [threads] [rounds].
+#include "embed.hpp"
+#include "output.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static const char *script = R"(class Point:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+
+def work(seed, n):
+    text = ""
+    total = 0
+    scale = 0.5
+    counts = {}
+    buckets = [1, 1, 1, 1, 1, 1, 1]
+    points = []
+    i = 0
+    while i < n:
+        text = text + "ab"
+        text += str(i % 10)
+        total += i * seed
+        scale *= 1.0001
+        key = f"k{i % 7}"
+        counts[key] = buckets[i % 7]
+        buckets[i % 7] += 1
+        points.append(Point(i, seed))
+        i += 1
+    words = text.split("b")
+    last = points[len(points) - 1]
+    return f"{seed}:{len(text)}:{total}:{scale:.6f}:{len(words)}:{counts['k3']}:{last.x + last.y}"
+
+def report(seed):
+    print(f"thread {seed} done")
+    flush()
+    return seed
+)";
+
+static std::string runWork(Session &session, long long seed, long long n)
+{
+    return session.call<std::string>("work", seed, n);
+}
+
+int main(int argc, char **argv)
+{
+    int threads = argc > 1 ? std::atoi(argv[1]) : 64;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 4;
+    const long long n = 2000;
+    std::shared_ptr<const Program> program = Program::compile(script);
+
+    // Expected results, one session at a time
+    auto start = Clock::now();
+    std::vector<std::vector<std::string>> expected(threads);
+    for (int t = 0; t < threads; ++t)
+    {
+        Session session(program);
+        session.run();
+        for (int round = 0; round < rounds; ++round)
+            expected[t].push_back(runWork(session, t * 1000 + round, n));
+    }
+    double sequential = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::atomic<int> failures(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]
+        {
+            try
+            {
+                Session session(program);
+                while (!go.load())
+                    std::this_thread::yield();
+                session.run();
+                for (int round = 0; round < rounds; ++round)
+                    if (runWork(session, t * 1000 + round, n) != expected[t][round])
+                        failures.fetch_add(1);
+                session.call<long long>("report", t);
+            }
+            catch (const std::exception &e)
+            {
+                std::fprintf(stderr, "thread %d: %s\n", t, e.what());
+                failures.fetch_add(1);
+            }
+        });
+    start = Clock::now();
+    go.store(true);
+    for (std::thread &worker : workers)
+        worker.join();
+    double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    Output::standard().flush();
+    std::printf("%d threads x %d rounds: %d mismatches, %.0f ms in parallel, %.0f ms one at a time\n", threads,
+                rounds, failures.load(), elapsed, sequential);
+    return failures.load() == 0 ? 0 : 1;
+}
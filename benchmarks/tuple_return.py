@@ -0,0 +1,13 @@
+# Two results per call, returned as a tuple and unpacked at the call site.
+def divmod10(n):
+    return n // 10, n % 10
+
+digits = 0
+remainders = 0
+i = 0
+while i < 500000:
+    q, r = divmod10(i)
+    digits = digits + q
+    remainders = remainders + r
+    i = i + 1
+print(digits + remainders)
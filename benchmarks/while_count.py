@@ -0,0 +1,8 @@
+# The same counted loop as for_range.py written with while: every
+# iteration looks up, compares and rebinds the counter.
+total = 0
+i = 0
+while i < 3000000:
+    total = total + i
+    i = i + 1
+print(total)
@@ -0,0 +1,599 @@
+#include "bigint.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using Limbs = std::vector<uint32_t>;
+
+// ==================== Magnitude Helpers ====================
+static void trimMagnitude(Limbs &limbs)
+{
+    while (!limbs.empty() && limbs.back() == 0)
+        limbs.pop_back();
+}
+
+static int compareMagnitude(const Limbs &a, const Limbs &b)
+{
+    if (a.size() != b.size())
+        return a.size() < b.size() ? -1 : 1;
+    for (size_t i = a.size(); i-- > 0;)
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    return 0;
+}
+
+static Limbs addMagnitude(const Limbs &a, const Limbs &b)
+{
+    const Limbs &longer = a.size() >= b.size() ? a : b;
+    const Limbs &shorter = a.size() >= b.size() ? b : a;
+    Limbs result(longer.size() + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < longer.size(); ++i)
+    {
+        uint64_t sum = static_cast<uint64_t>(longer[i]) + (i < shorter.size() ? shorter[i] : 0) + carry;
+        result[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    result[longer.size()] = static_cast<uint32_t>(carry);
+    trimMagnitude(result);
+    return result;
+}
+
+// acc -= x, where acc >= x
+static void subtractInPlace(Limbs &acc, const Limbs &x)
+{
+    int64_t borrow = 0;
+    for (size_t i = 0; i < acc.size(); ++i)
+    {
+        int64_t diff = static_cast<int64_t>(acc[i]) - (i < x.size() ? x[i] : 0) - borrow;
+        acc[i] = static_cast<uint32_t>(diff);
+        borrow = diff < 0 ? 1 : 0;
+        if (i >= x.size() && !borrow)
+            break;
+    }
+    trimMagnitude(acc);
+}
+
+// acc += x << (32 * shift); acc must have room for the result
+static void addShifted(Limbs &acc, const Limbs &x, size_t shift)
+{
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < x.size(); ++i)
+    {
+        uint64_t sum = static_cast<uint64_t>(acc[i + shift]) + x[i] + carry;
+        acc[i + shift] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    for (i += shift; carry; ++i)
+    {
+        uint64_t sum = static_cast<uint64_t>(acc[i]) + carry;
+        acc[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+}
+
+static void mulAddSmall(Limbs &limbs, uint32_t multiplier, uint32_t addend)
+{
+    uint64_t carry = addend;
+    for (uint32_t &limb : limbs)
+    {
+        uint64_t product = static_cast<uint64_t>(limb) * multiplier + carry;
+        limb = static_cast<uint32_t>(product);
+        carry = product >> 32;
+    }
+    if (carry)
+        limbs.push_back(static_cast<uint32_t>(carry));
+}
+
+// Divides in place and returns the remainder
+static uint32_t divSmall(Limbs &limbs, uint32_t divisor)
+{
+    uint64_t remainder = 0;
+    for (size_t i = limbs.size(); i-- > 0;)
+    {
+        uint64_t current = (remainder << 32) | limbs[i];
+        limbs[i] = static_cast<uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+    trimMagnitude(limbs);
+    return static_cast<uint32_t>(remainder);
+}
+
+// ==================== Multiplication ====================
+static Limbs schoolbookMultiply(const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+    Limbs result(na + nb);
+    for (size_t i = 0; i < na; ++i)
+    {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < nb; ++j)
+        {
+            uint64_t current = static_cast<uint64_t>(a[i]) * b[j] + result[i + j] + carry;
+            result[i + j] = static_cast<uint32_t>(current);
+            carry = current >> 32;
+        }
+        result[i + nb] = static_cast<uint32_t>(carry);
+    }
+    trimMagnitude(result);
+    return result;
+}
+
+static Limbs karatsubaMultiply(const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+    if (na < nb)
+    {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (nb == 0)
+        return Limbs();
+    if (nb < BigInt::karatsubaThreshold)
+        return schoolbookMultiply(a, na, b, nb);
+
+    // Unbalanced operands: multiply b by each nb-limb slice of a
+    if (na >= 2 * nb)
+    {
+        Limbs result(na + nb + 1);
+        for (size_t offset = 0; offset < na; offset += nb)
+        {
+            size_t length = std::min(nb, na - offset);
+            addShifted(result, karatsubaMultiply(a + offset, length, b, nb), offset);
+        }
+        trimMagnitude(result);
+        return result;
+    }
+
+    // a = a1 * B^m + a0, b = b1 * B^m + b0 with m < nb, so b1 is not empty
+    size_t m = na / 2;
+    Limbs a0(a, a + m), a1(a + m, a + na);
+    Limbs b0(b, b + m), b1(b + m, b + nb);
+    trimMagnitude(a0);
+    trimMagnitude(b0);
+
+    Limbs z0 = karatsubaMultiply(a0.data(), a0.size(), b0.data(), b0.size());
+    Limbs z2 = karatsubaMultiply(a1.data(), a1.size(), b1.data(), b1.size());
+    Limbs sumA = addMagnitude(a0, a1);
+    Limbs sumB = addMagnitude(b0, b1);
+    Limbs z1 = karatsubaMultiply(sumA.data(), sumA.size(), sumB.data(), sumB.size());
+    subtractInPlace(z1, z0);
+    subtractInPlace(z1, z2);
+
+    Limbs result(na + nb + 1);
+    addShifted(result, z0, 0);
+    addShifted(result, z1, m);
+    addShifted(result, z2, 2 * m);
+    trimMagnitude(result);
+    return result;
+}
+
+// ==================== Division ====================
+// Knuth's Algorithm D (TAOCP vol. 2, 4.3.1) on truncated magnitudes
+static void divModMagnitude(const Limbs &a, const Limbs &b, Limbs &quotient, Limbs &remainder)
+{
+    if (compareMagnitude(a, b) < 0)
+    {
+        quotient.clear();
+        remainder = a;
+        return;
+    }
+    if (b.size() == 1)
+    {
+        quotient = a;
+        uint32_t rem = divSmall(quotient, b[0]);
+        remainder.clear();
+        if (rem)
+            remainder.push_back(rem);
+        return;
+    }
+
+    // Normalize so the divisor's top limb has its high bit set
+    int shift = __builtin_clz(b.back());
+    size_t n = b.size();
+    size_t m = a.size() - n;
+    Limbs v(n), u(a.size() + 1);
+    for (size_t i = n; i-- > 0;)
+        v[i] = (b[i] << shift) | (shift && i > 0 ? b[i - 1] >> (32 - shift) : 0);
+    u[a.size()] = shift ? a.back() >> (32 - shift) : 0;
+    for (size_t i = a.size(); i-- > 0;)
+        u[i] = (a[i] << shift) | (shift && i > 0 ? a[i - 1] >> (32 - shift) : 0);
+
+    quotient.assign(m + 1, 0);
+    const uint64_t base = 1ull << 32;
+    for (size_t j = m + 1; j-- > 0;)
+    {
+        uint64_t numerator = (static_cast<uint64_t>(u[j + n]) << 32) | u[j + n - 1];
+        uint64_t qhat = numerator / v[n - 1];
+        uint64_t rhat = numerator % v[n - 1];
+        while (qhat >= base || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2]))
+        {
+            qhat--;
+            rhat += v[n - 1];
+            if (rhat >= base)
+                break;
+        }
+
+        int64_t borrow = 0;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            uint64_t product = qhat * v[i] + carry;
+            carry = product >> 32;
+            int64_t diff = static_cast<int64_t>(u[i + j]) - static_cast<uint32_t>(product) - borrow;
+            u[i + j] = static_cast<uint32_t>(diff);
+            borrow = diff < 0 ? 1 : 0;
+        }
+        int64_t top = static_cast<int64_t>(u[j + n]) - static_cast<int64_t>(carry) - borrow;
+        u[j + n] = static_cast<uint32_t>(top);
+
+        if (top < 0)
+        {
+            // qhat was one too large; add the divisor back
+            qhat--;
+            uint64_t sumCarry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                uint64_t sum = static_cast<uint64_t>(u[i + j]) + v[i] + sumCarry;
+                u[i + j] = static_cast<uint32_t>(sum);
+                sumCarry = sum >> 32;
+            }
+            u[j + n] += static_cast<uint32_t>(sumCarry);
+        }
+        quotient[j] = static_cast<uint32_t>(qhat);
+    }
+
+    remainder.assign(n, 0);
+    for (size_t i = 0; i < n; ++i)
+        remainder[i] = (u[i] >> shift) | (shift ? u[i + 1] << (32 - shift) : 0);
+    trimMagnitude(quotient);
+    trimMagnitude(remainder);
+}
+
+// ==================== BigInt ====================
+BigInt::BigInt(long long value)
+{
+    negative = value < 0;
+    uint64_t magnitude = negative ? 0ull - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    while (magnitude)
+    {
+        limbs.push_back(static_cast<uint32_t>(magnitude));
+        magnitude >>= 32;
+    }
+}
+
+void BigInt::trim()
+{
+    trimMagnitude(limbs);
+    if (limbs.empty())
+        negative = false;
+}
+
+BigInt BigInt::fromString(const std::string &text)
+{
+    BigInt result;
+    size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+        negative = text[i++] == '-';
+    if (i == text.size())
+        throw std::runtime_error("Invalid integer literal '" + text + "'");
+
+    // Nine decimal digits at a time: result = result * 10^k + chunk
+    while (i < text.size())
+    {
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for (int k = 0; k < 9 && i < text.size(); ++k, ++i)
+        {
+            char c = text[i];
+            if (c < '0' || c > '9')
+                throw std::runtime_error("Invalid integer literal '" + text + "'");
+            chunk = chunk * 10 + static_cast<uint32_t>(c - '0');
+            scale *= 10;
+        }
+        mulAddSmall(result.limbs, scale, chunk);
+    }
+    result.negative = negative;
+    result.trim();
+    return result;
+}
+
+bool BigInt::fitsInt64() const
+{
+    if (limbs.size() > 2)
+        return false;
+    uint64_t magnitude = 0;
+    for (size_t i = limbs.size(); i-- > 0;)
+        magnitude = (magnitude << 32) | limbs[i];
+    return magnitude <= (negative ? 1ull << 63 : (1ull << 63) - 1);
+}
+
+long long BigInt::toInt64() const
+{
+    uint64_t magnitude = 0;
+    for (size_t i = limbs.size(); i-- > 0;)
+        magnitude = (magnitude << 32) | limbs[i];
+    return static_cast<long long>(negative ? 0ull - magnitude : magnitude);
+}
+
+double BigInt::toDouble() const
+{
+    double result = 0.0;
+    for (size_t i = limbs.size(); i-- > 0;)
+        result = result * 4294967296.0 + limbs[i];
+    return negative ? -result : result;
+}
+
+std::string BigInt::toString() const
+{
+    if (limbs.empty())
+        return "0";
+
+    // Peel off base-10^9 digits from the bottom
+    Limbs magnitude = limbs;
+    std::vector<uint32_t> chunks;
+    while (!magnitude.empty())
+        chunks.push_back(divSmall(magnitude, 1000000000u));
+
+    std::string out = negative ? "-" : "";
+    out += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;)
+    {
+        std::string digits = std::to_string(chunks[i]);
+        out.append(9 - digits.size(), '0');
+        out += digits;
+    }
+    return out;
+}
+
+std::string BigInt::toString(int base) const
+{
+    if (base == 10)
+        return toString();
+    if (limbs.empty())
+        return "0";
+
+    // A power-of-two base takes its digits straight from the bits, most
+    // significant first; a digit may straddle two limbs
+    unsigned bits = base == 2 ? 1 : base == 8 ? 3 : 4;
+    unsigned long long count = (bitLength() + bits - 1) / bits;
+    std::string out = negative ? "-" : "";
+    out.reserve(out.size() + count);
+    for (unsigned long long digit = count; digit-- > 0;)
+    {
+        unsigned long long position = digit * bits;
+        size_t limb = position / 32;
+        unsigned shift = position % 32;
+        uint64_t window = limbs[limb] >> shift;
+        if (shift + bits > 32 && limb + 1 < limbs.size())
+            window |= static_cast<uint64_t>(limbs[limb + 1]) << (32 - shift);
+        out += "0123456789abcdef"[window & (base - 1)];
+    }
+    return out;
+}
+
+BigInt BigInt::operator-() const
+{
+    BigInt result = *this;
+    if (!result.limbs.empty())
+        result.negative = !negative;
+    return result;
+}
+
+BigInt operator+(const BigInt &a, const BigInt &b)
+{
+    BigInt result;
+    if (a.negative == b.negative)
+    {
+        result.limbs = addMagnitude(a.limbs, b.limbs);
+        result.negative = a.negative;
+    }
+    else if (compareMagnitude(a.limbs, b.limbs) >= 0)
+    {
+        result.limbs = a.limbs;
+        subtractInPlace(result.limbs, b.limbs);
+        result.negative = a.negative;
+    }
+    else
+    {
+        result.limbs = b.limbs;
+        subtractInPlace(result.limbs, a.limbs);
+        result.negative = b.negative;
+    }
+    result.trim();
+    return result;
+}
+
+BigInt operator-(const BigInt &a, const BigInt &b)
+{
+    return a + (-b);
+}
+
+BigInt operator*(const BigInt &a, const BigInt &b)
+{
+    BigInt result;
+    result.limbs = karatsubaMultiply(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size());
+    result.negative = a.negative != b.negative;
+    result.trim();
+    return result;
+}
+
+void BigInt::divmod(const BigInt &a, const BigInt &b, BigInt *quotient, BigInt *remainder)
+{
+    if (b.isZero())
+        throw std::runtime_error("Integer division or modulo by zero");
+
+    BigInt q, r;
+    divModMagnitude(a.limbs, b.limbs, q.limbs, r.limbs);
+    q.negative = a.negative != b.negative;
+    r.negative = a.negative;
+    q.trim();
+    r.trim();
+
+    // Truncated -> floored when the signs differ and the division was inexact
+    if (!r.isZero() && a.negative != b.negative)
+    {
+        q = q - BigInt(1);
+        r = r + b;
+    }
+    if (quotient)
+        *quotient = std::move(q);
+    if (remainder)
+        *remainder = std::move(r);
+}
+
+BigInt BigInt::pow(BigInt base, unsigned long long exponent)
+{
+    BigInt result(1);
+    while (exponent > 0)
+    {
+        if (exponent & 1)
+            result = result * base;
+        exponent >>= 1;
+        if (exponent > 0)
+            base = base * base;
+    }
+    return result;
+}
+
+int BigInt::compare(const BigInt &a, const BigInt &b)
+{
+    if (a.negative != b.negative)
+        return a.negative ? -1 : 1;
+    int magnitude = compareMagnitude(a.limbs, b.limbs);
+    return a.negative ? -magnitude : magnitude;
+}
+
+// ==================== Bitwise Operations ====================
+// Two's complement limbs of a value, sign-extended to n limbs
+static Limbs twosComplement(const Limbs &magnitude, bool negative, size_t n)
+{
+    Limbs out(magnitude);
+    out.resize(n, 0);
+    if (negative)
+    {
+        // -x == ~(x - 1)
+        for (uint32_t &limb : out)
+            if (limb-- != 0)
+                break;
+        for (uint32_t &limb : out)
+            limb = ~limb;
+    }
+    return out;
+}
+
+template <typename Op>
+BigInt BigInt::bitwise(const BigInt &a, const BigInt &b, Op op)
+{
+    size_t n = std::max(a.limbs.size(), b.limbs.size()) + 1;
+    Limbs x = twosComplement(a.limbs, a.negative, n);
+    Limbs y = twosComplement(b.limbs, b.negative, n);
+
+    BigInt result;
+    result.limbs.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        result.limbs[i] = op(x[i], y[i]);
+
+    // A set sign bit means the magnitude is ~result + 1
+    result.negative = (result.limbs.back() >> 31) != 0;
+    if (result.negative)
+    {
+        for (uint32_t &limb : result.limbs)
+            limb = ~limb;
+        for (uint32_t &limb : result.limbs)
+            if (++limb != 0)
+                break;
+    }
+    result.trim();
+    return result;
+}
+
+BigInt BigInt::operator~() const
+{
+    return -(*this + BigInt(1));
+}
+
+BigInt operator&(const BigInt &a, const BigInt &b)
+{
+    return BigInt::bitwise(a, b, [](uint32_t x, uint32_t y) { return x & y; });
+}
+
+BigInt operator|(const BigInt &a, const BigInt &b)
+{
+    return BigInt::bitwise(a, b, [](uint32_t x, uint32_t y) { return x | y; });
+}
+
+BigInt operator^(const BigInt &a, const BigInt &b)
+{
+    return BigInt::bitwise(a, b, [](uint32_t x, uint32_t y) { return x ^ y; });
+}
+
+static Limbs shiftMagnitudeRight(const Limbs &magnitude, unsigned long long bits)
+{
+    size_t limbShift = bits / 32;
+    unsigned bitShift = bits % 32;
+    if (limbShift >= magnitude.size())
+        return Limbs();
+
+    Limbs out(magnitude.size() - limbShift);
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        uint64_t window = magnitude[i + limbShift];
+        if (i + limbShift + 1 < magnitude.size())
+            window |= static_cast<uint64_t>(magnitude[i + limbShift + 1]) << 32;
+        out[i] = static_cast<uint32_t>(window >> bitShift);
+    }
+    trimMagnitude(out);
+    return out;
+}
+
+BigInt BigInt::shiftLeft(unsigned long long bits) const
+{
+    if (limbs.empty())
+        return *this;
+    size_t limbShift = bits / 32;
+    unsigned bitShift = bits % 32;
+
+    BigInt result;
+    result.negative = negative;
+    result.limbs.assign(limbs.size() + limbShift + 1, 0);
+    for (size_t i = 0; i < limbs.size(); ++i)
+    {
+        uint64_t shifted = static_cast<uint64_t>(limbs[i]) << bitShift;
+        result.limbs[i + limbShift] |= static_cast<uint32_t>(shifted);
+        result.limbs[i + limbShift + 1] |= static_cast<uint32_t>(shifted >> 32);
+    }
+    result.trim();
+    return result;
+}
+
+BigInt BigInt::shiftRight(unsigned long long bits) const
+{
+    BigInt result;
+    if (!negative)
+    {
+        result.limbs = shiftMagnitudeRight(limbs, bits);
+        result.trim();
+        return result;
+    }
+    // floor(-x / 2^k) == -(((x - 1) >> k) + 1)
+    BigInt decremented = -*this - BigInt(1);
+    result.limbs = shiftMagnitudeRight(decremented.limbs, bits);
+    result.trim();
+    return -(result + BigInt(1));
+}
+
+unsigned long long BigInt::popcount() const
+{
+    unsigned long long count = 0;
+    for (uint32_t limb : limbs)
+        count += __builtin_popcount(limb);
+    return count;
+}
+
+unsigned long long BigInt::bitLength() const
+{
+    if (limbs.empty())
+        return 0;
+    return (limbs.size() - 1) * 32 + (32 - __builtin_clz(limbs.back()));
+}
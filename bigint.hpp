@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==================== Arbitrary-Precision Integers ====================
+// Sign-magnitude integer with base 2^32 limbs, least significant first.
+// PyInt keeps values that fit in 64 bits inline and only promotes to a
+// BigInt when a result leaves that range, so nothing here is on the
+// common path. Multiplication switches from the schoolbook method to
+// Karatsuba once both operands have karatsubaThreshold limbs.
+class BigInt
+{
+public:
+    static constexpr size_t karatsubaThreshold = 32;
+
+    BigInt() = default;
+    BigInt(long long value);
+    // Decimal digits with an optional sign
+    static BigInt fromString(const std::string &text);
+
+    bool isZero() const { return limbs.empty(); }
+    bool isNegative() const { return negative; }
+    bool fitsInt64() const;
+    long long toInt64() const; // Requires fitsInt64()
+    double toDouble() const;
+    std::string toString() const;
+    // Digits in base 2, 8, 10 or 16, lowercase, after a '-' if negative
+    std::string toString(int base) const;
+
+    BigInt operator-() const;
+    friend BigInt operator+(const BigInt &a, const BigInt &b);
+    friend BigInt operator-(const BigInt &a, const BigInt &b);
+    friend BigInt operator*(const BigInt &a, const BigInt &b);
+
+    // Floor division: the remainder takes the sign of the divisor.
+    // Throws std::runtime_error on a zero divisor.
+    static void divmod(const BigInt &a, const BigInt &b, BigInt *quotient, BigInt *remainder);
+    static BigInt pow(BigInt base, unsigned long long exponent);
+    // -1, 0 or 1
+    static int compare(const BigInt &a, const BigInt &b);
+
+    // Bitwise operators act on the infinite two's complement form, as in
+    // Python; right shifts round toward negative infinity
+    BigInt operator~() const;
+    friend BigInt operator&(const BigInt &a, const BigInt &b);
+    friend BigInt operator|(const BigInt &a, const BigInt &b);
+    friend BigInt operator^(const BigInt &a, const BigInt &b);
+    BigInt shiftLeft(unsigned long long bits) const;
+    BigInt shiftRight(unsigned long long bits) const;
+    // Of the magnitude, like int.bit_count() and int.bit_length()
+    unsigned long long popcount() const;
+    unsigned long long bitLength() const;
+
+private:
+    using Limbs = std::vector<uint32_t>;
+
+    void trim();
+    template <typename Op>
+    static BigInt bitwise(const BigInt &a, const BigInt &b, Op op);
+
+    bool negative = false;
+    Limbs limbs; // Magnitude without leading zero limbs; empty for zero
+};
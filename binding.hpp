@@ -0,0 +1,150 @@
+#pragma once
+
+#include "pyobject.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ==================== Native Binding ====================
+// Wraps a plain C++ function as a PyBuiltin. The function and its name
+// are template arguments, so each binding is its own wrapper with the
+// unboxing of every parameter and the boxing of the result inlined:
+//
+//     module->define(bind<"hypot", hypotValue>());
+//
+// wraps `double hypotValue(double, double)` as hypot(x, y). Parameters
+// may be long long (an int that fits in 64 bits, or a bool), double (any
+// int, float or bool), bool (any value's truth), std::string (a str) or
+// PyObject * (passed through); results may also be void, which gives
+// None. Functions that
+// need variable arity or several argument types take the argument vector
+// directly instead.
+
+// A string literal usable as a template argument
+template <size_t N>
+struct BuiltinName
+{
+    char text[N];
+    constexpr BuiltinName(const char (&name)[N])
+    {
+        for (size_t i = 0; i < N; ++i)
+            text[i] = name[i];
+    }
+};
+
+// Position of a script function's return value when the host unboxes it
+constexpr size_t resultPosition = static_cast<size_t>(-1);
+
+[[noreturn]] inline void throwArgumentType(const char *function, size_t position, const char *expected)
+{
+    if (position == resultPosition)
+        throw std::runtime_error(std::string(function) + "() must return " + expected);
+    throw std::runtime_error(std::string(function) + "() argument " + std::to_string(position + 1) +
+                             " must be " + expected);
+}
+
+template <typename T>
+struct Unbox;
+
+template <>
+struct Unbox<long long>
+{
+    static long long from(PyObject *arg, const char *function, size_t position)
+    {
+        if (arg->kind == ObjectKind::Int && !static_cast<PyInt *>(arg)->big)
+            return static_cast<PyInt *>(arg)->value;
+        if (arg->kind == ObjectKind::Bool)
+            return static_cast<PyBool *>(arg)->value ? 1 : 0;
+        throwArgumentType(function, position, "an int that fits in 64 bits");
+    }
+};
+
+template <>
+struct Unbox<double>
+{
+    static double from(PyObject *arg, const char *function, size_t position)
+    {
+        switch (arg->kind)
+        {
+        case ObjectKind::Float:
+            return static_cast<PyFloat *>(arg)->value;
+        case ObjectKind::Int:
+            return static_cast<PyInt *>(arg)->toDouble();
+        case ObjectKind::Bool:
+            return static_cast<PyBool *>(arg)->value ? 1.0 : 0.0;
+        default:
+            throwArgumentType(function, position, "a number");
+        }
+    }
+};
+
+template <>
+struct Unbox<bool>
+{
+    static bool from(PyObject *arg, const char *, size_t) { return arg->isTruthy(); }
+};
+
+template <>
+struct Unbox<std::string>
+{
+    static std::string from(PyObject *arg, const char *function, size_t position)
+    {
+        if (arg->kind != ObjectKind::Str)
+            throwArgumentType(function, position, "a str");
+        return std::string(static_cast<PyStr *>(arg)->view());
+    }
+};
+
+template <>
+struct Unbox<PyObject *>
+{
+    static PyObject *from(PyObject *arg, const char *, size_t) { return arg; }
+};
+
+inline PyObject *box(int value) { return new PyInt(value); }
+inline PyObject *box(long long value) { return new PyInt(value); }
+inline PyObject *box(double value) { return new PyFloat(value); }
+inline PyObject *box(bool value) { return new PyBool(value); }
+inline PyObject *box(const char *value) { return new PyStr(value); }
+inline PyObject *box(const std::string &value) { return new PyStr(value); }
+inline PyObject *box(PyObject *value) { return value; }
+
+template <BuiltinName Name, auto Function>
+struct Binding;
+
+template <BuiltinName Name, typename Result, typename... Params, Result (*Function)(Params...)>
+struct Binding<Name, Function>
+{
+    static constexpr size_t arity = sizeof...(Params);
+
+    static PyObject *call(const std::vector<PyObject *> &args)
+    {
+        return callWith(args, std::index_sequence_for<Params...>());
+    }
+
+private:
+    template <size_t... I>
+    static PyObject *callWith([[maybe_unused]] const std::vector<PyObject *> &args, std::index_sequence<I...>)
+    {
+        if constexpr (std::is_void_v<Result>)
+        {
+            Function(Unbox<std::decay_t<Params>>::from(args[I], Name.text, I)...);
+            return new PyNone();
+        }
+        else
+        {
+            return box(Function(Unbox<std::decay_t<Params>>::from(args[I], Name.text, I)...));
+        }
+    }
+};
+
+template <BuiltinName Name, auto Function>
+PyBuiltin *bind()
+{
+    using Bound = Binding<Name, Function>;
+    return new PyBuiltin(Name.text, Bound::arity, &Bound::call);
+}
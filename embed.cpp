@@ -0,0 +1,110 @@
+#include "embed.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include <fstream>
+#include <stdexcept>
+
+// ==================== Program ====================
+
+Program::Program(const std::string &source, const OptimizerOptions &options, int siteBase)
+    : text(source), settings(options)
+{
+    Lexer lexer(text);
+    std::vector<Token> tokens = lexer.scanTokens();
+    Parser parser(tokens);
+    tree = parser.parse();
+    tree->siteBase = siteBase;
+    try
+    {
+        PassManager passes(settings);
+        passes.run(tree);
+        Interpreter::prepare(tree);
+    }
+    catch (...)
+    {
+        delete tree;
+        throw;
+    }
+}
+
+Program::~Program()
+{
+    delete tree;
+}
+
+std::shared_ptr<Program> Program::compile(const std::string &source, const OptimizerOptions &options)
+{
+    return std::shared_ptr<Program>(new Program(source, options, 0));
+}
+
+std::shared_ptr<Program> Program::compile(const std::string &source, const OptimizerOptions &options,
+                                          const Program &previous)
+{
+    return std::shared_ptr<Program>(new Program(source, options, previous.root()->siteCount));
+}
+
+std::shared_ptr<Program> Program::compileFile(const std::string &path, const OptimizerOptions &options)
+{
+    std::ifstream file(path);
+    if (!file)
+        throw std::runtime_error("could not open file '" + path + "'");
+    std::string source((std::istreambuf_iterator<char>(file)), {});
+    return compile(source, options);
+}
+
+// ==================== Session ====================
+
+Session::Session(std::shared_ptr<const Program> program) : compiled(std::move(program))
+{
+}
+
+Session::Session(const Session &start) : compiled(start.compiled), continued(start.continued)
+{
+    Heap::Use use(heap);
+    interpreter.copyFrom(start.interpreter);
+}
+
+void Session::run()
+{
+    Heap::Use use(heap);
+    interpreter.interpret(compiled->root());
+}
+
+void Session::run(std::shared_ptr<const Program> next)
+{
+    const Program &last = continued.empty() ? *compiled : *continued.back();
+    if (next->root()->siteBase != last.root()->siteCount)
+        throw std::runtime_error("program was not compiled to follow this session's");
+    continued.push_back(next);
+    Heap::Use use(heap);
+    interpreter.interpret(next->root());
+}
+
+void Session::freeze()
+{
+    interpreter.freezeGlobals();
+}
+
+PyObject *Session::call(const std::string &name, const std::vector<PyObject *> &args)
+{
+    Heap::Use use(heap);
+    return interpreter.callValue(global(name), args);
+}
+
+void Session::setGlobal(const std::string &name, PyObject *value)
+{
+    interpreter.defineGlobal(name, value);
+}
+
+PyObject *Session::global(const std::string &name) const
+{
+    if (PyObject *value = interpreter.findGlobal(name))
+        return value;
+    throw std::runtime_error("Undefined variable '" + name + "'");
+}
+
+void Session::define(const std::string &name, size_t minArity, size_t maxArity, PyBuiltin::Function function)
+{
+    Heap::Use use(heap);
+    setGlobal(name, new PyBuiltin(name, minArity, maxArity, function));
+}
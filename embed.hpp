@@ -0,0 +1,130 @@
+#pragma once
+
+#include "ast.hpp"
+#include "binding.hpp"
+#include "interpreter.hpp"
+#include "optimizer.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// ==================== Embedding API ====================
+// Runs scripts inside a host process, without spawning the interpreter
+// or re-reading the source for each evaluation. A Program is a source
+// compiled once: lexed, parsed and optimized. A Session runs a program's
+// top level in fresh globals and then lets the host call its functions
+// with native arguments:
+//
+//     auto program = Program::compile(source);
+//     Session session(program);
+//     session.define<"clamp", clamp>(); // host function, see binding.hpp
+//     session.setGlobal("limit", 10);
+//     session.run();
+//     double score = session.call<double>("score", 3.5, "abc");
+//
+// Script errors surface as std::runtime_error from compile(), run() and
+// call(). Objects the script creates, and those boxing the host's
+// arguments, live in the session's own Heap and are destroyed with the
+// session, so a PyObject * the host gets back stays valid as long as the
+// session and no longer.
+//
+// A compiled Program is immutable: compile() fills every cache the tree
+// has, and sessions keep all run-time state (scopes, objects, type
+// feedback) to themselves. Any number of sessions may run one program at
+// once, each on its own thread; a session itself is single-threaded.
+// Output from each thread is buffered separately (see Output::standard).
+
+class Program
+{
+public:
+    static std::shared_ptr<Program> compile(const std::string &source, const OptimizerOptions &options = {});
+    // Compiles `source` to run after `previous` in the same session (see
+    // Session::run(program)), with its feedback sites numbered after
+    // previous's so that one profile covers both
+    static std::shared_ptr<Program> compile(const std::string &source, const OptimizerOptions &options,
+                                            const Program &previous);
+    // Throws if the file cannot be read
+    static std::shared_ptr<Program> compileFile(const std::string &path, const OptimizerOptions &options = {});
+
+    Program(const Program &) = delete;
+    Program &operator=(const Program &) = delete;
+    ~Program();
+
+    // Read-only once compiled
+    ProgramNode *root() const { return tree; }
+    const std::string &source() const { return text; }
+    const OptimizerOptions &options() const { return settings; }
+
+private:
+    Program(const std::string &source, const OptimizerOptions &options, int siteBase);
+
+    std::string text;
+    OptimizerOptions settings;
+    ProgramNode *tree = nullptr;
+};
+
+class Session
+{
+public:
+    explicit Session(std::shared_ptr<const Program> program);
+    // A session where `start` is now: the programs it ran count as run
+    // here too, and its globals and type feedback are copied, so nothing
+    // this session does reaches `start` or its other copies. `start` must
+    // be frozen and must not run again while it is being copied.
+    explicit Session(const Session &start);
+
+    // Executes the program's top level; globals it defines stay in the
+    // session for later calls
+    void run();
+    // Executes a further program, compiled to follow the last one this
+    // session ran, in the globals the session has so far: a script after
+    // its prelude, say. Throws if `next` was compiled after another.
+    void run(std::shared_ptr<const Program> next);
+    // Readies the session to be copied from any number of threads at once;
+    // call it after the session's last run
+    void freeze();
+
+    // Calls the global function (or class, or builtin) `name`
+    PyObject *call(const std::string &name, const std::vector<PyObject *> &args);
+
+    // Boxes native arguments and unboxes the result as Result, e.g.
+    // call<long long>("fib", 30)
+    template <typename Result, typename... Args>
+    Result call(const std::string &name, Args... args)
+    {
+        Heap::Use use(heap);
+        PyObject *result = call(name, std::vector<PyObject *>{box(args)...});
+        if constexpr (std::is_void_v<Result>)
+            return;
+        else
+            return Unbox<Result>::from(result, name.c_str(), resultPosition);
+    }
+
+    void setGlobal(const std::string &name, PyObject *value);
+    template <typename T>
+    void setGlobal(const std::string &name, T value)
+    {
+        Heap::Use use(heap);
+        setGlobal(name, box(value));
+    }
+    // Throws if `name` is unbound
+    PyObject *global(const std::string &name) const;
+
+    // Host functions
+    template <BuiltinName Name, auto Function>
+    void define()
+    {
+        Heap::Use use(heap);
+        setGlobal(Name.text, bind<Name, Function>());
+    }
+    void define(const std::string &name, size_t minArity, size_t maxArity, PyBuiltin::Function function);
+
+    const Program &program() const { return *compiled; }
+    Profile &profile() { return interpreter.getProfile(); }
+
+private:
+    std::shared_ptr<const Program> compiled;
+    std::vector<std::shared_ptr<const Program>> continued; // By run(next); their functions may be called
+    Heap heap; // Objects the script creates; destroyed with the session
+    Interpreter interpreter;
+};
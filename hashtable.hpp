@@ -0,0 +1,256 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// ==================== HashTable ====================
+// Insertion-ordered open-addressing hash table in the style of a Swiss
+// table. Entries live in a dense vector in insertion order; the probe
+// table stores one control byte and one entry index per slot. Control
+// bytes are grouped sixteen at a time so a single SSE2 compare checks a
+// whole group against the 7-bit hash fragment of the key being looked
+// up, and a full key comparison is made only for candidates.
+//
+// Erasing leaves a tombstone in both arrays; tombstones are dropped the
+// next time the table grows. Pointers to values stay valid until the
+// next insertion.
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+class HashTable
+{
+public:
+    struct Entry
+    {
+        Key first;
+        Value second;
+        size_t hash;
+        bool live;
+    };
+
+    class Iterator
+    {
+    public:
+        Iterator(Entry *entry, Entry *end) : entry(entry), end(end) { skipDead(); }
+        Entry &operator*() const { return *entry; }
+        Entry *operator->() const { return entry; }
+        Iterator &operator++()
+        {
+            ++entry;
+            skipDead();
+            return *this;
+        }
+        bool operator!=(const Iterator &other) const { return entry != other.entry; }
+        bool operator==(const Iterator &other) const { return entry == other.entry; }
+
+    private:
+        void skipDead()
+        {
+            while (entry != end && !entry->live)
+                ++entry;
+        }
+        Entry *entry;
+        Entry *end;
+    };
+
+    HashTable() = default;
+    HashTable(const Hash &hasher, const Equal &equal) : hasher(hasher), equal(equal) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Value stored for `key`, or nullptr
+    Value *find(const Key &key) const
+    {
+        if (count == 0)
+            return nullptr;
+        size_t hash = mix(hasher(key));
+        Entry *entry = lookup(key, hash);
+        return entry ? &entry->second : nullptr;
+    }
+
+    bool contains(const Key &key) const { return find(key) != nullptr; }
+
+    // Inserts or overwrites; returns true if the key was new
+    bool insert(const Key &key, Value value)
+    {
+        size_t hash = mix(hasher(key));
+        if (Entry *entry = count ? lookup(key, hash) : nullptr)
+        {
+            entry->second = std::move(value);
+            return false;
+        }
+        append(key, std::move(value), hash);
+        return true;
+    }
+
+    // Value for `key`, default-constructing it if absent
+    Value &operator[](const Key &key)
+    {
+        size_t hash = mix(hasher(key));
+        if (Entry *entry = count ? lookup(key, hash) : nullptr)
+            return entry->second;
+        return append(key, Value(), hash).second;
+    }
+
+    bool erase(const Key &key)
+    {
+        if (count == 0)
+            return false;
+        size_t hash = mix(hasher(key));
+        size_t slot;
+        if (!lookup(key, hash, &slot))
+            return false;
+        entries[indices[slot]].live = false;
+        entries[indices[slot]].second = Value();
+        control[slot] = deletedSlot;
+        count--;
+        return true;
+    }
+
+    Iterator begin() const { return Iterator(entryData(), entryData() + entries.size()); }
+    Iterator end() const { return Iterator(entryData() + entries.size(), entryData() + entries.size()); }
+
+private:
+    static constexpr int8_t emptySlot = -128; // 0b10000000
+    static constexpr int8_t deletedSlot = -2;  // 0b11111110
+    static constexpr size_t groupWidth = 16;
+
+    // Full control bytes hold the low 7 bits of the hash; empty and
+    // deleted are the only negative values
+    struct Group
+    {
+#ifdef __SSE2__
+        explicit Group(const int8_t *bytes) : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes))) {}
+        uint32_t match(int8_t fragment) const
+        {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(fragment), bytes)));
+        }
+        uint32_t matchEmpty() const { return match(emptySlot); }
+        uint32_t matchFree() const { return static_cast<uint32_t>(_mm_movemask_epi8(bytes)); }
+        __m128i bytes;
+#else
+        explicit Group(const int8_t *bytes) { std::memcpy(this->bytes, bytes, groupWidth); }
+        uint32_t match(int8_t fragment) const
+        {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < groupWidth; ++i)
+                mask |= static_cast<uint32_t>(bytes[i] == fragment) << i;
+            return mask;
+        }
+        uint32_t matchEmpty() const { return match(emptySlot); }
+        uint32_t matchFree() const
+        {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < groupWidth; ++i)
+                mask |= static_cast<uint32_t>(bytes[i] < 0) << i;
+            return mask;
+        }
+        int8_t bytes[groupWidth];
+#endif
+    };
+
+    // Spreads weak hashes (std::hash of an integer is the identity) over
+    // all bits: the low 7 become the control byte, the rest pick a group
+    static size_t mix(size_t hash)
+    {
+        __uint128_t product = static_cast<__uint128_t>(hash) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(product) ^ static_cast<size_t>(product >> 64);
+    }
+    static int8_t fragment(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+    Entry *entryData() const { return const_cast<Entry *>(entries.data()); }
+
+    // Quadratic probing over whole groups; visits every group once
+    // because the group count is a power of two
+    Entry *lookup(const Key &key, size_t hash, size_t *slotOut = nullptr) const
+    {
+        size_t mask = groupCount() - 1;
+        size_t group = (hash >> 7) & mask;
+        int8_t h2 = fragment(hash);
+        for (size_t step = 1;; ++step)
+        {
+            Group bytes(&control[group * groupWidth]);
+            for (uint32_t candidates = bytes.match(h2); candidates; candidates &= candidates - 1)
+            {
+                size_t slot = group * groupWidth + __builtin_ctz(candidates);
+                Entry &entry = entryData()[indices[slot]];
+                if (entry.hash == hash && equal(entry.first, key))
+                {
+                    if (slotOut)
+                        *slotOut = slot;
+                    return &entry;
+                }
+            }
+            if (bytes.matchEmpty())
+                return nullptr;
+            group = (group + step) & mask;
+        }
+    }
+
+    Entry &append(const Key &key, Value value, size_t hash)
+    {
+        if (entries.size() + 1 > capacity() - capacity() / 8)
+            rehash();
+        place(static_cast<uint32_t>(entries.size()), hash);
+        entries.push_back(Entry{key, std::move(value), hash, true});
+        count++;
+        return entries.back();
+    }
+
+    void place(uint32_t index, size_t hash)
+    {
+        size_t mask = groupCount() - 1;
+        size_t group = (hash >> 7) & mask;
+        for (size_t step = 1;; ++step)
+        {
+            uint32_t free = Group(&control[group * groupWidth]).matchFree();
+            if (free)
+            {
+                size_t slot = group * groupWidth + __builtin_ctz(free);
+                control[slot] = fragment(hash);
+                indices[slot] = index;
+                return;
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    // Drops tombstones and resizes so the live entries fill at most half
+    // of the slots
+    void rehash()
+    {
+        if (count != entries.size())
+        {
+            std::vector<Entry> compacted;
+            compacted.reserve(count + 1);
+            for (Entry &entry : entries)
+                if (entry.live)
+                    compacted.push_back(std::move(entry));
+            entries.swap(compacted);
+        }
+
+        size_t slots = groupWidth;
+        while (slots < (count + 1) * 2)
+            slots *= 2;
+        control.assign(slots, emptySlot);
+        indices.assign(slots, 0);
+        for (size_t i = 0; i < entries.size(); ++i)
+            place(static_cast<uint32_t>(i), entries[i].hash);
+    }
+
+    size_t capacity() const { return control.size(); }
+    size_t groupCount() const { return control.size() / groupWidth; }
+
+    std::vector<Entry> entries;   // Insertion order, including tombstones
+    std::vector<int8_t> control;  // One byte per slot, groupWidth-aligned groups
+    std::vector<uint32_t> indices; // Entry index for each full slot
+    size_t count = 0;             // Live entries
+    Hash hasher;
+    Equal equal;
+};
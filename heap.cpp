@@ -0,0 +1,67 @@
+#include "heap.hpp"
+#include "pyobject.hpp"
+#include <new>
+
+// Chunks of finished heaps, kept by the thread for the next heap it
+// fills. A thread running script after script (see batch.hpp) thus
+// touches fresh pages only until its spares cover the largest script.
+namespace
+{
+struct SpareChunks
+{
+    static constexpr size_t limit = 64; // 16 MB per thread
+
+    std::vector<char *> chunks;
+
+    ~SpareChunks()
+    {
+        for (char *chunk : chunks)
+            ::operator delete(chunk, std::align_val_t(Heap::alignment));
+    }
+};
+
+thread_local SpareChunks spares;
+}
+
+Heap::~Heap()
+{
+    for (Header *header = newest; header; header = header->previous)
+        if (!header->abandoned)
+            reinterpret_cast<PyObject *>(header + 1)->~PyObject();
+
+    for (char *chunk : chunks)
+    {
+        if (spares.chunks.size() < SpareChunks::limit)
+            spares.chunks.push_back(chunk);
+        else
+            ::operator delete(chunk, std::align_val_t(alignment));
+    }
+    for (char *chunk : largeChunks)
+        ::operator delete(chunk, std::align_val_t(alignment));
+}
+
+// Starts a new chunk; an allocation larger than a chunk gets one of its
+// own and leaves the current chunk in use
+void *Heap::refill(size_t size)
+{
+    if (size > chunkSize)
+    {
+        char *chunk = static_cast<char *>(::operator new(size, std::align_val_t(alignment)));
+        largeChunks.push_back(chunk);
+        reservedBytes += size;
+        return chunk;
+    }
+    char *chunk;
+    if (!spares.chunks.empty())
+    {
+        chunk = spares.chunks.back();
+        spares.chunks.pop_back();
+    }
+    else
+        chunk = static_cast<char *>(::operator new(chunkSize, std::align_val_t(alignment)));
+    chunks.push_back(chunk);
+    reservedBytes += chunkSize;
+    next = chunk + size;
+    limit = chunk + chunkSize;
+    return chunk;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// ==================== Object Heap ====================
+// Bump allocator for the objects one interpreter session creates. Objects
+// are never freed one at a time (see pyobject.hpp), so allocating one is
+// a pointer bump in the current chunk: no lock and no sharing with other
+// threads. A small header chains each object to the one allocated
+// before it. When the Heap is destroyed it walks that chain, newest
+// first, running every object's destructor, which releases what the
+// object owns outside the heap (list and string storage, hash tables).
+// Numbers, which own nothing there, skip the header and the destructor
+// (see allocatePlain). The chunks then go back at once, kept (up to a limit)
+// for the next heap the same thread fills. PyObject's operator new takes
+// memory from the heap the calling thread made current with Heap::Use,
+// or from the global allocator when there is none.
+class Heap
+{
+public:
+    static constexpr size_t chunkSize = 256 * 1024;
+    static constexpr size_t alignment = alignof(std::max_align_t);
+
+    Heap() = default;
+    ~Heap();
+    Heap(const Heap &) = delete;
+    Heap &operator=(const Heap &) = delete;
+
+    // Memory for an object the Heap never destroys: one that owns nothing
+    // outside the heap
+    void *allocatePlain(size_t size)
+    {
+        size = (size + alignment - 1) & ~(alignment - 1);
+        if (size > static_cast<size_t>(limit - next))
+            return refill(size);
+        void *memory = next;
+        next += size;
+        return memory;
+    }
+
+    // Memory for a PyObject of `size` bytes, which the Heap destroys with
+    // itself unless abandon() is called on it first
+    void *allocate(size_t size)
+    {
+        auto header = static_cast<Header *>(allocatePlain(sizeof(Header) + size));
+        header->previous = newest;
+        header->abandoned = false;
+        newest = header;
+        return header + 1;
+    }
+
+    // Leaves the object at `memory` undestroyed: its constructor threw
+    static void abandon(void *memory) { (static_cast<Header *>(memory) - 1)->abandoned = true; }
+
+    // Keeps `resource` alive until the Heap is destroyed, for plain
+    // objects that point outside the heap
+    void keep(std::shared_ptr<const void> resource) { kept.push_back(std::move(resource)); }
+
+    // Bytes reserved from the system, including unused chunk tails
+    size_t reserved() const { return reservedBytes; }
+
+    static Heap *current() { return active; }
+
+    // Makes `heap` the calling thread's current heap for its lifetime; a
+    // null heap means the global allocator, for objects that outlive
+    // every session
+    class Use
+    {
+    public:
+        explicit Use(Heap &heap) : Use(&heap) {}
+        explicit Use(Heap *heap) : previous(active) { active = heap; }
+        ~Use() { active = previous; }
+        Use(const Use &) = delete;
+        Use &operator=(const Use &) = delete;
+
+    private:
+        Heap *previous;
+    };
+
+private:
+    // Padded to the alignment, so objects after it stay aligned
+    struct alignas(alignment) Header
+    {
+        Header *previous;
+        bool abandoned;
+    };
+
+    void *refill(size_t size);
+
+    static inline thread_local Heap *active = nullptr;
+    std::vector<char *> chunks;      // chunkSize each
+    std::vector<char *> largeChunks; // One allocation each
+    char *next = nullptr;
+    char *limit = nullptr;
+    Header *newest = nullptr; // Chain of every object allocate() returned
+    std::vector<std::shared_ptr<const void>> kept;
+    size_t reservedBytes = 0;
+};
@@ -1,656 +1,4373 @@
 #include "interpreter.hpp"
-#include <iostream>
 #include <cmath>
+#include <climits>
+#include <charconv>
+#include <chrono>
 #include "pyobject.hpp"
+#include "simd.hpp"
+#include "output.hpp"
+#include "binding.hpp"
+#include "optimizer.hpp"
+#include "workpool.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
 
-Interpreter::Interpreter()
-{
-    globalScope = std::make_unique<Scope>();
-    currentScope = globalScope.get();
-}
-
-void Interpreter::interpret(ProgramNode *program)
-{
-    program->accept(this);
-}
-
-PyObject *Interpreter::visitProgramNode(ProgramNode *node)
-{
-    for (AstNode *stmt : node->statements)
-    {
-        stmt->accept(this);
-    }
-    return new PyNone();
-}
+// ==================== Integer Arithmetic ====================
+// Ints are exact at any size. Operations run on int64 with overflow
+// checks and only fall back to BigInt when the result does not fit.
 
-PyObject *Interpreter::visitBlockNode(BlockNode *node)
+static bool intPower(long long base, long long exponent, long long &out)
 {
-    for (AstNode *stmt : node->statements)
+    long long result = 1;
+    while (exponent > 0)
     {
-        stmt->accept(this);
+        if ((exponent & 1) && __builtin_mul_overflow(result, base, &result))
+            return false;
+        exponent >>= 1;
+        if (exponent > 0 && __builtin_mul_overflow(base, base, &base))
+            return false;
     }
-    return new PyNone();
-}
-
-PyObject *Interpreter::visitPrintNode(PrintNode *node)
-{
-    PyObject *value = node->expression->accept(this);
-    std::cout << value->toString() << std::endl;
-    return new PyNone();
-}
-
-PyObject *Interpreter::visitPassNode(PassNode *)
-{
-    return nullptr;
+    out = result;
+    return true;
 }
 
-PyObject *Interpreter::visitBreakNode(BreakNode *)
+static bool isComparisonOp(TokenType op)
 {
-    throw BreakException();
+    return op == TokenType::EqualEqual || op == TokenType::BangEqual ||
+           op == TokenType::Less || op == TokenType::LessEqual ||
+           op == TokenType::Greater || op == TokenType::GreaterEqual;
 }
 
-PyObject *Interpreter::visitContinueNode(ContinueNode *)
+static bool isArithmeticOp(TokenType op)
 {
-    throw ContinueException();
+    return op == TokenType::Plus || op == TokenType::Minus || op == TokenType::Star ||
+           op == TokenType::Slash || op == TokenType::DoubleSlash || op == TokenType::Mod ||
+           op == TokenType::DoubleStar;
 }
 
-PyObject *Interpreter::visitReturnNode(ReturnNode *node)
+static bool isBitwiseOp(TokenType op)
 {
-    std::shared_ptr<PyObject> value = node->value
-                                          ? std::shared_ptr<PyObject>(node->value->accept(this))
-                                          : std::make_shared<PyNone>();
-    throw ReturnException(value);
+    return op == TokenType::Ampersand || op == TokenType::Pipe || op == TokenType::Caret ||
+           op == TokenType::LeftShift || op == TokenType::RightShift;
 }
 
-PyObject *Interpreter::visitIfNode(IfNode *node)
+// int64 kernel for every arithmetic and bitwise operator except `/`;
+// returns false if the exact result needs a BigInt
+static bool intArithmetic(TokenType op, long long a, long long b, long long &result)
 {
-    if (node->condition->accept(this)->isTruthy())
-    {
-        node->thenBranch->accept(this);
-        return new PyNone();
-    }
-    for (auto &elifPair : node->elifBranches)
+    switch (op)
     {
-        if (elifPair.first->accept(this)->isTruthy())
+    case TokenType::Plus:
+        return !__builtin_add_overflow(a, b, &result);
+    case TokenType::Minus:
+        return !__builtin_sub_overflow(a, b, &result);
+    case TokenType::Star:
+        return !__builtin_mul_overflow(a, b, &result);
+    case TokenType::DoubleSlash:
+        if (b == 0)
+            throw std::runtime_error("Integer division or modulo by zero");
+        if (a == LLONG_MIN && b == -1)
+            return false;
+        result = a / b;
+        if (a % b != 0 && ((a < 0) != (b < 0)))
+            result--;
+        return true;
+    case TokenType::Mod:
+        if (b == 0)
+            throw std::runtime_error("Integer division or modulo by zero");
+        if (b == -1)
         {
-            elifPair.second->accept(this);
-            return new PyNone();
+            result = 0;
+            return true;
+        }
+        result = a % b;
+        if (result != 0 && ((result < 0) != (b < 0)))
+            result += b;
+        return true;
+    case TokenType::DoubleStar:
+        return b >= 0 && intPower(a, b, result);
+    case TokenType::Ampersand:
+        result = a & b;
+        return true;
+    case TokenType::Pipe:
+        result = a | b;
+        return true;
+    case TokenType::Caret:
+        result = a ^ b;
+        return true;
+    case TokenType::LeftShift:
+        if (b < 0)
+            throw std::runtime_error("Negative shift count");
+        if (a == 0)
+        {
+            result = 0;
+            return true;
         }
+        if (b >= 63)
+            return false;
+        result = a << b;
+        return (result >> b) == a;
+    case TokenType::RightShift:
+        if (b < 0)
+            throw std::runtime_error("Negative shift count");
+        result = b >= 63 ? (a < 0 ? -1 : 0) : a >> b;
+        return true;
+    default:
+        return false;
     }
-    if (node->elseBranch)
-        node->elseBranch->accept(this);
-    return new PyNone();
 }
 
-PyObject *Interpreter::visitWhileNode(WhileNode *node)
+// Arbitrary-precision kernel: comparisons give a PyBool, `/` and `**` with
+// a negative exponent a PyFloat, and everything else a PyInt
+static PyObject *bigArithmetic(TokenType op, const BigInt &a, const BigInt &b)
 {
-    while (node->condition->accept(this)->isTruthy())
+    switch (op)
     {
-        try
+    case TokenType::Plus:
+        return new PyInt(a + b);
+    case TokenType::Minus:
+        return new PyInt(a - b);
+    case TokenType::Star:
+        return new PyInt(a * b);
+    case TokenType::Slash:
+        return new PyFloat(a.toDouble() / b.toDouble());
+    case TokenType::DoubleSlash:
+    {
+        BigInt quotient;
+        BigInt::divmod(a, b, &quotient, nullptr);
+        return new PyInt(quotient);
+    }
+    case TokenType::Mod:
+    {
+        BigInt remainder;
+        BigInt::divmod(a, b, nullptr, &remainder);
+        return new PyInt(remainder);
+    }
+    case TokenType::DoubleStar:
+    {
+        if (b.isNegative())
         {
-            node->body->accept(this);
+            // A negative exponent makes the result a float, as in
+            // float(a) ** float(b)
+            if (a.isZero())
+                throw std::runtime_error("0.0 cannot be raised to a negative power");
+            double base = a.toDouble();
+            if (std::isinf(base))
+                throw std::runtime_error("int too large to convert to float");
+            return new PyFloat(std::pow(base, b.toDouble()));
         }
-        catch (const BreakException &)
+        // 0, 1 and -1 have exact powers however large the exponent
+        if (a.isZero())
+            return new PyInt(b.isZero() ? 1LL : 0LL);
+        if (a.fitsInt64() && (a.toInt64() == 1 || a.toInt64() == -1))
         {
-            break;
+            bool odd = !(b & BigInt(1LL)).isZero();
+            return new PyInt(a.toInt64() == -1 && odd ? -1LL : 1LL);
         }
-        catch (const ContinueException &)
+        if (!b.fitsInt64())
+            throw std::runtime_error("Exponent too large");
+        return new PyInt(BigInt::pow(a, static_cast<unsigned long long>(b.toInt64())));
+    }
+    case TokenType::Ampersand:
+        return new PyInt(a & b);
+    case TokenType::Pipe:
+        return new PyInt(a | b);
+    case TokenType::Caret:
+        return new PyInt(a ^ b);
+    case TokenType::LeftShift:
+    case TokenType::RightShift:
+    {
+        if (b.isNegative())
+            throw std::runtime_error("Negative shift count");
+        if (!b.fitsInt64())
         {
-            continue;
+            if (op == TokenType::RightShift)
+                return new PyInt(a.isNegative() ? -1 : 0);
+            throw std::runtime_error("Shift count too large");
         }
+        unsigned long long bits = static_cast<unsigned long long>(b.toInt64());
+        return new PyInt(op == TokenType::LeftShift ? a.shiftLeft(bits) : a.shiftRight(bits));
+    }
+    default:
+        return new PyBool(Interpreter::compare(op, BigInt::compare(a, b), 0));
     }
-    return new PyNone();
 }
 
-PyObject *Interpreter::visitFunctionNode(FunctionNode *node)
+static bool isIntegral(PyObject *obj)
 {
-    std::shared_ptr<AstNode> bodyPtr(node->body, [](AstNode *) {});
-    std::shared_ptr<Scope> closurePtr(currentScope, [](Scope *) {});
-
-    PyFunction *func = new PyFunction(node->name, node->params, bodyPtr, closurePtr);
-    currentScope->define(node->name, func);
-    return func;
+    return obj->kind == ObjectKind::Int || obj->kind == ObjectKind::Bool;
 }
 
-PyObject *Interpreter::visitCallNode(CallNode *node)
+// Python's name for the type of obj, for error messages
+static std::string typeName(PyObject *obj)
 {
-    // Check if we're calling a method on an instance
-    PyObject *instance = nullptr;
-    if (auto propNode = dynamic_cast<PropertyNode *>(node->callee))
+    switch (obj->kind)
     {
-        // This is a method call like obj.method()
-        instance = propNode->object->accept(this);
+    case ObjectKind::None:
+        return "NoneType";
+    case ObjectKind::Bool:
+        return "bool";
+    case ObjectKind::Int:
+        return "int";
+    case ObjectKind::Float:
+        return "float";
+    case ObjectKind::Str:
+        return "str";
+    case ObjectKind::Function:
+        return "function";
+    case ObjectKind::Class:
+        return "type";
+    case ObjectKind::Instance:
+        return static_cast<PyInstance *>(obj)->klass->name;
+    case ObjectKind::Builtin:
+        return "builtin_function_or_method";
+    case ObjectKind::List:
+        return "list";
+    case ObjectKind::Tuple:
+        return "tuple";
+    case ObjectKind::Dict:
+        return "dict";
+    case ObjectKind::Range:
+        return "range";
+    case ObjectKind::Array:
+        return "array";
+    case ObjectKind::Module:
+        return "module";
     }
+    return "object";
+}
 
-    PyObject *callee = node->callee->accept(this);
-    std::vector<PyObject *> args;
-    args.reserve(node->args.size());
-    for (AstNode *arg : node->args)
-        args.push_back(arg->accept(this));
-
-    if (auto func = dynamic_cast<PyFunction *>(callee))
-    {
-        Scope *previous = currentScope;
-        Scope *newCallScope = new Scope(func->closure.get());
-        currentScope = newCallScope;
+static const BigInt *bigPart(PyObject *obj)
+{
+    return obj->kind == ObjectKind::Int ? static_cast<PyInt *>(obj)->big : nullptr;
+}
 
-        size_t paramCount = func->params.size();
-        for (size_t i = 0; i < paramCount; ++i)
-        {
-            PyObject *value = nullptr;
-            if (i == 0 && instance != nullptr)
-            {
-                // This is a method call, pass the instance as self
-                value = instance;
-            }
-            else if (instance != nullptr)
-            {
-                // Adjust index since we already used the first parameter for self
-                value = (i - 1 < args.size()) ? args[i - 1] : new PyNone();
-            }
-            else
-            {
-                // Regular function call
-                value = (i < args.size()) ? args[i] : new PyNone();
-            }
-            currentScope->define(func->params[i], value);
-        }
+static long long smallPart(PyObject *obj)
+{
+    if (obj->kind == ObjectKind::Bool)
+        return static_cast<PyBool *>(obj)->value ? 1 : 0;
+    return static_cast<PyInt *>(obj)->value;
+}
 
-        PyObject *result = new PyNone();
-        try
-        {
-            func->body->accept(this);
-        }
-        catch (const ReturnException &ex)
-        {
-            // Keep the return value alive by storing it in lastReturnValue
-            lastReturnValue = ex.value;
-            result = ex.value.get();
-        }
+static BigInt toBig(PyObject *obj)
+{
+    const BigInt *big = bigPart(obj);
+    return big ? *big : BigInt(smallPart(obj));
+}
 
-        currentScope = previous;
-        delete newCallScope;
-        return result;
+// `left op right` for int or bool operands and an arithmetic, bitwise or
+// comparison operator
+static PyObject *integerBinaryOp(TokenType op, PyObject *left, PyObject *right)
+{
+    // &, | and ^ keep two bools a bool
+    if (left->kind == ObjectKind::Bool && right->kind == ObjectKind::Bool &&
+        (op == TokenType::Ampersand || op == TokenType::Pipe || op == TokenType::Caret))
+    {
+        bool a = static_cast<PyBool *>(left)->value;
+        bool b = static_cast<PyBool *>(right)->value;
+        return new PyBool(op == TokenType::Ampersand ? a && b : op == TokenType::Pipe ? a || b : a != b);
     }
 
-    if (auto klass = dynamic_cast<PyClass *>(callee))
+    if (!bigPart(left) && !bigPart(right))
     {
-        // Create shared_ptr to the class (non-owning)
-        std::shared_ptr<PyClass> klassPtr(klass, [](PyClass *) {});
-        PyInstance *instance = new PyInstance(klassPtr);
-        
-        std::shared_ptr<PyObject> initObj;
-        try
-        {
-            initObj = klass->get("__init__");
-        }
-        catch (const std::runtime_error &)
-        {
-            initObj = nullptr;
-        }
-
-        if (initObj)
-        {
-            if (auto initFn = dynamic_cast<PyFunction *>(initObj.get()))
-            {
-                Scope *previous = currentScope;
-                Scope *newCallScope = new Scope(initFn->closure.get());
-                currentScope = newCallScope;
-
-                size_t paramCount = initFn->params.size();
-                for (size_t i = 0; i < paramCount; ++i)
-                {
-                    PyObject *value = nullptr;
-                    if (i == 0)
-                        value = instance;
-                    else
-                        value = (i - 1 < args.size()) ? args[i - 1] : new PyNone();
-                    currentScope->define(initFn->params[i], value);
-                }
-
-                try
-                {
-                    initFn->body->accept(this);
-                }
-                catch (const ReturnException &)
-                {
-                }
-                currentScope = previous;
-                delete newCallScope;
-            }
-        }
-        return instance;
+        long long a = smallPart(left);
+        long long b = smallPart(right);
+        if (isComparisonOp(op))
+            return new PyBool(Interpreter::compare(op, a, b));
+        if (op == TokenType::Slash)
+            return new PyFloat(static_cast<double>(a) / static_cast<double>(b));
+        long long result;
+        if (intArithmetic(op, a, b, result))
+            return new PyInt(result);
     }
-
-    return new PyNone();
+    return bigArithmetic(op, toBig(left), toBig(right));
 }
 
-PyObject *Interpreter::visitPropertyNode(PropertyNode *node)
+// Thrown by evalInt() when a value leaves the int64 range. The nearest
+// enclosing operation finishes its computation on boxed values, and the
+// boxing point returns the big value itself.
+struct BigIntEscape
 {
-    PyObject *obj = node->object->accept(this);
-    
-    if (auto instance = dynamic_cast<PyInstance *>(obj))
-    {
-        std::shared_ptr<PyObject> value = instance->get(node->property);
-        
-        // If it's a method (PyFunction), we need to bind self to it
-        // For now, we'll just return the function and handle binding in CallNode
-        // This is a simplified approach
-        
-        return value ? value.get() : static_cast<PyObject *>(new PyNone());
-    }
-    
-    if (auto klass = dynamic_cast<PyClass *>(obj))
-    {
-        std::shared_ptr<PyObject> value = klass->get(node->property);
-        return value ? value.get() : static_cast<PyObject *>(new PyNone());
-    }
-    
-    return new PyNone();
+    PyInt *value;
+};
+
+static long long smallInt(PyObject *obj)
+{
+    auto value = static_cast<PyInt *>(obj);
+    if (value->big)
+        throw BigIntEscape{value};
+    return value->value;
 }
 
-PyObject *Interpreter::visitClassNode(ClassNode *node)
+// ==================== Builtins ====================
+static PyInt *intArgument(const char *function, PyObject *arg)
 {
-    Scope *previous = currentScope;
-    Scope *classScope = new Scope(previous);
-    currentScope = classScope;
+    if (arg->kind == ObjectKind::Int)
+        return static_cast<PyInt *>(arg);
+    if (arg->kind == ObjectKind::Bool)
+        return new PyInt(static_cast<PyBool *>(arg)->value ? 1 : 0);
+    throw std::runtime_error(std::string(function) + "() argument must be an int");
+}
 
-    node->body->accept(this);
+static unsigned long long magnitude(long long value)
+{
+    return value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+}
 
-    currentScope = previous;
+// Number of one bits in |x|, like int.bit_count()
+static PyObject *builtinPopcount(const std::vector<PyObject *> &args)
+{
+    PyInt *x = intArgument("popcount", args[0]);
+    if (x->big)
+        return new PyInt(static_cast<long long>(x->big->popcount()));
+    return new PyInt(__builtin_popcountll(magnitude(x->value)));
+}
 
-    PyClass *klass = new PyClass(node->name);
+// Bits needed to represent |x|, like int.bit_length()
+static PyObject *builtinBitLength(const std::vector<PyObject *> &args)
+{
+    PyInt *x = intArgument("bit_length", args[0]);
+    if (x->big)
+        return new PyInt(static_cast<long long>(x->big->bitLength()));
+    unsigned long long bits = magnitude(x->value);
+    return new PyInt(bits ? 64 - __builtin_clzll(bits) : 0);
+}
 
-    // Get variables from class scope
-    for (const auto &pair : classScope->getVariables())
+static PyObject *builtinLen(const std::vector<PyObject *> &args)
+{
+    switch (args[0]->kind)
     {
-        // pair.second is std::shared_ptr<PyObject>
-        if (auto func = dynamic_cast<PyFunction *>(pair.second.get()))
-        {
-            klass->set(pair.first, pair.second);
-        }
-        else
-        {
-            klass->set(pair.first, pair.second);
-        }
+    case ObjectKind::List:
+        return new PyInt(static_cast<long long>(static_cast<PyList *>(args[0])->items.size()));
+    case ObjectKind::Str:
+        return new PyInt(static_cast<long long>(static_cast<PyStr *>(args[0])->size()));
+    case ObjectKind::Tuple:
+        return new PyInt(static_cast<long long>(static_cast<PyTuple *>(args[0])->size()));
+    case ObjectKind::Array:
+        return new PyInt(static_cast<long long>(static_cast<PyArray *>(args[0])->size()));
+    case ObjectKind::Dict:
+        return new PyInt(static_cast<long long>(static_cast<PyDict *>(args[0])->items.size()));
+    case ObjectKind::Range:
+    {
+        unsigned long long length = static_cast<PyRange *>(args[0])->length();
+        if (length > LLONG_MAX)
+            throw std::runtime_error("Range too large for len()");
+        return new PyInt(static_cast<long long>(length));
+    }
+    default:
+        throw std::runtime_error("Object of this type has no len()");
     }
+}
 
-    currentScope->define(node->name, klass);
-    delete classScope;
+static void checkArity(PyBuiltin *builtin, size_t count)
+{
+    if (count >= builtin->minArity && count <= builtin->maxArity)
+        return;
+    std::string expected = std::to_string(builtin->minArity);
+    if (builtin->maxArity == SIZE_MAX)
+        expected = "at least " + expected;
+    else if (builtin->maxArity != builtin->minArity)
+        expected += " to " + std::to_string(builtin->maxArity);
+    throw std::runtime_error(builtin->name + "() takes " + expected + " argument(s) (" +
+                             std::to_string(count) + " given)");
+}
 
-    return klass;
+static long long rangeArgument(PyObject *arg)
+{
+    if (arg->kind == ObjectKind::Bool)
+        return static_cast<PyBool *>(arg)->value ? 1 : 0;
+    if (arg->kind != ObjectKind::Int)
+        throw std::runtime_error("range() arguments must be integers");
+    auto value = static_cast<PyInt *>(arg);
+    if (value->big)
+        throw std::runtime_error("range() arguments must fit in 64 bits");
+    return value->value;
 }
 
-PyObject *Interpreter::visitIntNode(IntNode *node)
+// range(stop), range(start, stop) or range(start, stop, step)
+static PyRange rangeFromArguments(const long long *values, size_t count)
 {
-    return new PyInt(std::stoll(node->value.lexeme));
+    if (count == 1)
+        return PyRange(0, values[0], 1);
+    if (count == 3 && values[2] == 0)
+        throw std::runtime_error("range() step must not be zero");
+    return PyRange(values[0], values[1], count == 3 ? values[2] : 1);
 }
 
-PyObject *Interpreter::visitFloatNode(FloatNode *node)
+static PyObject *builtinRange(const std::vector<PyObject *> &args)
 {
-    return new PyFloat(std::stod(node->value.lexeme));
+    long long values[3];
+    for (size_t i = 0; i < args.size(); ++i)
+        values[i] = rangeArgument(args[i]);
+    return new PyRange(rangeFromArguments(values, args.size()));
 }
 
-PyObject *Interpreter::visitStringNode(StringNode *node)
+// ==================== Conversions ====================
+// abs(), int(), float() and str() follow Python for numbers and strings.
+// Strings may have surrounding whitespace and '_' separators; int()
+// reads decimal digits only.
+
+static bool isNumber(PyObject *value)
 {
-    return new PyStr(node->value.lexeme);
+    return value->kind == ObjectKind::Int || value->kind == ObjectKind::Float || value->kind == ObjectKind::Bool;
 }
 
-PyObject *Interpreter::visitBooleanNode(BooleanNode *node)
+static std::string_view trimmed(std::string_view text)
 {
-    return new PyBool(node->value.type == TokenType::True);
+    while (!text.empty() && isSpaceByte(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && isSpaceByte(text.back()))
+        text.remove_suffix(1);
+    return text;
 }
 
-PyObject *Interpreter::visitNullNode(NullNode *)
+static PyObject *builtinAbs(const std::vector<PyObject *> &args)
 {
-    return new PyNone();
+    switch (args[0]->kind)
+    {
+    case ObjectKind::Int:
+    {
+        auto x = static_cast<PyInt *>(args[0]);
+        if (x->big)
+            return x->big->isNegative() ? new PyInt(-*x->big) : x;
+        if (x->value == LLONG_MIN)
+            return new PyInt(-BigInt(x->value));
+        return x->value < 0 ? new PyInt(-x->value) : x;
+    }
+    case ObjectKind::Bool:
+        return new PyInt(static_cast<PyBool *>(args[0])->value ? 1 : 0);
+    case ObjectKind::Float:
+        return new PyFloat(std::fabs(static_cast<PyFloat *>(args[0])->value));
+    default:
+        throw std::runtime_error("bad operand type for abs()");
+    }
 }
 
-PyObject *Interpreter::visitNameNode(NameNode *node)
+// The integer part of a finite double, exact at any size
+static PyInt *truncateFloat(double value)
 {
-    return currentScope->get(node->name.lexeme);
+    if (std::isnan(value))
+        throw std::runtime_error("cannot convert float NaN to integer");
+    if (std::isinf(value))
+        throw std::runtime_error("cannot convert float infinity to integer");
+    value = std::trunc(value);
+    if (std::fabs(value) < 0x1p63)
+        return new PyInt(static_cast<long long>(value));
+    // value == mantissa * 2^(exponent - 53) with a 53-bit mantissa
+    int exponent;
+    double fraction = std::frexp(value, &exponent);
+    auto mantissa = static_cast<long long>(std::ldexp(fraction, 53));
+    return new PyInt(BigInt(mantissa).shiftLeft(static_cast<unsigned long long>(exponent - 53)));
 }
 
-PyObject *Interpreter::visitBinaryOpNode(BinaryOpNode *node)
+static PyObject *builtinInt(const std::vector<PyObject *> &args)
 {
-    PyObject *left = node->left->accept(this);
+    if (args.empty())
+        return new PyInt(0);
+    switch (args[0]->kind)
+    {
+    case ObjectKind::Int:
+        return args[0];
+    case ObjectKind::Bool:
+        return new PyInt(static_cast<PyBool *>(args[0])->value ? 1 : 0);
+    case ObjectKind::Float:
+        return truncateFloat(static_cast<PyFloat *>(args[0])->value);
+    case ObjectKind::Str:
+    {
+        std::string_view text = trimmed(static_cast<PyStr *>(args[0])->view());
+        long long value;
+        ParseResult result = parseInt(text, value);
+        if (result == ParseResult::Ok)
+            return new PyInt(value);
+        std::string digits;
+        if (result == ParseResult::Invalid || !stripSeparators(text, digits))
+            throw std::runtime_error("invalid literal for int() with base 10: " + args[0]->repr());
+        return new PyInt(BigInt::fromString(digits));
+    }
+    default:
+        throw std::runtime_error("int() argument must be a string or a number");
+    }
+}
 
-    auto getNumeric = [](PyObject *obj, double &out, bool &isInt) -> bool
+static PyObject *builtinFloat(const std::vector<PyObject *> &args)
+{
+    if (args.empty())
+        return new PyFloat(0.0);
+    switch (args[0]->kind)
     {
-        if (auto v = dynamic_cast<PyInt *>(obj))
-        {
-            out = static_cast<double>(v->value);
-            isInt = true;
-            return true;
-        }
-        if (auto v = dynamic_cast<PyFloat *>(obj))
-        {
-            out = v->value;
-            isInt = false;
-            return true;
-        }
-        if (auto v = dynamic_cast<PyBool *>(obj))
+    case ObjectKind::Float:
+        return args[0];
+    case ObjectKind::Int:
+    {
+        double value = static_cast<PyInt *>(args[0])->toDouble();
+        if (std::isinf(value))
+            throw std::runtime_error("int too large to convert to float");
+        return new PyFloat(value);
+    }
+    case ObjectKind::Bool:
+        return new PyFloat(static_cast<PyBool *>(args[0])->value ? 1.0 : 0.0);
+    case ObjectKind::Str:
+    {
+        double value;
+        if (parseFloat(trimmed(static_cast<PyStr *>(args[0])->view()), value) != ParseResult::Ok)
+            throw std::runtime_error("could not convert string to float: " + args[0]->repr());
+        return new PyFloat(value);
+    }
+    default:
+        throw std::runtime_error("float() argument must be a string or a number");
+    }
+}
+
+static PyObject *builtinStr(const std::vector<PyObject *> &args)
+{
+    if (args.empty())
+        return new PyStr("");
+    if (args[0]->kind == ObjectKind::Str)
+        return args[0];
+    return new PyStr(args[0]->toString());
+}
+
+// ==================== Typed Arrays ====================
+// Builtins over PyArray run in the kernels from simd.hpp; only their
+// arguments and results are boxed.
+
+static PyArray *arrayArgument(const char *function, PyObject *arg)
+{
+    if (arg->kind != ObjectKind::Array)
+        throw std::runtime_error(std::string(function) + "() argument must be an array");
+    return static_cast<PyArray *>(arg);
+}
+
+static double floatElement(PyObject *value)
+{
+    switch (value->kind)
+    {
+    case ObjectKind::Float:
+        return static_cast<PyFloat *>(value)->value;
+    case ObjectKind::Int:
+        return static_cast<PyInt *>(value)->toDouble();
+    case ObjectKind::Bool:
+        return static_cast<PyBool *>(value)->value ? 1.0 : 0.0;
+    default:
+        throw std::runtime_error("array('d') items must be numbers");
+    }
+}
+
+static long long intElement(PyObject *value)
+{
+    if (value->kind == ObjectKind::Bool)
+        return static_cast<PyBool *>(value)->value ? 1 : 0;
+    if (value->kind != ObjectKind::Int)
+        throw std::runtime_error("array('q') items must be integers");
+    auto number = static_cast<PyInt *>(value);
+    if (number->big)
+        throw std::runtime_error("Integer too large for array('q')");
+    return number->value;
+}
+
+static void storeElement(PyArray *array, size_t i, PyObject *value)
+{
+    if (array->isFloat())
+        array->floats[i] = floatElement(value);
+    else
+        array->ints[i] = intElement(value);
+}
+
+static PyObject *loadElement(PyArray *array, size_t i)
+{
+    if (array->isFloat())
+        return new PyFloat(array->floats[i]);
+    return new PyInt(array->ints[i]);
+}
+
+static PyInt *intFrom128(__int128 value)
+{
+    if (value >= LLONG_MIN && value <= LLONG_MAX)
+        return new PyInt(static_cast<long long>(value));
+    auto low = static_cast<unsigned long long>(value);
+    return new PyInt(BigInt(static_cast<long long>(value >> 64)).shiftLeft(64) +
+                     BigInt(static_cast<long long>(low >> 32)).shiftLeft(32) +
+                     BigInt(static_cast<long long>(low & 0xFFFFFFFF)));
+}
+
+static PyArray *arrayFromItems(char typecode, PyObject *const *items, size_t count)
+{
+    PyArray *array = new PyArray(typecode, count);
+    for (size_t i = 0; i < count; ++i)
+        storeElement(array, i, items[i]);
+    return array;
+}
+
+// array(typecode[, init]) with typecode 'd' (double) or 'q' (int64);
+// init is a length to zero-fill or a list, tuple, range or array
+static PyObject *builtinArray(const std::vector<PyObject *> &args)
+{
+    if (args[0]->kind != ObjectKind::Str || (static_cast<PyStr *>(args[0])->view() != "d" &&
+                                             static_cast<PyStr *>(args[0])->view() != "q"))
+        throw std::runtime_error("array() typecode must be 'd' or 'q'");
+    char typecode = static_cast<PyStr *>(args[0])->view()[0];
+    if (args.size() == 1)
+        return new PyArray(typecode, 0);
+
+    PyObject *init = args[1];
+    switch (init->kind)
+    {
+    case ObjectKind::Int:
+    case ObjectKind::Bool:
+    {
+        long long size = intElement(init);
+        if (size < 0)
+            throw std::runtime_error("array() size must not be negative");
+        return new PyArray(typecode, static_cast<size_t>(size));
+    }
+    case ObjectKind::List:
+    {
+        const auto &items = static_cast<PyList *>(init)->items;
+        return arrayFromItems(typecode, items.data(), items.size());
+    }
+    case ObjectKind::Tuple:
+        return arrayFromItems(typecode, static_cast<PyTuple *>(init)->begin(), static_cast<PyTuple *>(init)->size());
+    case ObjectKind::Range:
+    {
+        auto range = static_cast<PyRange *>(init);
+        PyArray *array = new PyArray(typecode, range->length());
+        for (size_t i = 0; i < array->size(); ++i)
         {
-            out = v->value ? 1.0 : 0.0;
-            isInt = true;
-            return true;
+            if (array->isFloat())
+                array->floats[i] = static_cast<double>(range->at(i));
+            else
+                array->ints[i] = range->at(i);
         }
-        return false;
-    };
+        return array;
+    }
+    case ObjectKind::Array:
+    {
+        auto source = static_cast<PyArray *>(init);
+        PyArray *array = new PyArray(typecode, source->size());
+        for (size_t i = 0; i < array->size(); ++i)
+            storeElement(array, i, loadElement(source, i));
+        return array;
+    }
+    default:
+        throw std::runtime_error("array() initializer must be a size or a sequence");
+    }
+}
 
-    // Handle logical operators first (short-circuit)
-    switch (node->op.type)
+static PyObject *builtinSum(const std::vector<PyObject *> &args)
+{
+    PyArray *array = arrayArgument("sum", args[0]);
+    if (array->isFloat())
+        return new PyFloat(arrayKernels().sumFloat(array->floats.data(), array->size()));
+    return intFrom128(arrayKernels().sumInt(array->ints.data(), array->size()));
+}
+
+static PyObject *arrayExtreme(const char *function, PyObject *arg, bool maximum)
+{
+    PyArray *array = arrayArgument(function, arg);
+    if (array->size() == 0)
+        throw std::runtime_error(std::string(function) + "() arg is an empty array");
+    const ArrayKernels &kernels = arrayKernels();
+    if (array->isFloat())
+        return new PyFloat((maximum ? kernels.maxFloat : kernels.minFloat)(array->floats.data(), array->size()));
+    return new PyInt((maximum ? kernels.maxInt : kernels.minInt)(array->ints.data(), array->size()));
+}
+
+// Ints compare exactly, mixed numbers as doubles and strings bytewise
+static bool lessThan(const char *function, PyObject *a, PyObject *b)
+{
+    if (a->kind == ObjectKind::Int && b->kind == ObjectKind::Int)
     {
-    case TokenType::And:
+        auto x = static_cast<PyInt *>(a);
+        auto y = static_cast<PyInt *>(b);
+        if (!x->big && !y->big)
+            return x->value < y->value;
+        return BigInt::compare(x->toBig(), y->toBig()) < 0;
+    }
+    if (isNumber(a) && isNumber(b))
+        return Unbox<double>::from(a, function, 0) < Unbox<double>::from(b, function, 1);
+    if (a->kind == ObjectKind::Str && b->kind == ObjectKind::Str)
+        return static_cast<PyStr *>(a)->view() < static_cast<PyStr *>(b)->view();
+    throw std::runtime_error(std::string(function) + "() arguments must be numbers or strings");
+}
+
+// The first smallest (or largest) item, as Python returns it
+static PyObject *extremeItem(const char *function, PyObject *const *items, size_t count, bool maximum)
+{
+    if (count == 0)
+        throw std::runtime_error(std::string(function) + "() arg is an empty sequence");
+    PyObject *best = items[0];
+    for (size_t i = 1; i < count; ++i)
+        if (maximum ? lessThan(function, best, items[i]) : lessThan(function, items[i], best))
+            best = items[i];
+    return best;
+}
+
+// min(iterable) or min(a, b, ...); arrays go to the vector kernels and
+// ranges and strings need no boxed items
+static PyObject *extreme(const char *function, const std::vector<PyObject *> &args, bool maximum)
+{
+    if (args.size() > 1)
+        return extremeItem(function, args.data(), args.size(), maximum);
+    PyObject *iterable = args[0];
+    switch (iterable->kind)
     {
-        if (!left->isTruthy())
-            return new PyBool(false);
-        PyObject *right = node->right->accept(this);
-        return new PyBool(right->isTruthy());
+    case ObjectKind::Array:
+        return arrayExtreme(function, iterable, maximum);
+    case ObjectKind::List:
+    {
+        const auto &items = static_cast<PyList *>(iterable)->items;
+        return extremeItem(function, items.data(), items.size(), maximum);
     }
-    case TokenType::Or:
+    case ObjectKind::Tuple:
+        return extremeItem(function, static_cast<PyTuple *>(iterable)->begin(),
+                           static_cast<PyTuple *>(iterable)->size(), maximum);
+    case ObjectKind::Range:
     {
-        if (left->isTruthy())
-            return new PyBool(true);
-        PyObject *right = node->right->accept(this);
-        return new PyBool(right->isTruthy());
+        auto range = static_cast<PyRange *>(iterable);
+        unsigned long long length = range->length();
+        if (length == 0)
+            throw std::runtime_error(std::string(function) + "() arg is an empty sequence");
+        long long first = range->at(0);
+        long long last = range->at(length - 1);
+        return new PyInt(maximum == (first < last) ? last : first);
+    }
+    case ObjectKind::Str:
+    {
+        std::string_view text = static_cast<PyStr *>(iterable)->view();
+        if (text.empty())
+            throw std::runtime_error(std::string(function) + "() arg is an empty sequence");
+        auto byte = maximum ? std::max_element(text.begin(), text.end(), std::less<unsigned char>())
+                            : std::min_element(text.begin(), text.end(), std::less<unsigned char>());
+        return new PyStr(std::string(1, *byte));
     }
     default:
-        break;
+        throw std::runtime_error(std::string(function) + "() argument must be iterable");
     }
+}
 
-    PyObject *right = node->right->accept(this);
+static PyObject *builtinMin(const std::vector<PyObject *> &args)
+{
+    return extreme("min", args, false);
+}
 
-    // Check for magic methods on instances
-    if (auto leftInst = dynamic_cast<PyInstance *>(left))
+static PyObject *builtinMax(const std::vector<PyObject *> &args)
+{
+    return extreme("max", args, true);
+}
+
+// Element-wise operations need arrays of the same typecode and length
+static void checkPair(const char *function, PyArray *a, PyArray *b)
+{
+    if (a->typecode != b->typecode)
+        throw std::runtime_error(std::string(function) + "() arrays must have the same typecode");
+    if (a->size() != b->size())
+        throw std::runtime_error(std::string(function) + "() arrays must have the same length");
+}
+
+static void checkOverflow(const char *function, bool ok)
+{
+    if (!ok)
+        throw std::runtime_error(std::string(function) + "() result does not fit in array('q')");
+}
+
+static PyObject *builtinDot(const std::vector<PyObject *> &args)
+{
+    PyArray *a = arrayArgument("dot", args[0]);
+    PyArray *b = arrayArgument("dot", args[1]);
+    checkPair("dot", a, b);
+    if (a->isFloat())
+        return new PyFloat(arrayKernels().dotFloat(a->floats.data(), b->floats.data(), a->size()));
+
+    __int128 total;
+    if (dotInt(a->ints.data(), b->ints.data(), a->size(), total))
+        return intFrom128(total);
+    BigInt exact;
+    for (size_t i = 0; i < a->size(); ++i)
+        exact = exact + BigInt(a->ints[i]) * BigInt(b->ints[i]);
+    return new PyInt(exact);
+}
+
+static PyObject *builtinAdd(const std::vector<PyObject *> &args)
+{
+    PyArray *a = arrayArgument("add", args[0]);
+    PyArray *b = arrayArgument("add", args[1]);
+    checkPair("add", a, b);
+    PyArray *result = new PyArray(a->typecode, a->size());
+    if (a->isFloat())
+        arrayKernels().addFloat(a->floats.data(), b->floats.data(), result->floats.data(), a->size());
+    else
+        checkOverflow("add", arrayKernels().addInt(a->ints.data(), b->ints.data(), result->ints.data(), a->size()));
+    return result;
+}
+
+static PyObject *builtinMul(const std::vector<PyObject *> &args)
+{
+    PyArray *a = arrayArgument("mul", args[0]);
+    PyArray *b = arrayArgument("mul", args[1]);
+    checkPair("mul", a, b);
+    PyArray *result = new PyArray(a->typecode, a->size());
+    if (a->isFloat())
+        arrayKernels().mulFloat(a->floats.data(), b->floats.data(), result->floats.data(), a->size());
+    else
+        checkOverflow("mul", mulInt(a->ints.data(), b->ints.data(), result->ints.data(), a->size()));
+    return result;
+}
+
+// scale(array, k): an int array scaled by an int stays an int array;
+// anything involving a float gives a float array
+static PyObject *builtinScale(const std::vector<PyObject *> &args)
+{
+    PyArray *array = arrayArgument("scale", args[0]);
+    PyObject *factor = args[1];
+    if (!array->isFloat() && (factor->kind == ObjectKind::Int || factor->kind == ObjectKind::Bool))
     {
-        std::string magicMethod;
-        
-        switch (node->op.type)
+        PyArray *result = new PyArray('q', array->size());
+        checkOverflow("scale", scaleInt(array->ints.data(), intElement(factor), result->ints.data(), array->size()));
+        return result;
+    }
+
+    PyArray *result = new PyArray('d', array->size());
+    if (!array->isFloat())
+        result->floats.assign(array->ints.begin(), array->ints.end());
+    const double *source = array->isFloat() ? array->floats.data() : result->floats.data();
+    arrayKernels().scaleFloat(source, floatElement(factor), result->floats.data(), array->size());
+    return result;
+}
+
+// Running totals: element i of the result is the sum of elements 0..i
+static PyObject *builtinPrefixSum(const std::vector<PyObject *> &args)
+{
+    PyArray *array = arrayArgument("prefix_sum", args[0]);
+    PyArray *result = new PyArray(array->typecode, array->size());
+    if (array->isFloat())
+        prefixSumFloat(array->floats.data(), result->floats.data(), array->size());
+    else
+        checkOverflow("prefix_sum", arrayKernels().prefixSumInt(array->ints.data(), result->ints.data(), array->size()));
+    return result;
+}
+
+static PyObject *builtinFlush(const std::vector<PyObject *> &)
+{
+    Output::standard().flush();
+    return new PyNone();
+}
+
+// pmap(f, items) runs script code, so it goes through the interpreter
+// that called it: the one interpret() or callValue() is running on this
+// thread
+static thread_local Interpreter *runningInterpreter = nullptr;
+
+namespace
+{
+class RunningInterpreter
+{
+public:
+    explicit RunningInterpreter(Interpreter *interpreter) : previous(runningInterpreter)
+    {
+        runningInterpreter = interpreter;
+    }
+    ~RunningInterpreter() { runningInterpreter = previous; }
+    RunningInterpreter(const RunningInterpreter &) = delete;
+    RunningInterpreter &operator=(const RunningInterpreter &) = delete;
+
+private:
+    Interpreter *previous;
+};
+
+// Makes a fresh scope enclosed by `enclosing` the current one while
+// alive, then restores the caller's and frees it, on every exit from a
+// call, a thrown error included
+class CallScope
+{
+public:
+    CallScope(Scope *&current, Scope *enclosing)
+        : current(current), previous(current), scope(std::make_unique<Scope>(enclosing))
+    {
+        current = scope.get();
+    }
+    ~CallScope() { current = previous; }
+    CallScope(const CallScope &) = delete;
+    CallScope &operator=(const CallScope &) = delete;
+
+private:
+    Scope *&current;
+    Scope *previous;
+    std::unique_ptr<Scope> scope;
+};
+}
+
+static PyObject *builtinPmap(const std::vector<PyObject *> &args)
+{
+    return runningInterpreter->parallelMap(args[0], args[1]);
+}
+
+// ==================== Modules ====================
+// Fixed-signature natives are bound with bind<>() from binding.hpp, so
+// their arguments are unboxed in the generated wrapper.
+
+static long long perfCounterNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double perfCounter()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double wallTime()
+{
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static PyModule *timeModule()
+{
+    PyModule *module = new PyModule("time");
+    module->define(bind<"perf_counter_ns", perfCounterNs>());
+    module->define(bind<"perf_counter", perfCounter>());
+    module->define(bind<"time", wallTime>());
+    return module;
+}
+
+static double mathSqrt(double x)
+{
+    if (x < 0)
+        throw std::runtime_error("math domain error");
+    return std::sqrt(x);
+}
+
+static double mathLog(double x)
+{
+    if (x <= 0)
+        throw std::runtime_error("math domain error");
+    return std::log(x);
+}
+
+static double mathExp(double x)
+{
+    double result = std::exp(x);
+    if (std::isinf(result) && !std::isinf(x))
+        throw std::runtime_error("math range error");
+    return result;
+}
+
+static double mathSin(double x) { return std::sin(x); }
+static double mathCos(double x) { return std::cos(x); }
+static double mathAtan2(double y, double x) { return std::atan2(y, x); }
+static double mathHypot(double x, double y) { return std::hypot(x, y); }
+
+static PyModule *mathModule()
+{
+    PyModule *module = new PyModule("math");
+    module->define(bind<"sqrt", mathSqrt>());
+    module->define(bind<"log", mathLog>());
+    module->define(bind<"exp", mathExp>());
+    module->define(bind<"sin", mathSin>());
+    module->define(bind<"cos", mathCos>());
+    module->define(bind<"atan2", mathAtan2>());
+    module->define(bind<"hypot", mathHypot>());
+    module->define("pi", new PyFloat(M_PI));
+    module->define("e", new PyFloat(M_E));
+    return module;
+}
+
+// Builtins and modules cannot be changed by scripts, so one set, made
+// outside any session's heap, serves every interpreter
+static const std::vector<std::pair<std::string, PyObject *>> &builtinGlobals()
+{
+    static const std::vector<std::pair<std::string, PyObject *>> globals = []
+    {
+        Heap::Use global(nullptr);
+        return std::vector<std::pair<std::string, PyObject *>>{
+            {"popcount", new PyBuiltin("popcount", 1, builtinPopcount)},
+            {"bit_length", new PyBuiltin("bit_length", 1, builtinBitLength)},
+            {"len", new PyBuiltin("len", 1, builtinLen)},
+            {"abs", new PyBuiltin("abs", 1, builtinAbs)},
+            {"int", new PyBuiltin("int", 0, 1, builtinInt)},
+            {"float", new PyBuiltin("float", 0, 1, builtinFloat)},
+            {"str", new PyBuiltin("str", 0, 1, builtinStr)},
+            {"range", new PyBuiltin("range", 1, 3, builtinRange)},
+            {"array", new PyBuiltin("array", 1, 2, builtinArray)},
+            {"sum", new PyBuiltin("sum", 1, builtinSum)},
+            {"min", new PyBuiltin("min", 1, SIZE_MAX, builtinMin)},
+            {"max", new PyBuiltin("max", 1, SIZE_MAX, builtinMax)},
+            {"dot", new PyBuiltin("dot", 2, builtinDot)},
+            {"add", new PyBuiltin("add", 2, builtinAdd)},
+            {"mul", new PyBuiltin("mul", 2, builtinMul)},
+            {"scale", new PyBuiltin("scale", 2, builtinScale)},
+            {"prefix_sum", new PyBuiltin("prefix_sum", 1, builtinPrefixSum)},
+            {"flush", new PyBuiltin("flush", 0, builtinFlush)},
+            {"pmap", new PyBuiltin("pmap", 2, builtinPmap)},
+            {"time", timeModule()},
+            {"math", mathModule()},
+        };
+    }();
+    return globals;
+}
+
+Interpreter::Interpreter()
+{
+    globalScope = std::make_unique<Scope>();
+    currentScope = globalScope.get();
+    for (const auto &[name, value] : builtinGlobals())
+        globalScope->define(name, value);
+}
+
+// What blocks and assignment statements evaluate to; nothing can observe
+// it, so it is shared and those statements allocate nothing for it
+static PyNone statementResult;
+
+void Interpreter::interpret(ProgramNode *program)
+{
+    RunningInterpreter running(this);
+    currentScope = globalScope.get(); // A program always runs in the globals
+    profile.attach(program);
+    // Boxes of a program run before stay: its functions may still be called
+    if (boxes.size() < static_cast<size_t>(program->siteCount))
+        boxes.resize(static_cast<size_t>(program->siteCount), nullptr);
+    program->accept(this);
+}
+
+PyObject *Interpreter::callValue(PyObject *callee, const std::vector<PyObject *> &args)
+{
+    if (callee->kind != ObjectKind::Builtin && callee->kind != ObjectKind::Function &&
+        callee->kind != ObjectKind::Class)
+        throw std::runtime_error("'" + callee->toString() + "' is not callable");
+    // A call from the host starts in the globals; one from pmap in a
+    // running script stays where the script is
+    if (runningInterpreter != this)
+        currentScope = globalScope.get();
+    RunningInterpreter running(this);
+    return invoke(callee, nullptr, args, nullptr);
+}
+
+void Interpreter::defineGlobal(const std::string &name, PyObject *value)
+{
+    globalScope->define(name, value);
+}
+
+PyObject *Interpreter::findGlobal(const std::string &name) const
+{
+    std::shared_ptr<PyObject> *binding = globalScope->find(name);
+    return binding ? binding->get() : nullptr;
+}
+
+// ==================== Copying Globals ====================
+// The threaded server runs its prelude once and starts every request from
+// a copy of the globals it left. Numbers, strings, builtins and modules
+// cannot change and stay shared; strings must be frozen first, or one that
+// ends its buffer would be appended to in place. Everything else is copied
+// into the current heap, each object once, so aliases and cycles carry
+// over, and functions are rebound: one that closed over the old globals or
+// a class body closes over the copy. A closure over any other scope (a
+// call's) is kept as it is.
+
+namespace
+{
+class GlobalsCopy
+{
+public:
+    GlobalsCopy(Scope *from, Scope *to, const std::vector<std::unique_ptr<Scope>> &classBodies,
+                std::vector<std::unique_ptr<Scope>> &copiedBodies)
+        : copiedBodies(copiedBodies)
+    {
+        scopes[from] = to;
+        for (const auto &body : classBodies)
+            this->classBodies.insert(body.get());
+    }
+
+    PyObject *copy(PyObject *object)
+    {
+        switch (object->kind)
         {
-        case TokenType::Plus:
-            magicMethod = "__add__";
+        case ObjectKind::List:
+        case ObjectKind::Tuple:
+        case ObjectKind::Dict:
+        case ObjectKind::Array:
+        case ObjectKind::Function:
+        case ObjectKind::Class:
+        case ObjectKind::Instance:
             break;
-        case TokenType::Minus:
-            magicMethod = "__sub__";
+        default:
+            return object;
+        }
+        if (auto found = copies.find(object); found != copies.end())
+            return found->second;
+
+        switch (object->kind)
+        {
+        case ObjectKind::List:
+        {
+            auto list = new PyList();
+            copies[object] = list;
+            for (PyObject *item : static_cast<PyList *>(object)->items)
+                list->items.push_back(copy(item));
+            return list;
+        }
+        case ObjectKind::Tuple:
+        {
+            std::vector<PyObject *> items;
+            for (PyObject *item : *static_cast<PyTuple *>(object))
+                items.push_back(copy(item));
+            // A tuple cannot contain itself except through a list or dict,
+            // whose copy is then already made
+            return copies[object] = new PyTuple(items.data(), items.size());
+        }
+        case ObjectKind::Dict:
+        {
+            auto dict = new PyDict();
+            copies[object] = dict;
+            for (const auto &entry : static_cast<PyDict *>(object)->items)
+                dict->items.insert(copy(entry.first), copy(entry.second));
+            return dict;
+        }
+        case ObjectKind::Array:
+        {
+            auto array = static_cast<PyArray *>(object);
+            auto copied = new PyArray(array->typecode, 0);
+            copied->floats = array->floats;
+            copied->ints = array->ints;
+            return copies[object] = copied;
+        }
+        case ObjectKind::Function:
+        {
+            auto func = static_cast<PyFunction *>(object);
+            auto copied = new PyFunction(func->name, func->params, func->body, func->closure);
+            copies[object] = copied; // Before its class body, which holds it
+            if (Scope *closure = copyScope(func->closure.get()))
+                copied->closure = std::shared_ptr<Scope>(closure, [](Scope *) {});
+            return copied;
+        }
+        case ObjectKind::Class:
+        {
+            auto klass = static_cast<PyClass *>(object);
+            auto copied = new PyClass(klass->name);
+            copies[object] = copied;
+            for (const auto &entry : klass->methods)
+                copied->set(entry.first, shared(copy(entry.second.get())));
+            return copied;
+        }
+        default:
+        {
+            auto instance = static_cast<PyInstance *>(object);
+            auto klass = static_cast<PyClass *>(copy(instance->klass.get()));
+            auto copied = new PyInstance(std::shared_ptr<PyClass>(klass, [](PyClass *) {}));
+            copies[object] = copied;
+            for (const auto &entry : instance->attributes)
+                copied->set(entry.first, shared(copy(entry.second.get())));
+            return copied;
+        }
+        }
+    }
+
+private:
+    static std::shared_ptr<PyObject> shared(PyObject *object)
+    {
+        return std::shared_ptr<PyObject>(object, [](PyObject *) {});
+    }
+
+    // The copy of a class body or the globals; nullptr for any other scope
+    Scope *copyScope(Scope *scope)
+    {
+        if (auto found = scopes.find(scope); found != scopes.end())
+            return found->second;
+        if (!classBodies.count(scope))
+            return nullptr;
+        Scope *enclosing = copyScope(scope->getEnclosing());
+        if (!enclosing)
+            return nullptr;
+        auto body = new Scope(enclosing);
+        copiedBodies.emplace_back(body);
+        scopes[scope] = body;
+        for (const auto &entry : scope->getVariables())
+            body->define(entry.first, copy(entry.second.get()));
+        return body;
+    }
+
+    std::unordered_map<PyObject *, PyObject *> copies;
+    std::unordered_map<Scope *, Scope *> scopes;
+    std::unordered_set<Scope *> classBodies;
+    std::vector<std::unique_ptr<Scope>> &copiedBodies;
+};
+}
+
+void Interpreter::freezeGlobals()
+{
+    std::unordered_set<PyObject *> seen;
+    std::vector<PyObject *> pending;
+    for (const auto &entry : globalScope->getVariables())
+        pending.push_back(entry.second.get());
+    while (!pending.empty())
+    {
+        PyObject *object = pending.back();
+        pending.pop_back();
+        if (!seen.insert(object).second)
+            continue;
+        switch (object->kind)
+        {
+        case ObjectKind::Str:
+            static_cast<PyStr *>(object)->freeze();
             break;
-        case TokenType::Star:
-            magicMethod = "__mul__";
+        case ObjectKind::List:
+            for (PyObject *item : static_cast<PyList *>(object)->items)
+                pending.push_back(item);
             break;
-        case TokenType::Slash:
-            magicMethod = "__truediv__";
+        case ObjectKind::Tuple:
+            for (PyObject *item : *static_cast<PyTuple *>(object))
+                pending.push_back(item);
             break;
-        case TokenType::LessEqual:
-            magicMethod = "__le__";
+        case ObjectKind::Dict:
+            for (const auto &entry : static_cast<PyDict *>(object)->items)
+            {
+                pending.push_back(entry.first);
+                pending.push_back(entry.second);
+            }
             break;
-        case TokenType::Less:
-            magicMethod = "__lt__";
+        case ObjectKind::Class:
+            for (const auto &entry : static_cast<PyClass *>(object)->methods)
+                pending.push_back(entry.second.get());
             break;
-        case TokenType::GreaterEqual:
-            magicMethod = "__ge__";
+        case ObjectKind::Instance:
+            pending.push_back(static_cast<PyInstance *>(object)->klass.get());
+            for (const auto &entry : static_cast<PyInstance *>(object)->attributes)
+                pending.push_back(entry.second.get());
             break;
-        case TokenType::Greater:
-            magicMethod = "__gt__";
+        default:
             break;
-        case TokenType::EqualEqual:
-            magicMethod = "__eq__";
+        }
+    }
+}
+
+void Interpreter::copyFrom(const Interpreter &other)
+{
+    GlobalsCopy copy(other.globalScope.get(), globalScope.get(), other.classScopes, classScopes);
+    for (const auto &entry : other.globalScope->getVariables())
+        globalScope->define(entry.first, copy.copy(entry.second.get()));
+    profile = other.profile;
+}
+
+PyObject *Interpreter::visitProgramNode(ProgramNode *node)
+{
+    for (AstNode *stmt : node->statements)
+    {
+        stmt->accept(this);
+    }
+    return new PyNone();
+}
+
+PyObject *Interpreter::visitBlockNode(BlockNode *node)
+{
+    for (AstNode *stmt : node->statements)
+    {
+        stmt->accept(this);
+    }
+    return &statementResult;
+}
+
+// Strings, small ints, floats, bools and None are rendered straight
+// into the output buffer; anything else goes through toString()
+PyObject *Interpreter::visitPrintNode(PrintNode *node)
+{
+    PyObject *value = node->expression->accept(this);
+    Output &out = Output::standard();
+    switch (value->kind)
+    {
+    case ObjectKind::Str:
+        out.write(static_cast<PyStr *>(value)->view());
+        break;
+    case ObjectKind::Int:
+        if (auto number = static_cast<PyInt *>(value); !number->big)
+        {
+            char *digits = out.reserve(maxNumberChars);
+            out.commit(static_cast<size_t>(writeInt(digits, number->value) - digits));
             break;
-        case TokenType::BangEqual:
-            magicMethod = "__ne__";
+        }
+        out.write(value->toString());
+        break;
+    case ObjectKind::Float:
+    {
+        char *digits = out.reserve(maxNumberChars);
+        out.commit(static_cast<size_t>(writeFloat(digits, static_cast<PyFloat *>(value)->value) - digits));
+        break;
+    }
+    case ObjectKind::Bool:
+        out.write(static_cast<PyBool *>(value)->value ? "True" : "False");
+        break;
+    case ObjectKind::None:
+        out.write("None");
+        break;
+    default:
+        out.write(value->toString());
+        break;
+    }
+    out.endLine();
+    return &statementResult;
+}
+
+PyObject *Interpreter::visitPassNode(PassNode *)
+{
+    return nullptr;
+}
+
+PyObject *Interpreter::visitBreakNode(BreakNode *)
+{
+    throw BreakException();
+}
+
+PyObject *Interpreter::visitContinueNode(ContinueNode *)
+{
+    throw ContinueException();
+}
+
+PyObject *Interpreter::visitReturnNode(ReturnNode *node)
+{
+    // Non-owning: the returned object may still be bound to a variable.
+    // Left empty when the values went straight into the caller's slots
+    std::shared_ptr<PyObject> value;
+    if (!node->value)
+        value = std::make_shared<PyNone>();
+    else if (PyObject *result = evaluateInto(node->value, returnSlots))
+        value = std::shared_ptr<PyObject>(result, [](PyObject *) {});
+    throw ReturnException(value);
+}
+
+PyObject *Interpreter::visitIfNode(IfNode *node)
+{
+    if (truthy(node->condition))
+    {
+        node->thenBranch->accept(this);
+        return new PyNone();
+    }
+    for (auto &elifPair : node->elifBranches)
+    {
+        if (truthy(elifPair.first))
+        {
+            elifPair.second->accept(this);
+            return new PyNone();
+        }
+    }
+    if (node->elseBranch)
+        node->elseBranch->accept(this);
+    return new PyNone();
+}
+
+PyObject *Interpreter::visitWhileNode(WhileNode *node)
+{
+    while (truthy(node->condition))
+    {
+        try
+        {
+            node->body->accept(this);
+        }
+        catch (const BreakException &)
+        {
             break;
-        default:
+        }
+        catch (const ContinueException &)
+        {
+            continue;
+        }
+    }
+    return new PyNone();
+}
+
+// ==================== For Loops ====================
+// Runs one iteration; false if the body executed `break`
+bool Interpreter::loopBody(AstNode *body)
+{
+    try
+    {
+        body->accept(this);
+    }
+    catch (const BreakException &)
+    {
+        return false;
+    }
+    catch (const ContinueException &)
+    {
+    }
+    return true;
+}
+
+// Recognizes `for ... in range(...)` with the builtin range and evaluates
+// its arguments natively, so no range object or argument boxes are made
+bool Interpreter::directRange(AstNode *iterable, long long *values, size_t &count)
+{
+    if (iterable->type != AstNodeType::Call)
+        return false;
+    auto call = static_cast<CallNode *>(iterable);
+    if (call->callee->type != AstNodeType::Name)
+        return false;
+    PyObject *callee = visitNameNode(static_cast<NameNode *>(call->callee));
+    if (callee->kind != ObjectKind::Builtin || static_cast<PyBuiltin *>(callee)->function != builtinRange)
+        return false;
+
+    checkArity(static_cast<PyBuiltin *>(callee), call->args.size());
+    count = call->args.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        AstNode *arg = call->args[i];
+        if (arg->staticType != StaticType::Int)
+        {
+            values[i] = rangeArgument(arg->accept(this));
+            continue;
+        }
+        try
+        {
+            values[i] = evalInt(arg);
+        }
+        catch (const BigIntEscape &escape)
+        {
+            values[i] = rangeArgument(escape.value);
+        }
+    }
+    return true;
+}
+
+void Interpreter::rangeLoop(ForNode *node, const PyRange &range)
+{
+    unsigned long long count = range.length();
+    if (count == 0)
+        return;
+
+    const std::string &name = node->target.lexeme;
+    PyInt *counter = new PyInt(range.start);
+    currentScope->set(name, counter);
+    bool inPlace = node->reuse == TargetReuse::Always ||
+                   (node->reuse == TargetReuse::IfLocal && currentScope != globalScope.get() &&
+                    currentScope->hasLocal(name));
+
+    for (unsigned long long i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            if (inPlace)
+                counter->value = range.at(i);
+            else
+                currentScope->set(name, new PyInt(range.at(i)));
+        }
+        if (!loopBody(node->body))
             break;
+    }
+}
+
+PyObject *Interpreter::visitForNode(ForNode *node)
+{
+    long long values[3];
+    size_t count;
+    if (directRange(node->iterable, values, count))
+    {
+        rangeLoop(node, rangeFromArguments(values, count));
+        return new PyNone();
+    }
+
+    PyObject *iterable = node->iterable->accept(this);
+    const std::string &name = node->target.lexeme;
+    switch (iterable->kind)
+    {
+    case ObjectKind::Range:
+        rangeLoop(node, *static_cast<PyRange *>(iterable));
+        break;
+    case ObjectKind::List:
+    {
+        // Re-reads the size each time, so appends made by the body are seen
+        auto &items = static_cast<PyList *>(iterable)->items;
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            currentScope->set(name, items[i]);
+            if (!loopBody(node->body))
+                break;
+        }
+        break;
+    }
+    case ObjectKind::Tuple:
+        for (PyObject *item : *static_cast<PyTuple *>(iterable))
+        {
+            currentScope->set(name, item);
+            if (!loopBody(node->body))
+                break;
+        }
+        break;
+    case ObjectKind::Array:
+    {
+        auto array = static_cast<PyArray *>(iterable);
+        for (size_t i = 0; i < array->size(); ++i)
+        {
+            currentScope->set(name, loadElement(array, i));
+            if (!loopBody(node->body))
+                break;
+        }
+        break;
+    }
+    case ObjectKind::Str:
+    {
+        // Indexed through view() each time: the body may append to the
+        // buffer this string shares
+        auto str = static_cast<PyStr *>(iterable);
+        for (size_t i = 0; i < str->size(); ++i)
+        {
+            currentScope->set(name, new PyStr(std::string(1, str->view()[i])));
+            if (!loopBody(node->body))
+                break;
+        }
+        break;
+    }
+    case ObjectKind::Dict:
+    {
+        // Iterates over the keys present when the loop started
+        std::vector<PyObject *> keys;
+        for (auto &entry : static_cast<PyDict *>(iterable)->items)
+            keys.push_back(entry.first);
+        for (PyObject *key : keys)
+        {
+            currentScope->set(name, key);
+            if (!loopBody(node->body))
+                break;
+        }
+        break;
+    }
+    default:
+        throw std::runtime_error("Object is not iterable");
+    }
+    return new PyNone();
+}
+
+PyObject *Interpreter::visitFunctionNode(FunctionNode *node)
+{
+    std::shared_ptr<AstNode> bodyPtr(node->body, [](AstNode *) {});
+    std::shared_ptr<Scope> closurePtr(currentScope, [](Scope *) {});
+
+    PyFunction *func = new PyFunction(node->name, node->params, bodyPtr, closurePtr);
+    currentScope->define(node->name, func);
+    return func;
+}
+
+PyObject *Interpreter::visitCallNode(CallNode *node)
+{
+    return call(node, nullptr);
+}
+
+PyObject *Interpreter::call(CallNode *node, ReturnSlots *slots)
+{
+    // Check if we're calling a method on an instance
+    PyObject *instance = nullptr;
+    PyObject *callee = nullptr;
+    if (auto propNode = dynamic_cast<PropertyNode *>(node->callee))
+    {
+        // This is a method call like obj.method()
+        instance = propNode->object->accept(this);
+        if (instance->kind == ObjectKind::List)
+            return callListMethod(static_cast<PyList *>(instance), propNode->property, node->args);
+        if (instance->kind == ObjectKind::Dict)
+            return callDictMethod(static_cast<PyDict *>(instance), propNode->property, node->args);
+        if (instance->kind == ObjectKind::Str)
+            return callStrMethod(static_cast<PyStr *>(instance), propNode->property, node->args);
+        if (instance->kind == ObjectKind::Module)
+        {
+            // Module members are plain functions: no self, and no second
+            // evaluation of the module expression
+            callee = static_cast<PyModule *>(instance)->get(propNode->property);
+            instance = nullptr;
+        }
+    }
+
+    if (!callee)
+        callee = node->callee->accept(this);
+    std::vector<PyObject *> args;
+    args.reserve(node->args.size());
+    for (AstNode *arg : node->args)
+        args.push_back(arg->accept(this));
+
+    if (node->site >= 0 && !profile.site(node->site).polymorphic)
+    {
+        if (callee->kind == ObjectKind::Function)
+            profile.recordTarget(profile.site(node->site), static_cast<PyFunction *>(callee)->name);
+        else if (callee->kind == ObjectKind::Class)
+            profile.recordTarget(profile.site(node->site), static_cast<PyClass *>(callee)->name);
+    }
+
+    return invoke(callee, instance, args, slots);
+}
+
+// Calls an evaluated callee; `instance` is bound to the first parameter
+// of a method
+PyObject *Interpreter::invoke(PyObject *callee, PyObject *instance, const std::vector<PyObject *> &args,
+                              ReturnSlots *slots)
+{
+    if (callee->kind == ObjectKind::Builtin)
+    {
+        auto builtin = static_cast<PyBuiltin *>(callee);
+        checkArity(builtin, args.size());
+        return builtin->function(args);
+    }
+
+    if (auto func = dynamic_cast<PyFunction *>(callee))
+    {
+        CallScope scope(currentScope, func->closure.get());
+
+        size_t paramCount = func->params.size();
+        for (size_t i = 0; i < paramCount; ++i)
+        {
+            PyObject *value = nullptr;
+            if (i == 0 && instance != nullptr)
+            {
+                // This is a method call, pass the instance as self
+                value = instance;
+            }
+            else if (instance != nullptr)
+            {
+                // Adjust index since we already used the first parameter for self
+                value = (i - 1 < args.size()) ? args[i - 1] : new PyNone();
+            }
+            else
+            {
+                // Regular function call
+                value = (i < args.size()) ? args[i] : new PyNone();
+            }
+            currentScope->define(func->params[i], value);
+        }
+
+        return runBody(func, slots);
+    }
+
+    if (auto klass = dynamic_cast<PyClass *>(callee))
+    {
+        // Create shared_ptr to the class (non-owning)
+        std::shared_ptr<PyClass> klassPtr(klass, [](PyClass *) {});
+        PyInstance *instance = new PyInstance(klassPtr);
+        
+        std::shared_ptr<PyObject> initObj;
+        try
+        {
+            initObj = klass->get("__init__");
         }
+        catch (const std::runtime_error &)
+        {
+            initObj = nullptr;
+        }
+
+        if (initObj)
+        {
+            if (auto initFn = dynamic_cast<PyFunction *>(initObj.get()))
+            {
+                CallScope scope(currentScope, initFn->closure.get());
+
+                size_t paramCount = initFn->params.size();
+                for (size_t i = 0; i < paramCount; ++i)
+                {
+                    PyObject *value = nullptr;
+                    if (i == 0)
+                        value = instance;
+                    else
+                        value = (i - 1 < args.size()) ? args[i - 1] : new PyNone();
+                    currentScope->define(initFn->params[i], value);
+                }
+
+                runBody(initFn, nullptr);
+            }
+        }
+        return instance;
+    }
+
+    return new PyNone();
+}
+
+// Runs a function body in its prepared call scope. A `return` at the top
+// level of the body is evaluated in place; only returns nested in loops
+// and branches unwind as a ReturnException.
+PyObject *Interpreter::runBody(PyFunction *func, ReturnSlots *slots)
+{
+    ReturnSlots *previousSlots = returnSlots;
+    returnSlots = slots;
+    PyObject *result = nullptr;
+    try
+    {
+        AstNode *body = func->body.get();
+        if (body->type != AstNodeType::Block)
+            body->accept(this);
+        else
+            for (AstNode *stmt : static_cast<BlockNode *>(body)->statements)
+            {
+                if (stmt->type != AstNodeType::Return)
+                {
+                    stmt->accept(this);
+                    continue;
+                }
+                AstNode *value = static_cast<ReturnNode *>(stmt)->value;
+                result = value ? evaluateInto(value, slots) : new PyNone();
+                returnSlots = previousSlots;
+                return result;
+            }
+        result = new PyNone();
+    }
+    catch (const ReturnException &ex)
+    {
+        // Keep the return value alive by storing it in lastReturnValue
+        lastReturnValue = ex.value;
+        result = ex.value.get();
+    }
+    catch (...)
+    {
+        returnSlots = previousSlots;
+        throw;
+    }
+    returnSlots = previousSlots;
+    return result;
+}
+
+PyObject *Interpreter::evaluateInto(AstNode *value, ReturnSlots *slots)
+{
+    if (!slots)
+        return value->accept(this);
+    switch (value->type)
+    {
+    case AstNodeType::Tuple:
+    {
+        auto &elements = static_cast<TupleNode *>(value)->elements;
+        if (elements.size() != slots->count)
+            break;
+        for (size_t i = 0; i < elements.size(); ++i)
+            slots->values[i] = elements[i]->accept(this);
+        slots->filled = true;
+        return nullptr;
+    }
+    case AstNodeType::Call:
+        return call(static_cast<CallNode *>(value), slots);
+    case AstNodeType::InlinedCall:
+        return inlinedCall(static_cast<InlinedCallNode *>(value), slots);
+    default:
+        break;
+    }
+    return value->accept(this);
+}
+
+PyObject *Interpreter::visitInlinedCallNode(InlinedCallNode *node)
+{
+    return inlinedCall(node, nullptr);
+}
+
+PyObject *Interpreter::inlinedCall(InlinedCallNode *node, ReturnSlots *slots)
+{
+    // Guard: the callee must still resolve to the function that was inlined
+    auto func = dynamic_cast<PyFunction *>(currentScope->get(node->name));
+    if (!func || func->body.get() != node->body)
+        return call(node->call, slots);
+
+    size_t base = inlineArgs.size();
+    for (AstNode *arg : node->call->args)
+        inlineArgs.push_back(arg->accept(this));
+
+    // Evaluate the body where the function would have: free names resolve
+    // through its closure, parameters through the argument stack
+    Scope *previousScope = currentScope;
+    size_t previousBase = inlineBase;
+    currentScope = func->closure.get();
+    inlineBase = base;
+
+    PyObject *result;
+    try
+    {
+        result = evaluateInto(node->inlined, slots);
+    }
+    catch (...)
+    {
+        currentScope = previousScope;
+        inlineBase = previousBase;
+        inlineArgs.resize(base);
+        throw;
+    }
+
+    currentScope = previousScope;
+    inlineBase = previousBase;
+    inlineArgs.resize(base);
+    return result;
+}
+
+PyObject *Interpreter::visitParamNode(ParamNode *node)
+{
+    return inlineArgs[inlineBase + node->index];
+}
+
+PyObject *Interpreter::visitPropertyNode(PropertyNode *node)
+{
+    PyObject *obj = node->object->accept(this);
+
+    if (node->site >= 0 && !profile.site(node->site).polymorphic)
+    {
+        if (obj->kind == ObjectKind::Instance)
+            profile.recordTarget(profile.site(node->site),
+                                 static_cast<PyInstance *>(obj)->klass->name + "." + node->property);
+        else if (obj->kind == ObjectKind::Class)
+            profile.recordTarget(profile.site(node->site),
+                                 static_cast<PyClass *>(obj)->name + "." + node->property);
+    }
+    
+    if (auto instance = dynamic_cast<PyInstance *>(obj))
+    {
+        std::shared_ptr<PyObject> value = instance->get(node->property);
+        
+        // If it's a method (PyFunction), we need to bind self to it
+        // For now, we'll just return the function and handle binding in CallNode
+        // This is a simplified approach
+        
+        return value ? value.get() : static_cast<PyObject *>(new PyNone());
+    }
+    
+    if (auto klass = dynamic_cast<PyClass *>(obj))
+    {
+        std::shared_ptr<PyObject> value = klass->get(node->property);
+        return value ? value.get() : static_cast<PyObject *>(new PyNone());
+    }
+
+    if (obj->kind == ObjectKind::Module)
+        return static_cast<PyModule *>(obj)->get(node->property);
+    
+    return new PyNone();
+}
+
+PyObject *Interpreter::visitClassNode(ClassNode *node)
+{
+    // classScope lives as long as the interpreter: methods defined in the
+    // body capture it as their closure
+    Scope *previous = currentScope;
+    Scope *classScope = classScopes.emplace_back(std::make_unique<Scope>(previous)).get();
+    currentScope = classScope;
+    try
+    {
+        node->body->accept(this);
+    }
+    catch (...)
+    {
+        currentScope = previous;
+        throw;
+    }
+    currentScope = previous;
+
+    PyClass *klass = new PyClass(node->name);
+
+    // Get variables from class scope
+    for (const auto &pair : classScope->getVariables())
+    {
+        // pair.second is std::shared_ptr<PyObject>
+        if (auto func = dynamic_cast<PyFunction *>(pair.second.get()))
+        {
+            klass->set(pair.first, pair.second);
+        }
+        else
+        {
+            klass->set(pair.first, pair.second);
+        }
+    }
+
+    currentScope->define(node->name, klass);
+
+    return klass;
+}
+
+// Objects are never mutated, so each literal is boxed once and shared by
+// every evaluation. prepare() boxes them all before a program runs;
+// otherwise they are boxed on first evaluation. Either way they belong to
+// the tree, not to the session that happens to box them.
+static PyObject *literalConstant(AstNode *node)
+{
+    Heap::Use global(nullptr);
+    switch (node->type)
+    {
+    case AstNodeType::Int:
+    {
+        // Literals beyond the int64 range are promoted to BigInt
+        const std::string &digits = static_cast<IntNode *>(node)->value.lexeme;
+        long long value;
+        ParseResult result = parseInt(digits, value);
+        if (result == ParseResult::Ok)
+            return new PyInt(value);
+        std::string stripped;
+        if (result == ParseResult::Invalid || !stripSeparators(digits, stripped))
+            throw std::runtime_error("Invalid integer literal '" + digits + "'");
+        return new PyInt(BigInt::fromString(stripped));
+    }
+    case AstNodeType::Float:
+    {
+        const std::string &text = static_cast<FloatNode *>(node)->value.lexeme;
+        double value;
+        if (parseFloat(text, value) != ParseResult::Ok)
+            throw std::runtime_error("Invalid float literal '" + text + "'");
+        return new PyFloat(value);
+    }
+    case AstNodeType::String:
+    {
+        PyStr *text = new PyStr(static_cast<StringNode *>(node)->value.lexeme);
+        text->freeze();
+        return text;
+    }
+    case AstNodeType::Boolean:
+        return new PyBool(static_cast<BooleanNode *>(node)->value.type == TokenType::True);
+    default:
+        return nullptr;
+    }
+}
+
+PyObject *Interpreter::visitIntNode(IntNode *node)
+{
+    if (!node->constant)
+        node->constant = literalConstant(node);
+    return node->constant;
+}
+
+PyObject *Interpreter::visitFloatNode(FloatNode *node)
+{
+    if (!node->constant)
+        node->constant = literalConstant(node);
+    return node->constant;
+}
+
+PyObject *Interpreter::visitStringNode(StringNode *node)
+{
+    if (!node->constant)
+        node->constant = literalConstant(node);
+    return node->constant;
+}
+
+PyObject *Interpreter::visitBooleanNode(BooleanNode *node)
+{
+    if (!node->constant)
+        node->constant = literalConstant(node);
+    return node->constant;
+}
+
+void Interpreter::prepare(ProgramNode *program)
+{
+    if (program->siteCount < 0)
+        assignSites(program);
+    anyNode(program, [](AstNode *node)
+            {
+        switch (node->type)
+        {
+        case AstNodeType::Int:
+            static_cast<IntNode *>(node)->constant = literalConstant(node);
+            break;
+        case AstNodeType::Float:
+            static_cast<FloatNode *>(node)->constant = literalConstant(node);
+            break;
+        case AstNodeType::String:
+            static_cast<StringNode *>(node)->constant = literalConstant(node);
+            break;
+        case AstNodeType::Boolean:
+            static_cast<BooleanNode *>(node)->constant = literalConstant(node);
+            break;
+        default:
+            break;
+        }
+        return false; });
+}
+
+PyObject *Interpreter::visitNullNode(NullNode *)
+{
+    return new PyNone();
+}
+
+PyObject *Interpreter::visitNameNode(NameNode *node)
+{
+    return currentScope->get(node->name.lexeme);
+}
+
+PyObject *Interpreter::visitBinaryOpNode(BinaryOpNode *node)
+{
+    switch (node->staticType)
+    {
+    case StaticType::Int:
+        try
+        {
+            return new PyInt(evalInt(node));
+        }
+        catch (const BigIntEscape &escape)
+        {
+            return escape.value;
+        }
+    case StaticType::Float:
+        return new PyFloat(evalFloat(node));
+    case StaticType::Bool:
+        return new PyBool(evalBool(node));
+    default:
+        return evaluateBinaryOp(node);
+    }
+}
+
+PyObject *Interpreter::evaluateBinaryOp(BinaryOpNode *node)
+{
+    PyObject *left = node->left->accept(this);
+
+    // Handle logical operators first (short-circuit)
+    switch (node->op.type)
+    {
+    case TokenType::And:
+    {
+        if (!left->isTruthy())
+            return new PyBool(false);
+        PyObject *right = node->right->accept(this);
+        return new PyBool(right->isTruthy());
+    }
+    case TokenType::Or:
+    {
+        if (left->isTruthy())
+            return new PyBool(true);
+        PyObject *right = node->right->accept(this);
+        return new PyBool(right->isTruthy());
+    }
+    default:
+        break;
+    }
+
+    PyObject *right = node->right->accept(this);
+    return applyBinaryOp(node, left, right);
+}
+
+PyObject *Interpreter::applyBinaryOp(BinaryOpNode *node, PyObject *left, PyObject *right)
+{
+    auto getNumeric = [](PyObject *obj, double &out, bool &isInt) -> bool
+    {
+        if (auto v = dynamic_cast<PyInt *>(obj))
+        {
+            out = v->toDouble();
+            isInt = true;
+            return true;
+        }
+        if (auto v = dynamic_cast<PyFloat *>(obj))
+        {
+            out = v->value;
+            isInt = false;
+            return true;
+        }
+        if (auto v = dynamic_cast<PyBool *>(obj))
+        {
+            out = v->value ? 1.0 : 0.0;
+            isInt = true;
+            return true;
+        }
+        return false;
+    };
+
+    if (node->site >= 0)
+    {
+        SiteFeedback &site = profile.site(node->site);
+        if (site.specialization == Specialization::None)
+        {
+            profile.recordBinary(site, node->op.type, left, right);
+        }
+        else if (site.specialization != Specialization::Generic)
+        {
+            if (PyObject *result = specializedBinaryOp(site.specialization, node->op.type, left, right))
+                return result;
+            site.specialization = Specialization::Generic;
+        }
+    }
+
+    // Check for magic methods on instances
+    if (auto leftInst = dynamic_cast<PyInstance *>(left))
+    {
+        std::string magicMethod;
+        
+        switch (node->op.type)
+        {
+        case TokenType::Plus:
+            magicMethod = "__add__";
+            break;
+        case TokenType::Minus:
+            magicMethod = "__sub__";
+            break;
+        case TokenType::Star:
+            magicMethod = "__mul__";
+            break;
+        case TokenType::Slash:
+            magicMethod = "__truediv__";
+            break;
+        case TokenType::DoubleSlash:
+            magicMethod = "__floordiv__";
+            break;
+        case TokenType::Mod:
+            magicMethod = "__mod__";
+            break;
+        case TokenType::DoubleStar:
+            magicMethod = "__pow__";
+            break;
+        case TokenType::Ampersand:
+            magicMethod = "__and__";
+            break;
+        case TokenType::Pipe:
+            magicMethod = "__or__";
+            break;
+        case TokenType::Caret:
+            magicMethod = "__xor__";
+            break;
+        case TokenType::LeftShift:
+            magicMethod = "__lshift__";
+            break;
+        case TokenType::RightShift:
+            magicMethod = "__rshift__";
+            break;
+        case TokenType::LessEqual:
+            magicMethod = "__le__";
+            break;
+        case TokenType::Less:
+            magicMethod = "__lt__";
+            break;
+        case TokenType::GreaterEqual:
+            magicMethod = "__ge__";
+            break;
+        case TokenType::Greater:
+            magicMethod = "__gt__";
+            break;
+        case TokenType::EqualEqual:
+            magicMethod = "__eq__";
+            break;
+        case TokenType::BangEqual:
+            magicMethod = "__ne__";
+            break;
+        default:
+            break;
+        }
+
+        if (!magicMethod.empty())
+        {
+            try
+            {
+                std::shared_ptr<PyObject> method = leftInst->get(magicMethod);
+                if (auto func = dynamic_cast<PyFunction *>(method.get()))
+                {
+                    // Call the magic method with self and other
+                    CallScope scope(currentScope, func->closure.get());
+
+                    // Bind self and other
+                    if (func->params.size() >= 2)
+                    {
+                        currentScope->define(func->params[0], leftInst);
+                        currentScope->define(func->params[1], right);
+                    }
+
+                    PyObject *result = runBody(func, nullptr);
+                    if (auto intVal = dynamic_cast<PyInt *>(result))
+                        result = new PyInt(*intVal);
+                    else if (auto floatVal = dynamic_cast<PyFloat *>(result))
+                        result = new PyFloat(floatVal->value);
+                    else if (auto boolVal = dynamic_cast<PyBool *>(result))
+                        result = new PyBool(boolVal->value);
+                    return result;
+                }
+            }
+            catch (const std::runtime_error &)
+            {
+                // Method not found, fall through to default behavior
+            }
+        }
+    }
+
+    // Ints and bools are exact at any size
+    if (isIntegral(left) && isIntegral(right) &&
+        (isArithmeticOp(node->op.type) || isBitwiseOp(node->op.type) || isComparisonOp(node->op.type)))
+        return integerBinaryOp(node->op.type, left, right);
+    if (isBitwiseOp(node->op.type))
+        throw unsupportedOperands(node->op, left, right);
+    if (PyObject *result = sequenceOp(node->op.type, left, right))
+        return result;
+
+    // Default arithmetic and comparison operations
+    if (node->op.type == TokenType::Plus)
+    {
+        if (auto l = dynamic_cast<PyStr *>(left))
+        {
+            if (auto r = dynamic_cast<PyStr *>(right))
+                return l->concat(r->view());
+            throw unsupportedOperands(node->op, left, right);
+        }
+
+        double lv, rv;
+        bool li, ri;
+        if (getNumeric(left, lv, li) && getNumeric(right, rv, ri))
+        {
+            if (li && ri)
+                return new PyInt(static_cast<long long>(lv + rv));
+            return new PyFloat(lv + rv);
+        }
+        throw unsupportedOperands(node->op, left, right);
+    }
+
+    if (node->op.type == TokenType::Minus || node->op.type == TokenType::Star ||
+        node->op.type == TokenType::Slash || node->op.type == TokenType::DoubleSlash ||
+        node->op.type == TokenType::Mod || node->op.type == TokenType::DoubleStar)
+    {
+        if (node->op.type == TokenType::Star)
+        {
+            if (auto l = dynamic_cast<PyStr *>(left))
+            {
+                if (auto r = dynamic_cast<PyInt *>(right))
+                {
+                    if (r->big && !r->big->isNegative())
+                        throw std::runtime_error("Repeat count too large");
+                    if (r->big || r->value <= 0)
+                        return new PyStr("");
+                    return PyStr::repeat(l->view(), static_cast<size_t>(r->value));
+                }
+            }
+            if (auto r = dynamic_cast<PyStr *>(right))
+            {
+                if (auto l = dynamic_cast<PyInt *>(left))
+                {
+                    if (l->big && !l->big->isNegative())
+                        throw std::runtime_error("Repeat count too large");
+                    if (l->big || l->value <= 0)
+                        return new PyStr("");
+                    return PyStr::repeat(r->view(), static_cast<size_t>(l->value));
+                }
+            }
+        }
+
+        double lv, rv;
+        bool li, ri;
+        if (!getNumeric(left, lv, li) || !getNumeric(right, rv, ri))
+            throw unsupportedOperands(node->op, left, right);
+
+        switch (node->op.type)
+        {
+        case TokenType::Minus:
+            if (li && ri)
+                return new PyInt(static_cast<long long>(lv - rv));
+            return new PyFloat(lv - rv);
+        case TokenType::Star:
+            if (li && ri)
+                return new PyInt(static_cast<long long>(lv * rv));
+            return new PyFloat(lv * rv);
+        case TokenType::Slash:
+            return new PyFloat(lv / rv);
+        case TokenType::DoubleSlash:
+        {
+            double q = std::floor(lv / rv);
+            if (li && ri)
+                return new PyInt(static_cast<long long>(q));
+            return new PyFloat(q);
+        }
+        case TokenType::Mod:
+        {
+            double q = std::floor(lv / rv);
+            double res = lv - q * rv;
+            if (li && ri)
+                return new PyInt(static_cast<long long>(res));
+            return new PyFloat(res);
+        }
+        case TokenType::DoubleStar:
+        {
+            double res = std::pow(lv, rv);
+            if (li && ri)
+                return new PyInt(static_cast<long long>(res));
+            return new PyFloat(res);
+        }
+        default:
+            break;
+        }
+    }
+
+    if (node->op.type == TokenType::EqualEqual || node->op.type == TokenType::BangEqual ||
+        node->op.type == TokenType::Less || node->op.type == TokenType::LessEqual ||
+        node->op.type == TokenType::Greater || node->op.type == TokenType::GreaterEqual)
+    {
+        bool result = false;
+        if (auto l = dynamic_cast<PyStr *>(left))
+        {
+            if (auto r = dynamic_cast<PyStr *>(right))
+            {
+                if (node->op.type == TokenType::EqualEqual)
+                    result = (l->view() == r->view());
+                else if (node->op.type == TokenType::BangEqual)
+                    result = (l->view() != r->view());
+                else if (node->op.type == TokenType::Less)
+                    result = (l->view() < r->view());
+                else if (node->op.type == TokenType::LessEqual)
+                    result = (l->view() <= r->view());
+                else if (node->op.type == TokenType::Greater)
+                    result = (l->view() > r->view());
+                else if (node->op.type == TokenType::GreaterEqual)
+                    result = (l->view() >= r->view());
+                return new PyBool(result);
+            }
+        }
+
+        double lv, rv;
+        bool li, ri;
+        if (getNumeric(left, lv, li) && getNumeric(right, rv, ri))
+        {
+            if (node->op.type == TokenType::EqualEqual)
+                result = (lv == rv);
+            else if (node->op.type == TokenType::BangEqual)
+                result = (lv != rv);
+            else if (node->op.type == TokenType::Less)
+                result = (lv < rv);
+            else if (node->op.type == TokenType::LessEqual)
+                result = (lv <= rv);
+            else if (node->op.type == TokenType::Greater)
+                result = (lv > rv);
+            else if (node->op.type == TokenType::GreaterEqual)
+                result = (lv >= rv);
+            return new PyBool(result);
+        }
+
+        if (left->kind == ObjectKind::Tuple && right->kind == ObjectKind::Tuple &&
+            (node->op.type == TokenType::EqualEqual || node->op.type == TokenType::BangEqual))
+        {
+            bool equal = PyKeyEqual()(left, right);
+            return new PyBool(node->op.type == TokenType::EqualEqual ? equal : !equal);
+        }
+
+        if (dynamic_cast<PyNone *>(left) && dynamic_cast<PyNone *>(right))
+        {
+            if (node->op.type == TokenType::EqualEqual)
+                return new PyBool(true);
+            if (node->op.type == TokenType::BangEqual)
+                return new PyBool(false);
+        }
+
+        if (node->op.type == TokenType::EqualEqual)
+            return new PyBool(false);
+        if (node->op.type == TokenType::BangEqual)
+            return new PyBool(true);
+        return new PyBool(false);
+    }
+
+    throw unsupportedOperands(node->op, left, right);
+}
+
+std::runtime_error Interpreter::unsupportedOperands(const Token &op, PyObject *left, PyObject *right)
+{
+    return std::runtime_error("unsupported operand type(s) for " + op.lexeme + ": '" + typeName(left) +
+                              "' and '" + typeName(right) + "'");
+}
+
+// Repeats `count` copies of items [begin, end) into out; a negative count
+// gives none
+static void repeatItems(PyObject *const *begin, PyObject *const *end, PyObject *count,
+                        std::vector<PyObject *> &out)
+{
+    if (bigPart(count) && !bigPart(count)->isNegative())
+        throw std::runtime_error("Repeat count too large");
+    long long copies = bigPart(count) ? 0 : smallPart(count);
+    size_t size = static_cast<size_t>(end - begin);
+    if (copies <= 0 || size == 0)
+        return;
+    if (static_cast<unsigned long long>(copies) > out.max_size() / size)
+        throw std::runtime_error("Repeat count too large");
+    out.reserve(size * static_cast<size_t>(copies));
+    for (long long copy = 0; copy < copies; ++copy)
+        out.insert(out.end(), begin, end);
+}
+
+// list + list, tuple + tuple and a list or tuple times an int, either
+// way round; null for any other operands
+PyObject *Interpreter::sequenceOp(TokenType op, PyObject *left, PyObject *right)
+{
+    auto isSequence = [](PyObject *obj)
+    { return obj->kind == ObjectKind::List || obj->kind == ObjectKind::Tuple; };
+    auto itemsOf = [](PyObject *obj, PyObject *const *&begin, PyObject *const *&end)
+    {
+        if (obj->kind == ObjectKind::List)
+        {
+            const auto &items = static_cast<PyList *>(obj)->items;
+            begin = items.data();
+            end = items.data() + items.size();
+        }
+        else
+        {
+            begin = static_cast<PyTuple *>(obj)->begin();
+            end = static_cast<PyTuple *>(obj)->end();
+        }
+    };
+    auto make = [](ObjectKind kind, std::vector<PyObject *> items) -> PyObject *
+    {
+        if (kind == ObjectKind::List)
+            return new PyList(std::move(items));
+        return new PyTuple(items.data(), items.size());
+    };
+
+    PyObject *const *begin, *const *end;
+    if (op == TokenType::Plus && isSequence(left) && left->kind == right->kind)
+    {
+        PyObject *const *otherBegin, *const *otherEnd;
+        itemsOf(left, begin, end);
+        itemsOf(right, otherBegin, otherEnd);
+        std::vector<PyObject *> items;
+        items.reserve(static_cast<size_t>((end - begin) + (otherEnd - otherBegin)));
+        items.insert(items.end(), begin, end);
+        items.insert(items.end(), otherBegin, otherEnd);
+        return make(left->kind, std::move(items));
+    }
+    if (op == TokenType::Star && (isSequence(left) || isSequence(right)))
+    {
+        PyObject *sequence = isSequence(left) ? left : right;
+        PyObject *count = sequence == left ? right : left;
+        if (!isIntegral(count))
+            return nullptr;
+        itemsOf(sequence, begin, end);
+        std::vector<PyObject *> items;
+        repeatItems(begin, end, count, items);
+        return make(sequence->kind, std::move(items));
+    }
+    return nullptr;
+}
+
+PyObject *Interpreter::visitUnaryOpNode(UnaryOpNode *node)
+{
+    switch (node->staticType)
+    {
+    case StaticType::Int:
+        try
+        {
+            return new PyInt(evalInt(node));
+        }
+        catch (const BigIntEscape &escape)
+        {
+            return escape.value;
+        }
+    case StaticType::Float:
+        return new PyFloat(evalFloat(node));
+    case StaticType::Bool:
+        return new PyBool(evalBool(node));
+    default:
+        break;
+    }
+
+    PyObject *operand = node->operand->accept(this);
+
+    if (node->op.type == TokenType::Not)
+        return new PyBool(!operand->isTruthy());
+
+    if (node->op.type == TokenType::Tilde)
+    {
+        if (operand->kind == ObjectKind::Int)
+        {
+            auto v = static_cast<PyInt *>(operand);
+            return v->big ? new PyInt(~*v->big) : new PyInt(~v->value);
+        }
+        if (operand->kind == ObjectKind::Bool)
+            return new PyInt(static_cast<PyBool *>(operand)->value ? -2 : -1);
+        throw std::runtime_error("Bad operand type for unary ~");
+    }
+
+    if (node->op.type == TokenType::Minus)
+    {
+        if (auto v = dynamic_cast<PyInt *>(operand))
+            return v->big || v->value == LLONG_MIN ? new PyInt(-v->toBig()) : new PyInt(-v->value);
+        if (auto v = dynamic_cast<PyFloat *>(operand))
+            return new PyFloat(-v->value);
+        if (auto v = dynamic_cast<PyBool *>(operand))
+            return new PyInt(v->value ? -1 : 0);
+    }
+    return new PyNone();
+}
+
+PyObject *Interpreter::visitAssignNode(AssignNode *node)
+{
+    PyObject *value = node->value->accept(this);
+    currentScope->set(node->name.lexeme, value);
+    return value;
+}
+
+PyObject *Interpreter::visitPropertyAssignNode(PropertyAssignNode *node)
+{
+    PyObject *obj = node->object->accept(this);
+    PyObject *value = node->value->accept(this);
+
+    if (auto instance = dynamic_cast<PyInstance *>(obj))
+    {
+        // Use non-owning shared_ptr to avoid double-delete
+        std::shared_ptr<PyObject> valuePtr(value, [](PyObject*){});
+        instance->set(node->property, valuePtr);
+        return value;
+    }
+
+    throw std::runtime_error("Can only assign properties on instances");
+}
+
+// ==================== Lists, Dicts and Subscripts ====================
+static long long indexValue(PyObject *obj)
+{
+    if (obj->kind == ObjectKind::Int)
+    {
+        auto value = static_cast<PyInt *>(obj);
+        if (value->big)
+            return value->big->isNegative() ? LLONG_MIN : LLONG_MAX; // Out of range anyway
+        return value->value;
+    }
+    if (obj->kind == ObjectKind::Bool)
+        return static_cast<PyBool *>(obj)->value ? 1 : 0;
+    throw std::runtime_error("Indices must be integers");
+}
+
+// Resolves a negative index against the end and bounds-checks it
+static size_t checkedIndex(long long index, size_t size, const char *sequence)
+{
+    if (index < 0)
+        index += static_cast<long long>(size);
+    if (index < 0 || static_cast<unsigned long long>(index) >= size)
+        throw std::runtime_error(std::string(sequence) + " index out of range");
+    return static_cast<size_t>(index);
+}
+
+// Clamps an explicit slice bound the way Python's slice.indices() does
+static long long clampBound(long long bound, long long length, long long step)
+{
+    if (bound < 0)
+    {
+        bound += length;
+        if (bound < 0)
+            return step < 0 ? -1 : 0;
+    }
+    else if (bound >= length)
+    {
+        return step < 0 ? length - 1 : length;
+    }
+    return bound;
+}
+
+// Int-typed indices are computed natively, without boxing
+long long Interpreter::indexOperand(AstNode *node)
+{
+    if (node->staticType == StaticType::Int)
+    {
+        try
+        {
+            return evalInt(node);
+        }
+        catch (const BigIntEscape &escape)
+        {
+            return indexValue(escape.value);
+        }
+    }
+    return indexValue(node->accept(this));
+}
+
+bool Interpreter::sliceBound(AstNode *node, long long &out)
+{
+    if (!node)
+        return false;
+    PyObject *value = node->accept(this);
+    if (value->kind == ObjectKind::None)
+        return false;
+    out = indexValue(value);
+    return true;
+}
+
+PyObject *Interpreter::sliceSequence(PyObject *sequence, SliceNode *slice)
+{
+    long long length;
+    if (sequence->kind == ObjectKind::List)
+        length = static_cast<long long>(static_cast<PyList *>(sequence)->items.size());
+    else if (sequence->kind == ObjectKind::Tuple)
+        length = static_cast<long long>(static_cast<PyTuple *>(sequence)->size());
+    else if (sequence->kind == ObjectKind::Array)
+        length = static_cast<long long>(static_cast<PyArray *>(sequence)->size());
+    else if (sequence->kind == ObjectKind::Str)
+        length = static_cast<long long>(static_cast<PyStr *>(sequence)->size());
+    else
+        throw std::runtime_error("Object is not subscriptable");
+
+    long long start = 0, stop = 0, step = 1;
+    bool hasStart = sliceBound(slice->start, start);
+    bool hasStop = sliceBound(slice->stop, stop);
+    sliceBound(slice->step, step);
+    if (step == 0)
+        throw std::runtime_error("Slice step cannot be zero");
+    if (step < -LLONG_MAX)
+        step = -LLONG_MAX;
+
+    start = hasStart ? clampBound(start, length, step) : (step < 0 ? length - 1 : 0);
+    stop = hasStop ? clampBound(stop, length, step) : (step < 0 ? -1 : length);
+
+    size_t count = 0;
+    if (step > 0 && start < stop)
+        count = static_cast<size_t>((stop - start - 1) / step + 1);
+    else if (step < 0 && start > stop)
+        count = static_cast<size_t>((start - stop - 1) / -step + 1);
+
+    if (sequence->kind == ObjectKind::List)
+    {
+        const auto &items = static_cast<PyList *>(sequence)->items;
+        if (step == 1)
+            return new PyList(std::vector<PyObject *>(items.begin() + start, items.begin() + start + count));
+        std::vector<PyObject *> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            result.push_back(items[start + static_cast<long long>(i) * step]);
+        return new PyList(std::move(result));
+    }
+    if (sequence->kind == ObjectKind::Tuple)
+    {
+        PyObject *const *items = static_cast<PyTuple *>(sequence)->begin();
+        std::vector<PyObject *> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            result.push_back(items[start + static_cast<long long>(i) * step]);
+        return new PyTuple(result.data(), count);
+    }
+    if (sequence->kind == ObjectKind::Array)
+    {
+        auto array = static_cast<PyArray *>(sequence);
+        PyArray *result = new PyArray(array->typecode, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t from = static_cast<size_t>(start + static_cast<long long>(i) * step);
+            if (array->isFloat())
+                result->floats[i] = array->floats[from];
+            else
+                result->ints[i] = array->ints[from];
+        }
+        return result;
+    }
+
+    std::string_view value = static_cast<PyStr *>(sequence)->view();
+    if (step == 1)
+        return new PyStr(std::string(value.substr(start, count)));
+    std::string result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        result += value[start + static_cast<long long>(i) * step];
+    return new PyStr(result);
+}
+
+PyObject *Interpreter::callListMethod(PyList *list, const std::string &method, const std::vector<AstNode *> &args)
+{
+    if (method == "append")
+    {
+        if (args.size() != 1)
+            throw std::runtime_error("append() takes 1 argument (" + std::to_string(args.size()) + " given)");
+        list->items.push_back(args[0]->accept(this));
+        return new PyNone();
+    }
+    throw std::runtime_error("List has no method '" + method + "'");
+}
+
+PyObject *Interpreter::callDictMethod(PyDict *dict, const std::string &method, const std::vector<AstNode *> &args)
+{
+    if (method == "get")
+    {
+        if (args.empty() || args.size() > 2)
+            throw std::runtime_error("get() takes 1 or 2 arguments (" + std::to_string(args.size()) + " given)");
+        PyObject *key = args[0]->accept(this);
+        PyObject *fallback = args.size() == 2 ? args[1]->accept(this) : new PyNone();
+        PyObject **value = dict->items.find(key);
+        return value ? *value : fallback;
+    }
+    if (method == "keys" || method == "values")
+    {
+        if (!args.empty())
+            throw std::runtime_error(method + "() takes no arguments (" + std::to_string(args.size()) + " given)");
+        auto result = new PyList();
+        result->items.reserve(dict->items.size());
+        for (auto &entry : dict->items)
+            result->items.push_back(method == "keys" ? entry.first : entry.second);
+        return result;
+    }
+    throw std::runtime_error("Dict has no method '" + method + "'");
+}
+
+PyObject *Interpreter::visitListNode(ListNode *node)
+{
+    std::vector<PyObject *> items;
+    items.reserve(node->elements.size());
+    for (AstNode *element : node->elements)
+        items.push_back(element->accept(this));
+    return new PyList(std::move(items));
+}
+
+PyObject *Interpreter::visitDictNode(DictNode *node)
+{
+    auto dict = new PyDict();
+    for (size_t i = 0; i < node->keys.size(); ++i)
+    {
+        PyObject *key = node->keys[i]->accept(this);
+        dict->items.insert(key, node->values[i]->accept(this));
+    }
+    return dict;
+}
+
+PyObject *Interpreter::visitSubscriptNode(SubscriptNode *node)
+{
+    PyObject *object = node->object->accept(this);
+    if (object->kind == ObjectKind::Dict)
+    {
+        PyObject *key = node->index->accept(this);
+        if (PyObject **value = static_cast<PyDict *>(object)->items.find(key))
+            return *value;
+        throw std::runtime_error("Key not found: " + key->repr());
+    }
+    if (node->index->type == AstNodeType::Slice)
+        return sliceSequence(object, static_cast<SliceNode *>(node->index));
+
+    long long index = indexOperand(node->index);
+    if (object->kind == ObjectKind::List)
+    {
+        const auto &items = static_cast<PyList *>(object)->items;
+        return items[checkedIndex(index, items.size(), "List")];
+    }
+    if (object->kind == ObjectKind::Tuple)
+    {
+        auto tuple = static_cast<PyTuple *>(object);
+        return (*tuple)[checkedIndex(index, tuple->size(), "Tuple")];
+    }
+    if (object->kind == ObjectKind::Array)
+    {
+        auto array = static_cast<PyArray *>(object);
+        return loadElement(array, checkedIndex(index, array->size(), "Array"));
+    }
+    if (object->kind == ObjectKind::Str)
+    {
+        std::string_view value = static_cast<PyStr *>(object)->view();
+        return new PyStr(std::string(1, value[checkedIndex(index, value.size(), "String")]));
+    }
+    throw std::runtime_error("Object is not subscriptable");
+}
+
+PyObject *Interpreter::visitSliceNode(SliceNode *)
+{
+    throw std::runtime_error("Slice outside of a subscript");
+}
+
+// As in Python, the value is evaluated before the target
+PyObject *Interpreter::visitSubscriptAssignNode(SubscriptAssignNode *node)
+{
+    PyObject *value = node->value->accept(this);
+    storeItem(node->object->accept(this), node->index, value);
+    return value;
+}
+
+void Interpreter::storeItem(PyObject *object, AstNode *index, PyObject *value)
+{
+    if (object->kind == ObjectKind::Dict)
+    {
+        static_cast<PyDict *>(object)->items.insert(index->accept(this), value);
+        return;
+    }
+
+    long long position = indexOperand(index);
+    if (object->kind == ObjectKind::Array)
+    {
+        auto array = static_cast<PyArray *>(object);
+        storeElement(array, checkedIndex(position, array->size(), "Array"), value);
+        return;
+    }
+    if (object->kind != ObjectKind::List)
+        throw std::runtime_error("Object does not support item assignment");
+
+    auto &items = static_cast<PyList *>(object)->items;
+    items[checkedIndex(position, items.size(), "List")] = value;
+}
+
+// ==================== Tuples ====================
+PyObject *Interpreter::visitTupleNode(TupleNode *node)
+{
+    size_t count = node->elements.size();
+    if (count <= PyTuple::inlineCapacity)
+    {
+        PyObject *values[PyTuple::inlineCapacity];
+        for (size_t i = 0; i < count; ++i)
+            values[i] = node->elements[i]->accept(this);
+        return new PyTuple(values, count);
+    }
+    std::vector<PyObject *> values;
+    values.reserve(count);
+    for (AstNode *element : node->elements)
+        values.push_back(element->accept(this));
+    return new PyTuple(values.data(), count);
+}
+
+// a, b = value. A tuple literal, or a call whose function returns one,
+// binds through ReturnSlots without the tuple ever being created.
+PyObject *Interpreter::visitUnpackAssignNode(UnpackAssignNode *node)
+{
+    size_t count = node->targets.size();
+    PyObject *value;
+    if (count <= ReturnSlots::capacity)
+    {
+        ReturnSlots slots;
+        slots.count = count;
+        value = evaluateInto(node->value, &slots);
+        if (slots.filled)
+        {
+            for (size_t i = 0; i < count; ++i)
+                assignTarget(node->targets[i], slots.values[i]);
+            return &statementResult;
+        }
+    }
+    else
+    {
+        value = node->value->accept(this);
+    }
+
+    // A list is copied first: its items must all be read before a target
+    // such as lst[0] can change them
+    std::vector<PyObject *> copy;
+    PyObject *const *items;
+    size_t size;
+    if (value->kind == ObjectKind::Tuple)
+    {
+        items = static_cast<PyTuple *>(value)->begin();
+        size = static_cast<PyTuple *>(value)->size();
+    }
+    else if (value->kind == ObjectKind::List)
+    {
+        copy = static_cast<PyList *>(value)->items;
+        items = copy.data();
+        size = copy.size();
+    }
+    else
+    {
+        throw std::runtime_error("Cannot unpack a non-sequence");
+    }
+
+    if (size > count)
+        throw std::runtime_error("Too many values to unpack (expected " + std::to_string(count) + ")");
+    if (size < count)
+        throw std::runtime_error("Not enough values to unpack (expected " + std::to_string(count) + ", got " +
+                                 std::to_string(size) + ")");
+    for (size_t i = 0; i < count; ++i)
+        assignTarget(node->targets[i], items[i]);
+    return &statementResult;
+}
+
+void Interpreter::assignTarget(AstNode *target, PyObject *value)
+{
+    switch (target->type)
+    {
+    case AstNodeType::Name:
+        currentScope->set(static_cast<NameNode *>(target)->name.lexeme, value);
+        break;
+    case AstNodeType::Property:
+    {
+        auto property = static_cast<PropertyNode *>(target);
+        auto instance = dynamic_cast<PyInstance *>(property->object->accept(this));
+        if (!instance)
+            throw std::runtime_error("Can only assign properties on instances");
+        instance->set(property->property, std::shared_ptr<PyObject>(value, [](PyObject *) {}));
+        break;
+    }
+    case AstNodeType::Subscript:
+    {
+        auto subscript = static_cast<SubscriptNode *>(target);
+        storeItem(subscript->object->accept(this), subscript->index, value);
+        break;
+    }
+    default:
+        throw std::runtime_error("Invalid assignment target");
+    }
+}
+
+// ==================== Specialized Evaluation ====================
+// Expressions whose type was proven by TypeInferencePass are computed
+// natively; only the outermost result of a proven subtree is boxed.
+
+static bool isIntLike(StaticType type)
+{
+    return type == StaticType::Int || type == StaticType::Bool;
+}
+
+static bool isNumeric(StaticType type)
+{
+    return isIntLike(type) || type == StaticType::Float;
+}
+
+// ==================== Feedback-Specialized Kernels ====================
+static double floatArithmetic(TokenType op, double a, double b)
+{
+    switch (op)
+    {
+    case TokenType::Plus:
+        return a + b;
+    case TokenType::Minus:
+        return a - b;
+    case TokenType::Star:
+        return a * b;
+    case TokenType::Slash:
+        return a / b;
+    case TokenType::DoubleSlash:
+        return std::floor(a / b);
+    case TokenType::Mod:
+        return a - std::floor(a / b) * b;
+    default:
+        return std::pow(a, b);
+    }
+}
+
+PyObject *Interpreter::specializedBinaryOp(Specialization kind, TokenType op, PyObject *left, PyObject *right)
+{
+    switch (kind)
+    {
+    case Specialization::Int:
+    {
+        if (left->kind != ObjectKind::Int || right->kind != ObjectKind::Int)
+            return nullptr;
+        return integerBinaryOp(op, left, right);
+    }
+    case Specialization::Float:
+    {
+        bool leftFloat = left->kind == ObjectKind::Float;
+        bool rightFloat = right->kind == ObjectKind::Float;
+        if ((!leftFloat && left->kind != ObjectKind::Int) ||
+            (!rightFloat && right->kind != ObjectKind::Int) || (!leftFloat && !rightFloat))
+            return nullptr;
+        double a = leftFloat ? static_cast<PyFloat *>(left)->value : static_cast<PyInt *>(left)->toDouble();
+        double b = rightFloat ? static_cast<PyFloat *>(right)->value : static_cast<PyInt *>(right)->toDouble();
+        if (isComparisonOp(op))
+            return new PyBool(compare(op, a, b));
+        return new PyFloat(floatArithmetic(op, a, b));
+    }
+    case Specialization::Str:
+    {
+        if (left->kind != ObjectKind::Str || right->kind != ObjectKind::Str)
+            return nullptr;
+        auto a = static_cast<PyStr *>(left);
+        std::string_view b = static_cast<PyStr *>(right)->view();
+        if (op == TokenType::Plus)
+            return a->concat(b);
+        return new PyBool(compare(op, a->view(), b));
+    }
+    default:
+        return nullptr;
+    }
+}
+
+long long Interpreter::intOperand(AstNode *node)
+{
+    if (node->staticType == StaticType::Bool)
+        return evalBool(node) ? 1 : 0;
+    return evalInt(node);
+}
+
+double Interpreter::numberOperand(AstNode *node)
+{
+    switch (node->staticType)
+    {
+    case StaticType::Float:
+        return evalFloat(node);
+    case StaticType::Bool:
+        return evalBool(node) ? 1.0 : 0.0;
+    default:
+        try
+        {
+            return static_cast<double>(evalInt(node));
+        }
+        catch (const BigIntEscape &escape)
+        {
+            return escape.value->toDouble();
+        }
+    }
+}
+
+long long Interpreter::evalInt(AstNode *node)
+{
+    switch (node->type)
+    {
+    case AstNodeType::Int:
+        return smallInt(visitIntNode(static_cast<IntNode *>(node)));
+    case AstNodeType::Name:
+        return smallInt(visitNameNode(static_cast<NameNode *>(node)));
+    case AstNodeType::UnaryOp:
+    {
+        bool invert = static_cast<UnaryOpNode *>(node)->op.type == TokenType::Tilde;
+        long long operand;
+        try
+        {
+            operand = intOperand(static_cast<UnaryOpNode *>(node)->operand);
+        }
+        catch (const BigIntEscape &escape)
+        {
+            BigInt value = escape.value->toBig();
+            return smallInt(new PyInt(invert ? ~value : -value));
+        }
+        if (invert)
+            return ~operand;
+        if (operand == LLONG_MIN)
+            return smallInt(new PyInt(-BigInt(operand)));
+        return -operand;
+    }
+    case AstNodeType::BinaryOp:
+    {
+        auto binary = static_cast<BinaryOpNode *>(node);
+        TokenType op = binary->op.type;
+        long long a, b, result;
+        try
+        {
+            a = intOperand(binary->left);
+        }
+        catch (const BigIntEscape &escape)
+        {
+            return smallInt(integerBinaryOp(op, escape.value, binary->right->accept(this)));
+        }
+        try
+        {
+            b = intOperand(binary->right);
+        }
+        catch (const BigIntEscape &escape)
+        {
+            return smallInt(integerBinaryOp(op, new PyInt(a), escape.value));
+        }
+        if (intArithmetic(op, a, b, result))
+            return result;
+        return smallInt(bigArithmetic(op, BigInt(a), BigInt(b)));
+    }
+    default:
+        return smallInt(node->accept(this));
+    }
+}
+
+double Interpreter::evalFloat(AstNode *node)
+{
+    switch (node->type)
+    {
+    case AstNodeType::Float:
+        return static_cast<PyFloat *>(visitFloatNode(static_cast<FloatNode *>(node)))->value;
+    case AstNodeType::Name:
+        return static_cast<PyFloat *>(visitNameNode(static_cast<NameNode *>(node)))->value;
+    case AstNodeType::UnaryOp:
+        return -numberOperand(static_cast<UnaryOpNode *>(node)->operand);
+    case AstNodeType::BinaryOp:
+    {
+        auto binary = static_cast<BinaryOpNode *>(node);
+        double a = numberOperand(binary->left);
+        double b = numberOperand(binary->right);
+        switch (binary->op.type)
+        {
+        case TokenType::Plus:
+            return a + b;
+        case TokenType::Minus:
+            return a - b;
+        case TokenType::Star:
+            return a * b;
+        case TokenType::Slash:
+            return a / b;
+        case TokenType::DoubleSlash:
+            return std::floor(a / b);
+        case TokenType::Mod:
+            return a - std::floor(a / b) * b;
+        case TokenType::DoubleStar:
+            return std::pow(a, b);
+        default:
+            break;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return static_cast<PyFloat *>(node->accept(this))->value;
+}
+
+bool Interpreter::evalBool(AstNode *node)
+{
+    switch (node->type)
+    {
+    case AstNodeType::Boolean:
+        return static_cast<BooleanNode *>(node)->value.type == TokenType::True;
+    case AstNodeType::Name:
+        return static_cast<PyBool *>(visitNameNode(static_cast<NameNode *>(node)))->value;
+    case AstNodeType::UnaryOp:
+        return !truthy(static_cast<UnaryOpNode *>(node)->operand);
+    case AstNodeType::BinaryOp:
+    {
+        auto binary = static_cast<BinaryOpNode *>(node);
+        TokenType op = binary->op.type;
+        if (op == TokenType::And)
+            return truthy(binary->left) && truthy(binary->right);
+        if (op == TokenType::Or)
+            return truthy(binary->left) || truthy(binary->right);
+        if (op == TokenType::Ampersand || op == TokenType::Pipe || op == TokenType::Caret)
+        {
+            // Only bool & bool (and | and ^) is proven Bool
+            bool a = evalBool(binary->left);
+            bool b = evalBool(binary->right);
+            return op == TokenType::Ampersand ? a && b : op == TokenType::Pipe ? a || b : a != b;
+        }
+
+        StaticType lt = binary->left->staticType;
+        StaticType rt = binary->right->staticType;
+        if (!isNumeric(lt) || !isNumeric(rt))
+            return static_cast<PyBool *>(evaluateBinaryOp(binary))->value;
+
+        if (isIntLike(lt) && isIntLike(rt))
+        {
+            long long a, b;
+            try
+            {
+                a = intOperand(binary->left);
+            }
+            catch (const BigIntEscape &escape)
+            {
+                return static_cast<PyBool *>(
+                           integerBinaryOp(op, escape.value, binary->right->accept(this)))
+                    ->value;
+            }
+            try
+            {
+                b = intOperand(binary->right);
+            }
+            catch (const BigIntEscape &escape)
+            {
+                return static_cast<PyBool *>(integerBinaryOp(op, new PyInt(a), escape.value))->value;
+            }
+            return compare(op, a, b);
+        }
+        double a = numberOperand(binary->left);
+        double b = numberOperand(binary->right);
+        return compare(op, a, b);
+    }
+    default:
+        return static_cast<PyBool *>(node->accept(this))->value;
+    }
+}
+
+static bool primitiveNumber(PyObject *obj, double &out)
+{
+    switch (obj->kind)
+    {
+    case ObjectKind::Int:
+        out = static_cast<PyInt *>(obj)->toDouble();
+        return true;
+    case ObjectKind::Float:
+        out = static_cast<PyFloat *>(obj)->value;
+        return true;
+    case ObjectKind::Bool:
+        out = static_cast<PyBool *>(obj)->value ? 1.0 : 0.0;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool Interpreter::truthy(AstNode *node)
+{
+    switch (node->staticType)
+    {
+    case StaticType::Int:
+        try
+        {
+            return evalInt(node) != 0;
+        }
+        catch (const BigIntEscape &)
+        {
+            return true; // Big ints are never zero
+        }
+    case StaticType::Float:
+        return evalFloat(node) != 0.0;
+    case StaticType::Bool:
+        return evalBool(node);
+    default:
+        break;
+    }
+
+    // Unproven conditions still avoid boxing the result of `not`, `and`,
+    // `or` and comparisons of primitive operands
+    switch (node->type)
+    {
+    case AstNodeType::Name:
+        return visitNameNode(static_cast<NameNode *>(node))->isTruthy();
+    case AstNodeType::UnaryOp:
+    {
+        auto unary = static_cast<UnaryOpNode *>(node);
+        if (unary->op.type == TokenType::Not)
+            return !truthy(unary->operand);
+        break;
+    }
+    case AstNodeType::BinaryOp:
+    {
+        auto binary = static_cast<BinaryOpNode *>(node);
+        TokenType op = binary->op.type;
+        if (op == TokenType::And)
+            return truthy(binary->left) && truthy(binary->right);
+        if (op == TokenType::Or)
+            return truthy(binary->left) || truthy(binary->right);
+        if (!isComparisonOp(op))
+            break;
+
+        PyObject *left = binary->left->accept(this);
+        PyObject *right = binary->right->accept(this);
+        bool result;
+        if (comparePrimitive(op, left, right, result))
+            return result;
+        return applyBinaryOp(binary, left, right)->isTruthy();
+    }
+    default:
+        break;
+    }
+    return node->accept(this)->isTruthy();
+}
+
+// Compares ints, floats, bools and strings without allocating; false if
+// the operands need the generic path (instances, None, mixed kinds)
+bool Interpreter::comparePrimitive(TokenType op, PyObject *left, PyObject *right, bool &result)
+{
+    ObjectKind lk = left->kind;
+    ObjectKind rk = right->kind;
+    if (lk == ObjectKind::Int && rk == ObjectKind::Int)
+    {
+        if (bigPart(left) || bigPart(right))
+            result = static_cast<PyBool *>(integerBinaryOp(op, left, right))->value;
+        else
+            result = compare(op, static_cast<PyInt *>(left)->value, static_cast<PyInt *>(right)->value);
+        return true;
+    }
+    if (lk == ObjectKind::Str && rk == ObjectKind::Str)
+    {
+        result = compare(op, static_cast<PyStr *>(left)->view(), static_cast<PyStr *>(right)->view());
+        return true;
+    }
+
+    double a, b;
+    if (!primitiveNumber(left, a) || !primitiveNumber(right, b))
+        return false;
+    result = compare(op, a, b);
+    return true;
+}
+
+// ==================== Augmented Assignment ====================
+// target op= value evaluates the target's object and index once, then
+// reads the item, applies the operation and stores the result back.
+PyObject *Interpreter::visitAugAssignNode(AugAssignNode *node)
+{
+    BinaryOpNode *operation = node->operation;
+    switch (node->target->type)
+    {
+    case AstNodeType::Name:
+        augmentName(node);
+        break;
+    case AstNodeType::Property:
+    {
+        auto property = static_cast<PropertyNode *>(node->target);
+        auto instance = dynamic_cast<PyInstance *>(property->object->accept(this));
+        if (!instance)
+            throw std::runtime_error("Can only assign properties on instances");
+        PyObject *left = instance->get(property->property).get();
+        PyObject *result = inPlaceOp(operation, left, operation->right->accept(this));
+        instance->set(property->property, std::shared_ptr<PyObject>(result, [](PyObject *) {}));
+        break;
+    }
+    default:
+    {
+        auto subscript = static_cast<SubscriptNode *>(node->target);
+        augmentItem(node, subscript->object->accept(this), subscript->index);
+        break;
+    }
+    }
+    return &statementResult;
+}
+
+// A proven Int or Float result is computed unboxed. It overwrites the
+// variable's current box when that box is one this statement created in
+// the running frame (see AugAssignNode::reuseBox), so an accumulator
+// updated in a loop allocates nothing.
+PyObject *Interpreter::augmentName(AugAssignNode *node)
+{
+    const std::string &name = static_cast<NameNode *>(node->target)->name.lexeme;
+    std::shared_ptr<PyObject> *binding = currentScope->find(name);
+    if (!binding)
+        throw std::runtime_error("Undefined variable '" + name + "'");
+
+    BinaryOpNode *operation = node->operation;
+    TokenType op = operation->op.type;
+    PyObject *left = binding->get();
+    PyObject *result;
+    if (operation->staticType == StaticType::Int && left->kind == ObjectKind::Int && !bigPart(left))
+    {
+        auto box = static_cast<PyInt *>(left);
+        PyObject *escaped = nullptr;
+        long long b = 0, value;
+        try
+        {
+            b = intOperand(operation->right);
+        }
+        catch (const BigIntEscape &escape)
+        {
+            escaped = escape.value;
+        }
+        if (escaped)
+        {
+            result = integerBinaryOp(op, left, escaped);
+        }
+        else if (!intArithmetic(op, box->value, b, value))
+        {
+            result = bigArithmetic(op, BigInt(box->value), BigInt(b));
+        }
+        else if (ownsBox(node, left, name))
+        {
+            box->value = value;
+            return left;
+        }
+        else
+        {
+            result = new PyInt(value);
+        }
+    }
+    else if (operation->staticType == StaticType::Float && left->kind == ObjectKind::Float)
+    {
+        auto box = static_cast<PyFloat *>(left);
+        double value = floatArithmetic(op, box->value, numberOperand(operation->right));
+        if (ownsBox(node, left, name))
+        {
+            box->value = value;
+            return left;
+        }
+        result = new PyFloat(value);
+    }
+    else
+    {
+        result = inPlaceOp(operation, left, operation->right->accept(this));
+        if (result == left)
+            return left;
+    }
+
+    if (node->reuseBox)
+        boxSlot(node) = result;
+    if (!node->stableBinding)
+        binding = currentScope->find(name);
+    *binding = std::shared_ptr<PyObject>(result, [](PyObject *) {});
+    return result;
+}
+
+bool Interpreter::ownsBox(AugAssignNode *node, PyObject *value, const std::string &name)
+{
+    return node->reuseBox && value == boxSlot(node) && currentScope->hasLocal(name);
+}
+
+PyObject *&Interpreter::boxSlot(AugAssignNode *node)
+{
+    auto site = static_cast<size_t>(node->operation->site);
+    if (site >= boxes.size())
+        boxes.resize(site + 1, nullptr);
+    return boxes[site];
+}
+
+// object[index] op= value. Typed arrays are updated without boxing when
+// the value is a proven number. The item is looked up again for the
+// store, since evaluating the value may have resized the container.
+void Interpreter::augmentItem(AugAssignNode *node, PyObject *object, AstNode *index)
+{
+    BinaryOpNode *operation = node->operation;
+    TokenType op = operation->op.type;
+    if (object->kind == ObjectKind::Dict)
+    {
+        auto &items = static_cast<PyDict *>(object)->items;
+        PyObject *key = index->accept(this);
+        PyObject **item = items.find(key);
+        if (!item)
+            throw std::runtime_error("Key not found: " + key->repr());
+        PyObject *result = inPlaceOp(operation, *item, operation->right->accept(this));
+        items.insert(key, result);
+        return;
+    }
+
+    long long position = indexOperand(index);
+    if (object->kind == ObjectKind::List)
+    {
+        auto &items = static_cast<PyList *>(object)->items;
+        PyObject *left = items[checkedIndex(position, items.size(), "List")];
+        PyObject *result = inPlaceOp(operation, left, operation->right->accept(this));
+        items[checkedIndex(position, items.size(), "List")] = result;
+        return;
+    }
+    if (object->kind != ObjectKind::Array)
+        throw std::runtime_error("Object does not support item assignment");
+
+    auto array = static_cast<PyArray *>(object);
+    size_t i = checkedIndex(position, array->size(), "Array");
+    StaticType rightType = operation->right->staticType;
+    PyObject *right;
+    if (array->isFloat() && isArithmeticOp(op) && isNumeric(rightType))
+    {
+        double b = numberOperand(operation->right);
+        i = checkedIndex(position, array->size(), "Array");
+        array->floats[i] = floatArithmetic(op, array->floats[i], b);
+        return;
+    }
+    if (!array->isFloat() && op != TokenType::Slash && (isArithmeticOp(op) || isBitwiseOp(op)) &&
+        isIntLike(rightType))
+    {
+        PyObject *escaped = nullptr;
+        long long b = 0, value;
+        try
+        {
+            b = intOperand(operation->right);
+        }
+        catch (const BigIntEscape &escape)
+        {
+            escaped = escape.value;
+        }
+        i = checkedIndex(position, array->size(), "Array");
+        if (!escaped && intArithmetic(op, array->ints[i], b, value))
+        {
+            array->ints[i] = value;
+            return;
+        }
+        right = escaped ? escaped : new PyInt(b);
+    }
+    else
+    {
+        right = operation->right->accept(this);
+    }
+
+    i = checkedIndex(position, array->size(), "Array");
+    PyObject *result = applyBinaryOp(operation, loadElement(array, i), right);
+    storeElement(array, checkedIndex(position, array->size(), "Array"), result);
+}
+
+// The operation behind op=. Lists are extended or repeated in place, and
+// string concatenation appends to the left string's buffer when it can
+// (see PyStr). Everything else is the plain binary operation.
+PyObject *Interpreter::inPlaceOp(BinaryOpNode *operation, PyObject *left, PyObject *right)
+{
+    TokenType op = operation->op.type;
+    if (left->kind == ObjectKind::List && op == TokenType::Plus)
+    {
+        auto &items = static_cast<PyList *>(left)->items;
+        if (right->kind == ObjectKind::List)
+        {
+            // Indexed, so `lst += lst` appends the original items once
+            const auto &other = static_cast<PyList *>(right)->items;
+            size_t count = other.size();
+            items.reserve(items.size() + count);
+            for (size_t i = 0; i < count; ++i)
+                items.push_back(other[i]);
+        }
+        else if (right->kind == ObjectKind::Tuple)
+        {
+            auto tuple = static_cast<PyTuple *>(right);
+            items.insert(items.end(), tuple->begin(), tuple->end());
+        }
+        else
+        {
+            throw std::runtime_error("Can only extend a list with a list or tuple");
+        }
+        return left;
+    }
+    if (left->kind == ObjectKind::List && op == TokenType::Star && isIntegral(right))
+    {
+        auto &items = static_cast<PyList *>(left)->items;
+        if (bigPart(right) && !bigPart(right)->isNegative())
+            throw std::runtime_error("Repeat count too large");
+        long long count = bigPart(right) ? 0 : smallPart(right);
+        if (count <= 0)
+        {
+            items.clear();
+            return left;
+        }
+        size_t size = items.size();
+        if (size && static_cast<unsigned long long>(count) > items.max_size() / size)
+            throw std::runtime_error("Repeat count too large");
+        items.reserve(size * static_cast<size_t>(count));
+        for (long long copy = 1; copy < count; ++copy)
+            for (size_t i = 0; i < size; ++i)
+                items.push_back(items[i]);
+        return left;
+    }
+    if (op == TokenType::Plus && left->kind == ObjectKind::Str && right->kind == ObjectKind::Str)
+        return static_cast<PyStr *>(left)->concat(static_cast<PyStr *>(right)->view());
+    return applyBinaryOp(operation, left, right);
+}
+
+// ==================== String Methods ====================
+// Native str methods, dispatched from the call site like the list and
+// dict methods, so a call needs no method object and no Scope. Searching
+// and splitting run on the string kernels (see simd.hpp), and results are
+// sized before they are filled.
+struct StrMethod
+{
+    const char *name;
+    size_t least, most;
+};
+
+static const StrMethod strMethods[] = {
+    {"find", 1, 3}, {"count", 1, 3}, {"split", 0, 2}, {"join", 1, 1}, {"replace", 2, 3},
+    {"strip", 0, 1}, {"lstrip", 0, 1}, {"rstrip", 0, 1}, {"startswith", 1, 1}, {"endswith", 1, 1}};
+
+static std::string_view strArgument(PyObject *value, const std::string &method)
+{
+    if (value->kind != ObjectKind::Str)
+        throw std::runtime_error(method + "() argument must be str");
+    return static_cast<PyStr *>(value)->view();
+}
+
+// Start and end of find() and count(), resolved like slice bounds; a
+// start past the end is kept past it so nothing can match there
+static size_t rangeBound(PyObject *value, size_t size, size_t fallback, size_t limit)
+{
+    if (value->kind == ObjectKind::None)
+        return fallback;
+    long long bound = indexValue(value);
+    if (bound < 0)
+        bound = std::max(bound + static_cast<long long>(size), 0LL);
+    return static_cast<size_t>(std::min(static_cast<unsigned long long>(bound), static_cast<unsigned long long>(limit)));
+}
+
+// A negative count means no limit
+static size_t countLimit(PyObject *value)
+{
+    long long count = value->kind == ObjectKind::None ? -1 : indexValue(value);
+    return count < 0 ? SIZE_MAX : static_cast<size_t>(count);
+}
+
+static size_t countOccurrences(std::string_view text, std::string_view needle, const StringKernels &kernels)
+{
+    if (needle.empty())
+        return text.size() + 1;
+    if (needle.size() == 1)
+        return kernels.countByte(text.data(), text.size(), needle[0]);
+    size_t count = 0;
+    for (size_t from = 0;; ++count)
+    {
+        size_t at = kernels.find(text.data() + from, text.size() - from, needle.data(), needle.size());
+        if (at == notFound)
+            return count;
+        from += at + needle.size();
+    }
+}
+
+static void splitOn(std::string_view text, std::string_view separator, size_t limit, std::vector<PyObject *> &out,
+                    const StringKernels &kernels)
+{
+    if (separator.empty())
+        throw std::runtime_error("Empty separator");
+    size_t from = 0;
+    while (out.size() < limit)
+    {
+        size_t at = kernels.find(text.data() + from, text.size() - from, separator.data(), separator.size());
+        if (at == notFound)
+            break;
+        out.push_back(new PyStr(std::string(text.substr(from, at))));
+        from += at + separator.size();
+    }
+    out.push_back(new PyStr(std::string(text.substr(from))));
+}
+
+// Runs of whitespace separate the pieces and leading and trailing
+// whitespace yields none; once `limit` pieces are split off, the rest
+// (minus its leading whitespace) is the last one
+static void splitWhitespace(std::string_view text, size_t limit, std::vector<PyObject *> &out,
+                            const StringKernels &kernels)
+{
+    size_t n = text.size();
+    uint64_t local[32]; // Enough for a 2 KB line
+    std::vector<uint64_t> large;
+    uint64_t *bits = local;
+    if (spaceWords(n) > std::size(local))
+    {
+        large.resize(spaceWords(n));
+        bits = large.data();
+    }
+    kernels.spaceBits(text.data(), n, bits);
+
+    forEachWord(bits, n, [&](size_t start, size_t end)
+    {
+        if (out.size() == limit)
+        {
+            out.push_back(new PyStr(std::string(text.substr(start))));
+            return false;
+        }
+        out.push_back(new PyStr(std::string(text.substr(start, end - start))));
+        return true;
+    });
+}
+
+static PyObject *joinStrings(std::string_view separator, PyObject *iterable)
+{
+    PyObject *const *items;
+    size_t count;
+    if (iterable->kind == ObjectKind::List)
+    {
+        const auto &list = static_cast<PyList *>(iterable)->items;
+        items = list.data();
+        count = list.size();
+    }
+    else if (iterable->kind == ObjectKind::Tuple)
+    {
+        auto tuple = static_cast<PyTuple *>(iterable);
+        items = tuple->begin();
+        count = tuple->size();
+    }
+    else
+    {
+        throw std::runtime_error("join() argument must be a list or tuple");
+    }
+
+    size_t total = count ? separator.size() * (count - 1) : 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (items[i]->kind != ObjectKind::Str)
+            throw std::runtime_error("Sequence item " + std::to_string(i) + ": expected str instance");
+        total += static_cast<PyStr *>(items[i])->size();
+    }
+    if (count == 1)
+        return items[0];
+
+    std::string out;
+    out.reserve(total);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i)
+            out.append(separator);
+        out.append(static_cast<PyStr *>(items[i])->view());
+    }
+    return new PyStr(std::move(out));
+}
+
+static PyObject *replaceAll(PyStr *str, std::string_view old, std::string_view replacement, size_t limit,
+                            const StringKernels &kernels)
+{
+    std::string_view text = str->view();
+    std::string out;
+    if (old.empty())
+    {
+        // The replacement goes before every character and at the end
+        size_t inserts = std::min(limit, text.size() + 1);
+        out.reserve(text.size() + inserts * replacement.size());
+        for (size_t i = 0; i <= text.size(); ++i)
+        {
+            if (i < inserts)
+                out.append(replacement);
+            if (i < text.size())
+                out += text[i];
+        }
+        return new PyStr(std::move(out));
+    }
+
+    std::vector<size_t> matches;
+    for (size_t from = 0; matches.size() < limit;)
+    {
+        size_t at = kernels.find(text.data() + from, text.size() - from, old.data(), old.size());
+        if (at == notFound)
+            break;
+        matches.push_back(from + at);
+        from += at + old.size();
+    }
+    if (matches.empty())
+        return str;
+
+    out.reserve(text.size() - matches.size() * old.size() + matches.size() * replacement.size());
+    size_t from = 0;
+    for (size_t at : matches)
+    {
+        out.append(text.substr(from, at - from)).append(replacement);
+        from = at + old.size();
+    }
+    out.append(text.substr(from));
+    return new PyStr(std::move(out));
+}
+
+static PyObject *stripChars(PyStr *str, const std::string &method, PyObject *chars)
+{
+    std::string_view text = str->view();
+    bool left = method != "rstrip", right = method != "lstrip";
+    size_t begin = 0, end = text.size();
+    if (!chars || chars->kind == ObjectKind::None)
+    {
+        while (left && begin < end && isSpaceByte(text[begin]))
+            ++begin;
+        while (right && end > begin && isSpaceByte(text[end - 1]))
+            --end;
+    }
+    else
+    {
+        bool strip[256] = {};
+        for (char c : strArgument(chars, method))
+            strip[static_cast<unsigned char>(c)] = true;
+        while (left && begin < end && strip[static_cast<unsigned char>(text[begin])])
+            ++begin;
+        while (right && end > begin && strip[static_cast<unsigned char>(text[end - 1])])
+            --end;
+    }
+    if (begin == 0 && end == text.size())
+        return str;
+    return new PyStr(std::string(text.substr(begin, end - begin)));
+}
+
+// A str or a tuple of strs, any of which may match
+static bool affixMatches(std::string_view text, PyObject *affix, const std::string &method)
+{
+    bool prefix = method == "startswith";
+    auto matches = [&](PyObject *candidate)
+    {
+        std::string_view piece = strArgument(candidate, method);
+        return prefix ? text.starts_with(piece) : text.ends_with(piece);
+    };
+    if (affix->kind != ObjectKind::Tuple)
+        return matches(affix);
+    auto tuple = static_cast<PyTuple *>(affix);
+    return std::any_of(tuple->begin(), tuple->end(), matches);
+}
+
+PyObject *Interpreter::callStrMethod(PyStr *str, const std::string &method, const std::vector<AstNode *> &args)
+{
+    auto entry = std::find_if(std::begin(strMethods), std::end(strMethods),
+                              [&](const StrMethod &candidate) { return method == candidate.name; });
+    if (entry == std::end(strMethods))
+        throw std::runtime_error("Str has no method '" + method + "'");
+    if (args.size() < entry->least || args.size() > entry->most)
+    {
+        std::string expected = entry->least == entry->most ? std::to_string(entry->least)
+                                                           : std::to_string(entry->least) + " to " + std::to_string(entry->most);
+        throw std::runtime_error(method + "() takes " + expected + (entry->most == 1 ? " argument (" : " arguments (") +
+                                 std::to_string(args.size()) + " given)");
+    }
+
+    // Every argument is evaluated before the receiver's characters are
+    // read, since interpreted code may append to the buffer behind them
+    PyObject *values[3] = {};
+    for (size_t i = 0; i < args.size(); ++i)
+        values[i] = args[i]->accept(this);
+    std::string_view text = str->view();
+    size_t size = text.size();
+    const StringKernels &kernels = stringKernels();
+
+    if (method == "find" || method == "count")
+    {
+        std::string_view needle = strArgument(values[0], method);
+        size_t start = values[1] ? rangeBound(values[1], size, 0, size + 1) : 0;
+        size_t end = values[2] ? rangeBound(values[2], size, size, size) : size;
+        bool find = method == "find";
+        if (start > end)
+            return new PyInt(find ? -1LL : 0LL);
+        std::string_view window = text.substr(start, end - start);
+        if (!find)
+            return new PyInt(static_cast<long long>(countOccurrences(window, needle, kernels)));
+        if (needle.empty())
+            return new PyInt(static_cast<long long>(start));
+        size_t at = kernels.find(window.data(), window.size(), needle.data(), needle.size());
+        return new PyInt(at == notFound ? -1LL : static_cast<long long>(start + at));
+    }
+    if (method == "split")
+    {
+        size_t limit = values[1] ? countLimit(values[1]) : SIZE_MAX;
+        auto result = new PyList();
+        if (!values[0] || values[0]->kind == ObjectKind::None)
+            splitWhitespace(text, limit, result->items, kernels);
+        else
+            splitOn(text, strArgument(values[0], method), limit, result->items, kernels);
+        return result;
+    }
+    if (method == "join")
+        return joinStrings(text, values[0]);
+    if (method == "replace")
+        return replaceAll(str, strArgument(values[0], method), strArgument(values[1], method),
+                          values[2] ? countLimit(values[2]) : SIZE_MAX, kernels);
+    if (method == "startswith" || method == "endswith")
+        return new PyBool(affixMatches(text, values[0], method));
+    return stripChars(str, method, values[0]);
+}
+
+// ==================== F-Strings ====================
+// Every field is evaluated, left to right, before anything is rendered,
+// so the output is reserved once: the literal text plus an estimate per
+// field. Numbers are converted with std::to_chars and copied in with
+// their padding; strings are copied in directly.
+
+// Appends sign + body padded to `width`. With '=' the padding goes
+// between the sign (and any 0x prefix) and the digits.
+static void appendPadded(std::string &out, size_t width, char fill, char align, std::string_view sign,
+                         std::string_view body)
+{
+    size_t length = sign.size() + body.size();
+    size_t padding = width > length ? width - length : 0;
+    if (align == '=')
+    {
+        out.append(sign).append(padding, fill).append(body);
+        return;
+    }
+    size_t before = align == '>' ? padding : align == '^' ? padding / 2 : 0;
+    out.append(before, fill).append(sign).append(body).append(padding - before, fill);
+}
+
+static void formatText(std::string &out, std::string_view text, const FormatSpec &spec)
+{
+    if (spec.type && spec.type != 's')
+        throw std::runtime_error(std::string("Unknown format code '") + spec.type + "' for str");
+    if (spec.precision >= 0)
+        text = text.substr(0, static_cast<size_t>(spec.precision));
+    appendPadded(out, spec.width, spec.fill, spec.align ? spec.align : '<', "", text);
+}
+
+// Groups of four are of a hex, octal or binary int, whose digits may be
+// letters
+static bool isGroupedDigit(char c, size_t every)
+{
+    return every == 4 ? std::isxdigit(static_cast<unsigned char>(c)) != 0 : c >= '0' && c <= '9';
+}
+
+// Grouped `digits` with zeros, and separators between them, put in front
+// up to `width`, as many more as keep the result from starting with a
+// separator
+static std::string zeroGroups(std::string_view digits, char separator, size_t every, size_t width)
+{
+    size_t lead = 0; // Digits in the leading group
+    while (lead < digits.size() && isGroupedDigit(digits[lead], every))
+        ++lead;
+    std::string front;
+    while (front.size() + digits.size() < width)
+    {
+        if (lead == every)
+        {
+            front += separator;
+            lead = 0;
+        }
+        front += '0';
+        ++lead;
+    }
+    std::reverse(front.begin(), front.end());
+    return front.append(digits);
+}
+
+// Numbers are right-aligned by default, and a '0' before the width pads
+// between the sign and the digits. Zeros padding grouped digits are
+// grouped too; `every` is the group size.
+static void appendNumber(std::string &out, const FormatSpec &spec, bool negative, std::string_view prefix,
+                         std::string_view digits, size_t every = 3)
+{
+    char sign[3];
+    size_t length = 0;
+    if (negative || spec.sign != '-')
+        sign[length++] = negative ? '-' : spec.sign;
+    for (char c : prefix)
+        sign[length++] = c;
+    char align = spec.align ? spec.align : spec.zeroPad ? '=' : '>';
+    std::string padded;
+    if (spec.grouping && spec.fill == '0' && align == '=' && length + digits.size() < spec.width)
+    {
+        padded = zeroGroups(digits, spec.grouping, every, spec.width - length);
+        digits = padded;
+    }
+    appendPadded(out, spec.width, spec.fill, align, std::string_view(sign, length), digits);
+}
+
+// Separators every `every` digits of the leading run of digits
+static std::string groupDigits(std::string_view digits, char separator, size_t every)
+{
+    size_t run = 0;
+    while (run < digits.size() && isGroupedDigit(digits[run], every))
+        ++run;
+    std::string out;
+    out.reserve(digits.size() + run / every);
+    for (size_t i = 0; i < run; ++i)
+    {
+        if (i && (run - i) % every == 0)
+            out += separator;
+        out += digits[i];
+    }
+    return out.append(digits.substr(run));
+}
+
+static void formatFloat(std::string &out, double value, const FormatSpec &spec)
+{
+    char type = spec.type;
+    if (type && std::string_view("eEfFgG%").find(type) == std::string_view::npos)
+        throw std::runtime_error(std::string("Unknown format code '") + type + "' for float");
+    bool negative = std::signbit(value) && !std::isnan(value);
+    double magnitude = std::fabs(value) * (type == '%' ? 100 : 1);
+    int precision = spec.precision >= 0 ? spec.precision : 6;
 
-        if (!magicMethod.empty())
+    // A fixed-point double has up to 309 integer digits
+    char local[400];
+    std::vector<char> large;
+    size_t capacity = static_cast<size_t>(precision) + 350;
+    char *buffer = local;
+    if (capacity > sizeof local)
+    {
+        large.resize(capacity);
+        buffer = large.data();
+    }
+    char *end;
+    if (type == 'f' || type == 'F' || type == '%')
+        end = std::to_chars(buffer, buffer + capacity, magnitude, std::chars_format::fixed, precision).ptr;
+    else if (type == 'e' || type == 'E')
+        end = std::to_chars(buffer, buffer + capacity, magnitude, std::chars_format::scientific, precision).ptr;
+    else if (type == 'g' || type == 'G' || !std::isfinite(magnitude))
+        end = std::to_chars(buffer, buffer + capacity, magnitude, std::chars_format::general, precision).ptr;
+    else
+    {
+        // No type: like 'g', but fixed point keeps a digit after the
+        // point, and it switches to exponent form one digit earlier
+        int digits = std::max(precision, 1);
+        end = std::to_chars(buffer, buffer + capacity, magnitude, std::chars_format::scientific, digits - 1).ptr;
+        const char *sign = std::find(buffer, end, 'e') + 1;
+        int exponent = 0;
+        std::from_chars(sign + (*sign == '+'), end, exponent);
+        bool fixed = exponent >= -4 && exponent < digits - 1;
+        if (fixed)
+            end = std::to_chars(buffer, buffer + capacity, magnitude, std::chars_format::fixed, digits - 1 - exponent).ptr;
+        char *point = std::find(buffer, end, '.');
+        char *mantissaEnd = std::find(buffer, end, 'e');
+        if (point != mantissaEnd)
         {
-            try
-            {
-                std::shared_ptr<PyObject> method = leftInst->get(magicMethod);
-                if (auto func = dynamic_cast<PyFunction *>(method.get()))
-                {
-                    // Call the magic method with self and other
-                    Scope *previous = currentScope;
-                    Scope *newCallScope = new Scope(func->closure.get());
-                    currentScope = newCallScope;
+            // Trailing zeros go, and with them the point unless fixed
+            char *last = mantissaEnd;
+            while (last[-1] == '0')
+                --last;
+            if (last[-1] == '.' && fixed)
+                *last++ = '0';
+            else if (last[-1] == '.')
+                --last;
+            end = std::copy(mantissaEnd, end, last);
+        }
+    }
+    if (type == '%')
+        *end++ = '%';
+    if (type == 'E' || type == 'F' || type == 'G')
+        std::transform(buffer, end, buffer, [](char c) { return static_cast<char>(std::toupper(c)); });
 
-                    // Bind self and other
-                    if (func->params.size() >= 2)
-                    {
-                        currentScope->define(func->params[0], leftInst);
-                        currentScope->define(func->params[1], right);
-                    }
+    std::string_view digits(buffer, static_cast<size_t>(end - buffer));
+    if (spec.grouping)
+        appendNumber(out, spec, negative, "", groupDigits(digits, spec.grouping, 3));
+    else
+        appendNumber(out, spec, negative, "", digits);
+}
 
-                    PyObject *result = new PyNone();
-                    try
-                    {
-                        func->body->accept(this);
-                    }
-                    catch (const ReturnException &ex)
-                    {
-                        if (auto intVal = dynamic_cast<PyInt *>(ex.value.get()))
-                            result = new PyInt(intVal->value);
-                        else if (auto floatVal = dynamic_cast<PyFloat *>(ex.value.get()))
-                            result = new PyFloat(floatVal->value);
-                        else if (auto boolVal = dynamic_cast<PyBool *>(ex.value.get()))
-                            result = new PyBool(boolVal->value);
-                        else if (auto inst = dynamic_cast<PyInstance *>(ex.value.get()))
-                            result = inst;
-                        else
-                            result = ex.value.get();
-                    }
+static void formatInt(std::string &out, PyInt *value, const FormatSpec &spec)
+{
+    char type = spec.type ? spec.type : 'd';
+    if (std::string_view("eEfFgG%").find(type) != std::string_view::npos)
+    {
+        formatFloat(out, value->toDouble(), spec);
+        return;
+    }
+    if (type == 's')
+        throw std::runtime_error("Unknown format code 's' for int");
+    int base = type == 'x' || type == 'X' ? 16 : type == 'o' ? 8 : type == 'b' ? 2 : 10;
 
-                    currentScope = previous;
-                    delete newCallScope;
-                    return result;
-                }
-            }
-            catch (const std::runtime_error &)
-            {
-                // Method not found, fall through to default behavior
-            }
-        }
+    char local[64];
+    std::string bigDigits;
+    std::string_view digits;
+    bool negative;
+    if (value->big)
+    {
+        bigDigits = value->big->toString(base);
+        if (type == 'X')
+            std::transform(bigDigits.begin(), bigDigits.end(), bigDigits.begin(),
+                           [](char c) { return static_cast<char>(std::toupper(c)); });
+        negative = bigDigits[0] == '-';
+        digits = std::string_view(bigDigits).substr(negative);
+    }
+    else
+    {
+        negative = value->value < 0;
+        unsigned long long magnitude = static_cast<unsigned long long>(value->value);
+        if (negative)
+            magnitude = 0 - magnitude;
+        char *end = std::to_chars(local, local + sizeof local, magnitude, base).ptr;
+        if (type == 'X')
+            std::transform(local, end, local, [](char c) { return static_cast<char>(std::toupper(c)); });
+        digits = std::string_view(local, static_cast<size_t>(end - local));
     }
 
-    // Default arithmetic and comparison operations
-    if (node->op.type == TokenType::Plus)
+    std::string_view prefix;
+    if (spec.alternate && base != 10)
+        prefix = type == 'x' ? "0x" : type == 'X' ? "0X" : type == 'o' ? "0o" : "0b";
+    if (spec.grouping)
     {
-        if (auto l = dynamic_cast<PyStr *>(left))
+        size_t every = base == 10 ? 3 : 4;
+        appendNumber(out, spec, negative, prefix, groupDigits(digits, spec.grouping, every), every);
+    }
+    else
+        appendNumber(out, spec, negative, prefix, digits);
+}
+
+static void formatField(std::string &out, PyObject *value, const FStringSegment &segment)
+{
+    const FormatSpec &spec = segment.spec;
+    if (segment.conversion)
+    {
+        formatText(out, segment.conversion == 's' ? value->toString() : value->repr(), spec);
+        return;
+    }
+    switch (value->kind)
+    {
+    case ObjectKind::Str:
+        formatText(out, static_cast<PyStr *>(value)->view(), spec);
+        return;
+    case ObjectKind::Int:
+        if (spec.empty && !static_cast<PyInt *>(value)->big)
         {
-            if (auto r = dynamic_cast<PyStr *>(right))
-                return new PyStr(l->value + r->value);
-            return new PyNone();
+            char local[maxNumberChars];
+            out.append(local, writeInt(local, static_cast<PyInt *>(value)->value));
+            return;
         }
-
-        double lv, rv;
-        bool li, ri;
-        if (getNumeric(left, lv, li) && getNumeric(right, rv, ri))
+        formatInt(out, static_cast<PyInt *>(value), spec);
+        return;
+    case ObjectKind::Float:
+    {
+        double number = static_cast<PyFloat *>(value)->value;
+        if (spec.type || spec.precision >= 0)
         {
-            if (li && ri)
-                return new PyInt(static_cast<long long>(lv + rv));
-            return new PyFloat(lv + rv);
+            formatFloat(out, number, spec);
+            return;
         }
-        return new PyNone();
+        // Without a type or precision a float reads as its repr
+        char local[maxNumberChars];
+        std::string_view text(local, static_cast<size_t>(writeFloat(local, std::fabs(number)) - local));
+        appendNumber(out, spec, std::signbit(number) && !std::isnan(number), "", text);
+        return;
+    }
+    case ObjectKind::Bool:
+        if (!spec.empty)
+        {
+            PyInt number(static_cast<PyBool *>(value)->value ? 1 : 0);
+            formatInt(out, &number, spec);
+            return;
+        }
+        break;
+    default:
+        if (!spec.empty)
+            throw std::runtime_error("Only str, int and float values take a format spec");
+        break;
     }
+    out.append(value->toString());
+}
 
-    if (node->op.type == TokenType::Minus || node->op.type == TokenType::Star ||
-        node->op.type == TokenType::Slash || node->op.type == TokenType::DoubleSlash ||
-        node->op.type == TokenType::Mod || node->op.type == TokenType::DoubleStar)
+// Room a field is likely to need; exact for unpadded strings
+static size_t fieldEstimate(PyObject *value, const FStringSegment &segment)
+{
+    size_t size = 24;
+    if (value->kind == ObjectKind::Str && !segment.conversion)
+        size = static_cast<PyStr *>(value)->size();
+    else if (value->kind == ObjectKind::Float && segment.spec.precision > 0)
+        size += static_cast<size_t>(segment.spec.precision);
+    return std::max(size, segment.spec.width);
+}
+
+PyObject *Interpreter::visitFStringNode(FStringNode *node)
+{
+    const auto &segments = node->segments;
+    PyObject *local[8];
+    std::vector<PyObject *> large;
+    PyObject **values = local;
+    if (segments.size() > std::size(local))
     {
-        if (node->op.type == TokenType::Star)
+        large.resize(segments.size());
+        values = large.data();
+    }
+
+    size_t estimate = node->literalSize;
+    for (size_t i = 0; i < segments.size(); ++i)
+        if (segments[i].expression)
         {
-            if (auto l = dynamic_cast<PyStr *>(left))
+            values[i] = segments[i].expression->accept(this);
+            estimate += fieldEstimate(values[i], segments[i]);
+        }
+
+    std::string out;
+    out.reserve(estimate);
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        out.append(segments[i].literal);
+        if (segments[i].expression)
+            formatField(out, values[i], segments[i]);
+    }
+    return new PyStr(std::move(out));
+}
+
+// ==================== Parallel Map ====================
+// pmap splits its items into chunks and runs them on a process-wide
+// WorkPool. The calling thread takes part with its own interpreter; each
+// other pool thread works in a helper Interpreter (scopes, type feedback,
+// boxes) and allocates from a helper Heap, both kept by the caller. The
+// threads then share only the immutable tree, the function's closure and
+// the items, which is sound only if the function cannot write to any of
+// them. isolatedFunction() and disjointItem() check that before anything
+// runs in parallel; whenever they cannot prove it, and when pmap is
+// called from a pool task (a --jobs script, say), the map runs
+// sequentially on the calling thread instead, with the same result.
+
+static std::atomic<size_t> parallelism{0};
+static std::mutex mapPoolLock; // Held by the pmap that is using the pool
+
+static WorkPool &mapPool()
+{
+    static WorkPool pool(parallelism.load());
+    return pool;
+}
+
+void Interpreter::setParallelism(size_t threads)
+{
+    parallelism.store(threads);
+}
+
+// Builtins without effects that do not write to their arguments
+static bool pureBuiltin(const std::string &name)
+{
+    static const std::unordered_set<std::string> names = {
+        "len", "abs", "int", "float", "str", "range", "min", "max", "sum", "popcount", "bit_length", "dot"};
+    return names.count(name) != 0;
+}
+
+// str, list and dict methods that only read their object
+static bool readingMethod(const std::string &name)
+{
+    static const std::unordered_set<std::string> names = {
+        "get", "keys", "values", "startswith", "endswith", "count", "find", "split", "join", "replace"};
+    return names.count(name) != 0;
+}
+
+// Whether calls to `func` touch nothing but their arguments, read only,
+// and objects they create. That holds when the body does not print or
+// define functions or classes; binds only names its closure lacks (a
+// bound name would be assigned in place, see Scope::set); writes items
+// or appends only to locals that were only ever bound to a new list or
+// dict; and reads no free names but pure builtins, modules and functions
+// that pass the same test. Any other global, even a constant, fails it.
+bool Interpreter::isolatedFunction(PyFunction *func, std::unordered_map<PyFunction *, bool> &checked)
+{
+    auto known = checked.find(func);
+    if (known != checked.end())
+        return known->second;
+    checked[func] = true; // A recursive call is judged by the rest of the body
+
+    Scope *closure = func->closure.get();
+    std::unordered_set<std::string> params(func->params.begin(), func->params.end());
+    std::unordered_set<std::string> locals = params;
+    std::unordered_set<std::string> fresh;
+    std::unordered_set<std::string> rebound;
+    anyNode(func->body.get(), [&](AstNode *node)
             {
-                if (auto r = dynamic_cast<PyInt *>(right))
-                {
-                    if (r->value <= 0)
-                        return new PyStr("");
-                    std::string out;
-                    out.reserve(l->value.size() * static_cast<size_t>(r->value));
-                    for (long long i = 0; i < r->value; ++i)
-                        out += l->value;
-                    return new PyStr(out);
-                }
-            }
-            if (auto r = dynamic_cast<PyStr *>(right))
+        forEachAssignedName(node, [&](const std::string &name)
+                            {
+            locals.insert(name);
+            bool created = false;
+            if (node->type == AstNodeType::Assign)
             {
-                if (auto l = dynamic_cast<PyInt *>(left))
-                {
-                    if (l->value <= 0)
-                        return new PyStr("");
-                    std::string out;
-                    out.reserve(r->value.size() * static_cast<size_t>(l->value));
-                    for (long long i = 0; i < l->value; ++i)
-                        out += r->value;
-                    return new PyStr(out);
-                }
+                AstNodeType value = static_cast<AssignNode *>(node)->value->type;
+                created = value == AstNodeType::List || value == AstNodeType::Dict;
             }
-        }
+            (created && !params.count(name) ? fresh : rebound).insert(name); });
+        return false; });
+    for (const std::string &name : rebound)
+        fresh.erase(name);
 
-        double lv, rv;
-        bool li, ri;
-        if (!getNumeric(left, lv, li) || !getNumeric(right, rv, ri))
-            return new PyNone();
+    bool isolated = true;
+    for (const std::string &name : locals)
+        if (!params.count(name) && closure->find(name))
+            isolated = false;
 
-        switch (node->op.type)
+    auto freeValue = [&](AstNode *node) -> PyObject *
+    {
+        if (node->type != AstNodeType::Name)
+            return nullptr;
+        const std::string &name = static_cast<NameNode *>(node)->name.lexeme;
+        if (locals.count(name))
+            return nullptr;
+        std::shared_ptr<PyObject> *binding = closure->find(name);
+        return binding ? binding->get() : nullptr;
+    };
+    auto freshLocal = [&](AstNode *node)
+    {
+        return node->type == AstNodeType::Name && fresh.count(static_cast<NameNode *>(node)->name.lexeme);
+    };
+
+    std::function<bool(AstNode *)> shares = [&](AstNode *node) -> bool
+    {
+        switch (node->type)
         {
-        case TokenType::Minus:
-            if (li && ri)
-                return new PyInt(static_cast<long long>(lv - rv));
-            return new PyFloat(lv - rv);
-        case TokenType::Star:
-            if (li && ri)
-                return new PyInt(static_cast<long long>(lv * rv));
-            return new PyFloat(lv * rv);
-        case TokenType::Slash:
-            return new PyFloat(lv / rv);
-        case TokenType::DoubleSlash:
+        case AstNodeType::Print:
+        case AstNodeType::Function:
+        case AstNodeType::Class:
+        case AstNodeType::PropertyAssign:
+            return true;
+        case AstNodeType::Name:
         {
-            double q = std::floor(lv / rv);
-            if (li && ri)
-                return new PyInt(static_cast<long long>(q));
-            return new PyFloat(q);
+            if (locals.count(static_cast<NameNode *>(node)->name.lexeme))
+                return false;
+            PyObject *value = freeValue(node);
+            if (!value)
+                return true;
+            if (value->kind == ObjectKind::Builtin)
+                return !pureBuiltin(static_cast<PyBuiltin *>(value)->name);
+            if (value->kind == ObjectKind::Function)
+                return !isolatedFunction(static_cast<PyFunction *>(value), checked);
+            return value->kind != ObjectKind::Module;
         }
-        case TokenType::Mod:
+        case AstNodeType::InlinedCall:
+            // The substituted body reads the callee's names, not ours; the
+            // call it replaces names the callee
+            return shares(static_cast<InlinedCallNode *>(node)->call);
+        case AstNodeType::SubscriptAssign:
+            if (!freshLocal(static_cast<SubscriptAssignNode *>(node)->object))
+                return true;
+            break;
+        case AstNodeType::AugAssign:
         {
-            double q = std::floor(lv / rv);
-            double res = lv - q * rv;
-            if (li && ri)
-                return new PyInt(static_cast<long long>(res));
-            return new PyFloat(res);
+            AstNode *target = static_cast<AugAssignNode *>(node)->target;
+            if (target->type == AstNodeType::Property ||
+                (target->type == AstNodeType::Subscript && !freshLocal(static_cast<SubscriptNode *>(target)->object)))
+                return true;
+            break;
         }
-        case TokenType::DoubleStar:
+        case AstNodeType::UnpackAssign:
+            for (AstNode *target : static_cast<UnpackAssignNode *>(node)->targets)
+                if (target->type != AstNodeType::Name)
+                    return true;
+            break;
+        case AstNodeType::Call:
         {
-            double res = std::pow(lv, rv);
-            if (li && ri)
-                return new PyInt(static_cast<long long>(res));
-            return new PyFloat(res);
+            auto callee = static_cast<CallNode *>(node)->callee;
+            if (callee->type != AstNodeType::Property)
+                break;
+            auto method = static_cast<PropertyNode *>(callee);
+            PyObject *module = freeValue(method->object);
+            if (module && module->kind == ObjectKind::Module)
+                break;
+            if (method->property == "append" ? !freshLocal(method->object) : !readingMethod(method->property))
+                return true;
+            break;
         }
         default:
             break;
         }
-    }
+        return anyChild(node, shares);
+    };
+    if (isolated && shares(func->body.get()))
+        isolated = false;
+    checked[func] = isolated;
+    return isolated;
+}
 
-    if (node->op.type == TokenType::EqualEqual || node->op.type == TokenType::BangEqual ||
-        node->op.type == TokenType::Less || node->op.type == TokenType::LessEqual ||
-        node->op.type == TokenType::Greater || node->op.type == TokenType::GreaterEqual)
+// Whether `item` can be handed to a worker: it and everything it holds
+// are numbers, strings, ranges, arrays or containers of them, and no
+// container is reached twice, from this item or an earlier one. Reading
+// a container is then private to one thread (str() on a list marks it
+// while printing). Strings are frozen, so no thread hashes or appends
+// to them in place.
+bool Interpreter::disjointItem(PyObject *item, std::unordered_set<PyObject *> &seen)
+{
+    switch (item->kind)
     {
-        bool result = false;
-        if (auto l = dynamic_cast<PyStr *>(left))
-        {
-            if (auto r = dynamic_cast<PyStr *>(right))
-            {
-                if (node->op.type == TokenType::EqualEqual)
-                    result = (l->value == r->value);
-                else if (node->op.type == TokenType::BangEqual)
-                    result = (l->value != r->value);
-                else if (node->op.type == TokenType::Less)
-                    result = (l->value < r->value);
-                else if (node->op.type == TokenType::LessEqual)
-                    result = (l->value <= r->value);
-                else if (node->op.type == TokenType::Greater)
-                    result = (l->value > r->value);
-                else if (node->op.type == TokenType::GreaterEqual)
-                    result = (l->value >= r->value);
-                return new PyBool(result);
-            }
-        }
-
-        double lv, rv;
-        bool li, ri;
-        if (getNumeric(left, lv, li) && getNumeric(right, rv, ri))
-        {
-            if (node->op.type == TokenType::EqualEqual)
-                result = (lv == rv);
-            else if (node->op.type == TokenType::BangEqual)
-                result = (lv != rv);
-            else if (node->op.type == TokenType::Less)
-                result = (lv < rv);
-            else if (node->op.type == TokenType::LessEqual)
-                result = (lv <= rv);
-            else if (node->op.type == TokenType::Greater)
-                result = (lv > rv);
-            else if (node->op.type == TokenType::GreaterEqual)
-                result = (lv >= rv);
-            return new PyBool(result);
-        }
-
-        if (dynamic_cast<PyNone *>(left) && dynamic_cast<PyNone *>(right))
-        {
-            if (node->op.type == TokenType::EqualEqual)
-                return new PyBool(true);
-            if (node->op.type == TokenType::BangEqual)
-                return new PyBool(false);
-        }
-
-        if (node->op.type == TokenType::EqualEqual)
-            return new PyBool(false);
-        if (node->op.type == TokenType::BangEqual)
-            return new PyBool(true);
-        return new PyBool(false);
+    case ObjectKind::None:
+    case ObjectKind::Bool:
+    case ObjectKind::Int:
+    case ObjectKind::Float:
+    case ObjectKind::Range:
+    case ObjectKind::Array:
+        return true;
+    case ObjectKind::Str:
+        static_cast<PyStr *>(item)->freeze();
+        return true;
+    case ObjectKind::List:
+        if (!seen.insert(item).second)
+            return false;
+        for (PyObject *element : static_cast<PyList *>(item)->items)
+            if (!disjointItem(element, seen))
+                return false;
+        return true;
+    case ObjectKind::Tuple:
+        if (!seen.insert(item).second)
+            return false;
+        for (PyObject *element : *static_cast<PyTuple *>(item))
+            if (!disjointItem(element, seen))
+                return false;
+        return true;
+    case ObjectKind::Dict:
+        if (!seen.insert(item).second)
+            return false;
+        for (auto &entry : static_cast<PyDict *>(item)->items)
+            if (!disjointItem(entry.first, seen) || !disjointItem(entry.second, seen))
+                return false;
+        return true;
+    default:
+        return false;
     }
-
-    return new PyNone();
 }
 
-PyObject *Interpreter::visitUnaryOpNode(UnaryOpNode *node)
+// Context for pool thread `worker` (> 0), warmed with our type feedback
+Interpreter &Interpreter::helper(size_t worker)
 {
-    PyObject *operand = node->operand->accept(this);
-
-    if (node->op.type == TokenType::Not)
-        return new PyBool(!operand->isTruthy());
-
-    if (node->op.type == TokenType::Minus)
+    while (helpers.size() < worker)
     {
-        if (auto v = dynamic_cast<PyInt *>(operand))
-            return new PyInt(-v->value);
-        if (auto v = dynamic_cast<PyFloat *>(operand))
-            return new PyFloat(-v->value);
-        if (auto v = dynamic_cast<PyBool *>(operand))
-            return new PyInt(v->value ? -1 : 0);
+        helperHeaps.push_back(std::make_unique<Heap>());
+        helpers.push_back(std::make_unique<Interpreter>());
     }
-    return new PyNone();
+    Interpreter &context = *helpers[worker - 1];
+    context.profile = profile;
+    context.currentScope = context.globalScope.get();
+    context.inlineArgs.clear();
+    context.inlineBase = 0;
+    context.returnSlots = nullptr;
+    return context;
 }
 
-PyObject *Interpreter::visitAssignNode(AssignNode *node)
+PyObject *Interpreter::parallelMap(PyObject *callee, PyObject *iterable)
 {
-    PyObject *value = node->value->accept(this);
-    currentScope->set(node->name.lexeme, value);
-    return value;
-}
+    std::vector<PyObject *> items;
+    switch (iterable->kind)
+    {
+    case ObjectKind::List:
+        items = static_cast<PyList *>(iterable)->items;
+        break;
+    case ObjectKind::Tuple:
+        items.assign(static_cast<PyTuple *>(iterable)->begin(), static_cast<PyTuple *>(iterable)->end());
+        break;
+    case ObjectKind::Range:
+    {
+        auto range = static_cast<PyRange *>(iterable);
+        for (unsigned long long i = 0; i < range->length(); ++i)
+            items.push_back(new PyInt(range->at(i)));
+        break;
+    }
+    default:
+        throw std::runtime_error("pmap() argument 2 must be a list, tuple or range");
+    }
 
-PyObject *Interpreter::visitPropertyAssignNode(PropertyAssignNode *node)
-{
-    PyObject *obj = node->object->accept(this);
-    PyObject *value = node->value->accept(this);
+    auto result = new PyList();
+    result->items.resize(items.size());
 
-    if (auto instance = dynamic_cast<PyInstance *>(obj))
+    std::unique_lock<std::mutex> poolGuard;
+    if (items.size() > 1 && callee->kind == ObjectKind::Function && !WorkPool::insideTask())
     {
-        // Use non-owning shared_ptr to avoid double-delete
-        std::shared_ptr<PyObject> valuePtr(value, [](PyObject*){});
-        instance->set(node->property, valuePtr);
-        return value;
+        auto func = static_cast<PyFunction *>(callee);
+        std::unordered_map<PyFunction *, bool> checked;
+        std::unordered_set<PyObject *> seen;
+        bool parallel = isolatedFunction(func, checked);
+        for (size_t i = 0; parallel && i < items.size(); ++i)
+            parallel = disjointItem(items[i], seen);
+        // A pool already running another session's pmap is not waited for
+        if (parallel)
+            poolGuard = std::unique_lock<std::mutex>(mapPoolLock, std::try_to_lock);
+        if (poolGuard.owns_lock() && mapPool().size() == 1)
+            poolGuard.unlock();
+    }
+    if (!poolGuard.owns_lock())
+    {
+        for (size_t i = 0; i < items.size(); ++i)
+            result->items[i] = callValue(callee, {items[i]});
+        return result;
     }
 
-    throw std::runtime_error("Can only assign properties on instances");
-}
\ No newline at end of file
+    WorkPool &pool = mapPool();
+    for (size_t worker = 1; worker < pool.size(); ++worker)
+        helper(worker);
+    // A few chunks per thread, so stealing can even out uneven items
+    size_t chunks = std::min(items.size(), pool.size() * 4);
+    std::vector<std::exception_ptr> failures(chunks);
+    pool.run(chunks, [&](size_t chunk)
+    {
+        size_t worker = WorkPool::worker();
+        Interpreter &context = worker == 0 ? *this : *helpers[worker - 1];
+        std::optional<Heap::Use> use;
+        if (worker != 0)
+            use.emplace(*helperHeaps[worker - 1]);
+        size_t end = (chunk + 1) * items.size() / chunks;
+        try
+        {
+            for (size_t i = chunk * items.size() / chunks; i < end; ++i)
+                result->items[i] = context.invoke(callee, nullptr, {items[i]}, nullptr);
+        }
+        catch (...)
+        {
+            failures[chunk] = std::current_exception();
+        }
+    });
+    // The error a sequential map would have stopped at
+    for (const std::exception_ptr &failure : failures)
+        if (failure)
+            std::rethrow_exception(failure);
+    return result;
+}
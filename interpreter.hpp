@@ -3,13 +3,76 @@
 #include "ast.hpp"
 #include "pyobject.hpp"
 #include "scope.hpp"
+#include "profile.hpp"
+#include "heap.hpp"
 #include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+// Destination for the values of `a, b = f()`. A `return x, y` of the
+// same arity in f stores x and y here and sets `filled` instead of
+// building a tuple the caller would immediately take apart.
+struct ReturnSlots
+{
+    static constexpr size_t capacity = 8;
+    PyObject *values[capacity];
+    size_t count;
+    bool filled = false;
+};
 
 class Interpreter : public NodeVisitor
 {
 public:
     Interpreter();
+    // Fills the caches a tree keeps for the interpreter (profiling sites
+    // and boxed literals), after which running it never writes to the
+    // tree, so any number of interpreters may run it at once
+    static void prepare(ProgramNode *program);
     void interpret(ProgramNode *program);
+    Profile &getProfile() { return profile; }
+
+    // Host access for the embedding API (embed.hpp)
+    PyObject *callValue(PyObject *callee, const std::vector<PyObject *> &args);
+    void defineGlobal(const std::string &name, PyObject *value);
+    PyObject *findGlobal(const std::string &name) const; // nullptr if unbound
+
+    // Starting many interpreters from one that ran a prelude (see
+    // Session(const Session &)). freezeGlobals() readies the globals to be
+    // copied by any number of threads at once; copyFrom() gives a fresh
+    // interpreter copies of them, and the feedback, in the current heap.
+    void freezeGlobals();
+    void copyFrom(const Interpreter &other);
+
+    // pmap(f, items): f applied to every item, on a shared WorkPool when f
+    // is pure (see isolatedFunction) and sequentially otherwise
+    PyObject *parallelMap(PyObject *callee, PyObject *iterable);
+    // Threads pmap may use, the caller's included; 0, the default, means
+    // one per hardware thread. Takes effect before the first pmap.
+    static void setParallelism(size_t threads);
+
+    // Applies a comparison operator to two native values
+    template <typename T>
+    static bool compare(TokenType op, T a, T b)
+    {
+        switch (op)
+        {
+        case TokenType::EqualEqual:
+            return a == b;
+        case TokenType::BangEqual:
+            return a != b;
+        case TokenType::Less:
+            return a < b;
+        case TokenType::LessEqual:
+            return a <= b;
+        case TokenType::Greater:
+            return a > b;
+        case TokenType::GreaterEqual:
+            return a >= b;
+        default:
+            return false;
+        }
+    }
 
     PyObject *visitProgramNode(ProgramNode *node) override;
     PyObject *visitBlockNode(BlockNode *node) override;
@@ -20,13 +83,17 @@ public:
     PyObject *visitReturnNode(ReturnNode *node) override;
     PyObject *visitIfNode(IfNode *node) override;
     PyObject *visitWhileNode(WhileNode *node) override;
+    PyObject *visitForNode(ForNode *node) override;
     PyObject *visitFunctionNode(FunctionNode *node) override;
     PyObject *visitCallNode(CallNode *node) override;
+    PyObject *visitInlinedCallNode(InlinedCallNode *node) override;
+    PyObject *visitParamNode(ParamNode *node) override;
     PyObject *visitPropertyNode(PropertyNode *node) override;
     PyObject *visitClassNode(ClassNode *node) override;
     PyObject *visitIntNode(IntNode *node) override;
     PyObject *visitFloatNode(FloatNode *node) override;
     PyObject *visitStringNode(StringNode *node) override;
+    PyObject *visitFStringNode(FStringNode *node) override;
     PyObject *visitBooleanNode(BooleanNode *node) override;
     PyObject *visitNullNode(NullNode *node) override;
     PyObject *visitNameNode(NameNode *node) override;
@@ -34,9 +101,85 @@ public:
     PyObject *visitUnaryOpNode(UnaryOpNode *node) override;
     PyObject *visitAssignNode(AssignNode *node) override;
     PyObject *visitPropertyAssignNode(PropertyAssignNode *node) override;
+    PyObject *visitListNode(ListNode *node) override;
+    PyObject *visitDictNode(DictNode *node) override;
+    PyObject *visitSubscriptNode(SubscriptNode *node) override;
+    PyObject *visitSliceNode(SliceNode *node) override;
+    PyObject *visitSubscriptAssignNode(SubscriptAssignNode *node) override;
+    PyObject *visitTupleNode(TupleNode *node) override;
+    PyObject *visitUnpackAssignNode(UnpackAssignNode *node) override;
+    PyObject *visitAugAssignNode(AugAssignNode *node) override;
 
 private:
+    PyObject *evaluateBinaryOp(BinaryOpNode *node);
+    PyObject *applyBinaryOp(BinaryOpNode *node, PyObject *left, PyObject *right);
+    static PyObject *sequenceOp(TokenType op, PyObject *left, PyObject *right);
+    static std::runtime_error unsupportedOperands(const Token &op, PyObject *left, PyObject *right);
+    // Kernel picked by type feedback; nullptr if the operands miss its guard
+    static PyObject *specializedBinaryOp(Specialization kind, TokenType op, PyObject *left, PyObject *right);
+
+    // Native evaluation of subtrees with a proven StaticType
+    long long evalInt(AstNode *node);
+    double evalFloat(AstNode *node);
+    bool evalBool(AstNode *node);
+    // Truth value of a condition as a native bool
+    bool truthy(AstNode *node);
+    static bool comparePrimitive(TokenType op, PyObject *left, PyObject *right, bool &result);
+    long long intOperand(AstNode *node);
+    double numberOperand(AstNode *node);
+
+    // Calls; `slots` is non-null when the caller unpacks the result
+    PyObject *call(CallNode *node, ReturnSlots *slots);
+    PyObject *inlinedCall(InlinedCallNode *node, ReturnSlots *slots);
+    PyObject *invoke(PyObject *callee, PyObject *instance, const std::vector<PyObject *> &args, ReturnSlots *slots);
+    PyObject *runBody(PyFunction *func, ReturnSlots *slots);
+    // Evaluates `value`, filling `slots` directly when it is a tuple
+    // literal or a call that returns one; nullptr once filled
+    PyObject *evaluateInto(AstNode *value, ReturnSlots *slots);
+
+    // For loops
+    bool loopBody(AstNode *body);
+    bool directRange(AstNode *iterable, long long *values, size_t &count);
+    void rangeLoop(ForNode *node, const PyRange &range);
+
+    // Subscripts
+    long long indexOperand(AstNode *node);
+    bool sliceBound(AstNode *node, long long &out); // false if omitted or None
+    PyObject *sliceSequence(PyObject *sequence, SliceNode *slice);
+    PyObject *callListMethod(PyList *list, const std::string &method, const std::vector<AstNode *> &args);
+    PyObject *callDictMethod(PyDict *dict, const std::string &method, const std::vector<AstNode *> &args);
+    void storeItem(PyObject *object, AstNode *index, PyObject *value);
+
+    // Tuples
+    void assignTarget(AstNode *target, PyObject *value);
+
+    // Augmented assignment
+    PyObject *augmentName(AugAssignNode *node);
+    void augmentItem(AugAssignNode *node, PyObject *object, AstNode *index);
+    bool ownsBox(AugAssignNode *node, PyObject *value, const std::string &name);
+    // The last object a reuseBox node stored, by its operation's site
+    PyObject *&boxSlot(AugAssignNode *node);
+    PyObject *inPlaceOp(BinaryOpNode *operation, PyObject *left, PyObject *right);
+
+    // String methods
+    PyObject *callStrMethod(PyStr *str, const std::string &method, const std::vector<AstNode *> &args);
+
+    // Parallel map
+    static bool isolatedFunction(PyFunction *func, std::unordered_map<PyFunction *, bool> &checked);
+    static bool disjointItem(PyObject *item, std::unordered_set<PyObject *> &seen);
+    Interpreter &helper(size_t worker);
+
+    Profile profile;
     std::unique_ptr<Scope> globalScope;
     Scope *currentScope;
     std::shared_ptr<PyObject> lastReturnValue;  // Keep return values alive
+    std::vector<PyObject *> inlineArgs;          // Argument stack for inlined calls
+    size_t inlineBase = 0;                       // First argument of the innermost inlined call
+    ReturnSlots *returnSlots = nullptr;          // Where the running function's `return a, b` goes
+    std::vector<PyObject *> boxes;               // See boxSlot()
+    std::vector<std::unique_ptr<Scope>> classScopes; // Closures of the methods defined so far
+    // pmap worker contexts, one per pool thread but the caller's, and the
+    // heaps their results live in; kept for the interpreter's lifetime
+    std::vector<std::unique_ptr<Heap>> helperHeaps;
+    std::vector<std::unique_ptr<Interpreter>> helpers;
 };
\ No newline at end of file
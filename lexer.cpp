@@ -28,6 +28,8 @@ Lexer::Lexer(const std::string &source) : source(source), current(0), start(0),
     keywords["elif"] = TokenType::Elif;
     keywords["else"] = TokenType::Else;
     keywords["while"] = TokenType::While;
+    keywords["for"] = TokenType::For;
+    keywords["in"] = TokenType::In;
     keywords["break"] = TokenType::Break;
     keywords["continue"] = TokenType::Continue;
     keywords["def"] = TokenType::Def;
@@ -95,27 +97,44 @@ void Lexer::addToken(TokenType type, const std::string &lexeme)
     tokens.push_back(Token(type, lexeme, line));
 }
 
+// The lexeme keeps any '_' separators; numconv.hpp parses them
 void Lexer::handleNumber()
 {
-    while (isDigit(peek()))
-        advance();
+    auto digits = [this]()
+    {
+        while (isDigit(peek()) || (peek() == '_' && isDigit(peekNext())))
+            advance();
+    };
+    digits();
+    bool isFloat = false;
 
     // Look for decimal part
     if (peek() == '.' && isDigit(peekNext()))
     {
         advance(); // consume '.'
-        while (isDigit(peek()))
-            advance();
-        addToken(TokenType::Float);
+        digits();
+        isFloat = true;
     }
-    else
+
+    // Exponent: e or E, an optional sign and at least one digit
+    if (peek() == 'e' || peek() == 'E')
     {
-        addToken(TokenType::Int);
+        size_t first = current + 1;
+        if (first < source.size() && (source[first] == '+' || source[first] == '-'))
+            first++;
+        if (first < source.size() && isDigit(source[first]))
+        {
+            current = first;
+            digits();
+            isFloat = true;
+        }
     }
+    addToken(isFloat ? TokenType::Float : TokenType::Int);
 }
 
-void Lexer::handleString(char quoteType)
+void Lexer::handleString(char quoteType, bool formatted)
 {
+    size_t open = current; // Just past the opening quote
     while (peek() != quoteType && !isAtEnd())
     {
         if (peek() == '\n')
@@ -131,8 +150,97 @@ void Lexer::handleString(char quoteType)
     advance(); // closing quote
 
     // Extract content without quotes
-    std::string value = source.substr(start + 1, current - start - 2);
-    addToken(TokenType::String, value);
+    std::string value = source.substr(open, current - open - 1);
+    if (formatted)
+        addFormatSegments(value);
+    else
+        addToken(TokenType::String, value);
+}
+
+// Splits the body of an f-string into the token sequence described in
+// tokentype.hpp. Each field's expression is lexed by a nested Lexer, so
+// the parser sees ordinary expression tokens.
+void Lexer::addFormatSegments(const std::string &body)
+{
+    std::string where = " in f-string at line " + std::to_string(line);
+    addToken(TokenType::FStringStart, "");
+    std::string text;
+    size_t i = 0;
+    while (i < body.size())
+    {
+        char c = body[i];
+        if ((c == '{' || c == '}') && i + 1 < body.size() && body[i + 1] == c)
+        {
+            text += c; // {{ and }} stand for single braces
+            i += 2;
+            continue;
+        }
+        if (c == '}')
+            throw std::runtime_error("Single '}'" + where);
+        if (c != '{')
+        {
+            text += c;
+            ++i;
+            continue;
+        }
+        if (!text.empty())
+            addToken(TokenType::FStringText, text);
+        text.clear();
+
+        // The expression ends at the first '}', ':' or '!' (but not '!=')
+        // outside brackets and string literals
+        size_t expressionStart = ++i;
+        int depth = 0;
+        char quote = 0;
+        for (; i < body.size(); ++i)
+        {
+            char d = body[i];
+            if (quote)
+            {
+                if (d == quote)
+                    quote = 0;
+            }
+            else if (d == '\'' || d == '"')
+                quote = d;
+            else if (d == '(' || d == '[' || d == '{')
+                depth++;
+            else if (depth > 0 && (d == ')' || d == ']' || d == '}'))
+                depth--;
+            else if (depth == 0 && (d == '}' || d == ':' || (d == '!' && i + 1 < body.size() && body[i + 1] != '=')))
+                break;
+        }
+        if (i >= body.size())
+            throw std::runtime_error("Unterminated replacement field" + where);
+        std::string expression = body.substr(expressionStart, i - expressionStart);
+        if (expression.find_first_not_of(" \t") == std::string::npos)
+            throw std::runtime_error("Empty expression" + where);
+
+        addToken(TokenType::FStringField, expression);
+        Lexer inner(expression);
+        for (const Token &token : inner.scanTokens())
+            if (token.type != TokenType::EndOfFile)
+                tokens.push_back(Token(token.type, token.lexeme, line));
+
+        if (body[i] == '!')
+        {
+            char conversion = i + 1 < body.size() ? body[i + 1] : '\0';
+            if (conversion != 'r' && conversion != 's' && conversion != 'a')
+                throw std::runtime_error("Invalid conversion character" + where);
+            addToken(TokenType::FStringConversion, std::string(1, conversion));
+            i += 2;
+        }
+        size_t specStart = i < body.size() && body[i] == ':' ? i + 1 : i;
+        for (i = specStart; i < body.size() && body[i] != '}'; ++i)
+            if (body[i] == '{')
+                throw std::runtime_error("Nested replacement fields in format specs are not supported" + where);
+        if (i >= body.size())
+            throw std::runtime_error("Unterminated replacement field" + where);
+        addToken(TokenType::FStringSpec, body.substr(specStart, i - specStart));
+        ++i; // '}'
+    }
+    if (!text.empty())
+        addToken(TokenType::FStringText, text);
+    addToken(TokenType::FStringEnd, "");
 }
 
 void Lexer::handleIndentation()
@@ -188,6 +296,11 @@ void Lexer::handleIdentifier()
         advance();
 
     std::string text = source.substr(start, current - start);
+    if ((text == "f" || text == "F") && (peek() == '"' || peek() == '\''))
+    {
+        handleString(advance(), true);
+        return;
+    }
 
     auto it = keywords.find(text);
     if (it != keywords.end())
@@ -207,11 +320,29 @@ void Lexer::scanToken()
     switch (c)
     {
     case '(':
+        nesting++;
         addToken(TokenType::LeftParen);
         break;
     case ')':
+        nesting--;
         addToken(TokenType::RightParen);
         break;
+    case '[':
+        nesting++;
+        addToken(TokenType::LeftBracket);
+        break;
+    case ']':
+        nesting--;
+        addToken(TokenType::RightBracket);
+        break;
+    case '{':
+        nesting++;
+        addToken(TokenType::LeftBrace);
+        break;
+    case '}':
+        nesting--;
+        addToken(TokenType::RightBrace);
+        break;
     case ',':
         addToken(TokenType::Comma);
         break;
@@ -223,20 +354,26 @@ void Lexer::scanToken()
         break;
 
     case '+':
-        addToken(TokenType::Plus);
+        addToken(match('=') ? TokenType::PlusEqual : TokenType::Plus);
         break;
     case '-':
-        addToken(TokenType::Minus);
+        addToken(match('=') ? TokenType::MinusEqual : TokenType::Minus);
         break;
     case '%':
-        addToken(TokenType::Mod);
+        addToken(match('=') ? TokenType::ModEqual : TokenType::Mod);
         break;
 
     case '*':
-        addToken(match('*') ? TokenType::DoubleStar : TokenType::Star);
+        if (match('*'))
+            addToken(match('=') ? TokenType::DoubleStarEqual : TokenType::DoubleStar);
+        else
+            addToken(match('=') ? TokenType::StarEqual : TokenType::Star);
         break;
     case '/':
-        addToken(match('/') ? TokenType::DoubleSlash : TokenType::Slash);
+        if (match('/'))
+            addToken(match('=') ? TokenType::DoubleSlashEqual : TokenType::DoubleSlash);
+        else
+            addToken(match('=') ? TokenType::SlashEqual : TokenType::Slash);
         break;
 
     case '=':
@@ -248,7 +385,7 @@ void Lexer::scanToken()
         break;
     case '<':
         if (match('<'))
-            addToken(TokenType::LeftShift);
+            addToken(match('=') ? TokenType::LeftShiftEqual : TokenType::LeftShift);
         else if (match('='))
             addToken(TokenType::LessEqual);
         else
@@ -256,7 +393,7 @@ void Lexer::scanToken()
         break;
     case '>':
         if (match('>'))
-            addToken(TokenType::RightShift);
+            addToken(match('=') ? TokenType::RightShiftEqual : TokenType::RightShift);
         else if (match('='))
             addToken(TokenType::GreaterEqual);
         else
@@ -264,13 +401,13 @@ void Lexer::scanToken()
         break;
 
     case '|':
-        addToken(TokenType::Pipe);
+        addToken(match('=') ? TokenType::PipeEqual : TokenType::Pipe);
         break;
     case '&':
-        addToken(TokenType::Ampersand);
+        addToken(match('=') ? TokenType::AmpersandEqual : TokenType::Ampersand);
         break;
     case '^':
-        addToken(TokenType::Caret);
+        addToken(match('=') ? TokenType::CaretEqual : TokenType::Caret);
         break;
     case '~':
         addToken(TokenType::Tilde);
@@ -287,7 +424,10 @@ void Lexer::scanToken()
         break;
 
     case '\n':
-        handleNewline();
+        if (nesting > 0)
+            line++;
+        else
+            handleNewline();
         break;
 
     case '"':
@@ -15,7 +15,8 @@ public:
 private:
     void scanToken();
     void handleNumber();
-    void handleString(char quoteType);
+    void handleString(char quoteType, bool formatted = false);
+    void addFormatSegments(const std::string &body);
     void handleIdentifier();
     void handleIndentation();
     void handleNewline();
@@ -34,5 +35,6 @@ private:
     size_t start = 0;
     size_t current = 0;
     int line = 1;
+    int nesting = 0; // Open brackets; newlines inside them are not significant
     std::stack<int> indentLevels;
 };
\ No newline at end of file
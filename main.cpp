@@ -1,52 +1,183 @@
 #include <iostream>
-#include <fstream>
 #include <string>
-#include "lexer.hpp"
-#include "parser.hpp"
-#include "interpreter.hpp"
+#include <vector>
+#include "embed.hpp"
+#include "astprinter.hpp"
+#include "batch.hpp"
+#include "server.hpp"
+#include "output.hpp"
+
+static void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program
+              << " [-O0|-O1|-O2] [--dump-ast] [--inline-threshold=N] [--verbose] [--profile=path] [--unbuffered] [--threads=N] [filename].py\n"
+              << "       " << program
+              << " --jobs=N [-O0|-O1|-O2] [--inline-threshold=N] [--manifest=path] [filename].py...\n"
+              << "       " << program
+              << " --serve=socket [-O0|-O1|-O2] [--inline-threshold=N] [--verbose] [--prelude=path] [--zygote]\n";
+}
 
 int main(int argc, char *argv[])
 {
-    if (argc != 2)
+    OptimizerOptions options;
+    bool dumpAst = false;
+    std::string profilePath;
+    std::vector<std::string> filenames;
+    bool batch = false;
+    size_t jobs = 0;
+    std::string manifestPath;
+    std::string socketPath;
+    std::string preludePath;
+    bool zygote = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-O0" || arg == "-O1" || arg == "-O2")
+            options.level = arg[2] - '0';
+        else if (arg == "--dump-ast")
+            dumpAst = true;
+        else if (arg.rfind("--inline-threshold=", 0) == 0)
+            options.inlineThreshold = std::stoul(arg.substr(19));
+        else if (arg == "--verbose")
+            options.verbose = true;
+        else if (arg.rfind("--profile=", 0) == 0)
+            profilePath = arg.substr(10);
+        else if (arg == "--unbuffered")
+            Output::setStandardMode(Output::Mode::Unbuffered);
+        else if (arg.rfind("--jobs=", 0) == 0 || (arg == "--jobs" && i + 1 < argc))
+        {
+            batch = true;
+            jobs = std::stoul(arg == "--jobs" ? argv[++i] : arg.substr(7));
+        }
+        else if (arg.rfind("--threads=", 0) == 0)
+            Interpreter::setParallelism(std::stoul(arg.substr(10)));
+        else if (arg.rfind("--serve=", 0) == 0 || (arg == "--serve" && i + 1 < argc))
+            socketPath = arg == "--serve" ? argv[++i] : arg.substr(8);
+        else if (arg.rfind("--prelude=", 0) == 0)
+            preludePath = arg.substr(10);
+        else if (arg == "--zygote")
+            zygote = true;
+        else if (arg.rfind("--manifest=", 0) == 0)
+        {
+            batch = true;
+            manifestPath = arg.substr(11);
+        }
+        else if (arg[0] != '-')
+            filenames.push_back(arg);
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!socketPath.empty())
     {
-        std::cerr << "Usage: " << argv[0] << " [filename].py\n";
+        if (batch || dumpAst || !profilePath.empty() || !filenames.empty())
+        {
+            std::cerr << "--serve takes its scripts from the socket; it runs no files, --jobs, --dump-ast or --profile\n";
+            return 1;
+        }
+        try
+        {
+            ServerOptions server;
+            server.socketPath = socketPath;
+            server.preludePath = preludePath;
+            server.optimizer = options;
+            server.zygote = zygote;
+            // Forking needs a single-threaded process: no pmap pool threads
+            if (zygote)
+                Interpreter::setParallelism(1);
+            serve(server);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
         return 1;
     }
 
-    const char *filename = argv[1];
-    std::ifstream inputFile(filename);
+    if (batch)
+    {
+        if (dumpAst || !profilePath.empty())
+        {
+            std::cerr << "--dump-ast and --profile take a single script, not --jobs\n";
+            return 1;
+        }
+        try
+        {
+            if (!manifestPath.empty())
+            {
+                std::vector<std::string> listed = readManifest(manifestPath);
+                filenames.insert(filenames.end(), listed.begin(), listed.end());
+            }
+            if (filenames.empty())
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            return runBatch(filenames, options, jobs);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
 
-    if (!inputFile)
+    if (filenames.size() != 1)
     {
-        std::cerr << "Error: could not open file '" << filename << "'\n";
+        printUsage(argv[0]);
         return 1;
     }
 
-    // Read entire file into a string using iterator trick
-    std::string source((std::istreambuf_iterator<char>(inputFile)), {});
-
     try
     {
-        // Lexing
-        Lexer lexer(source);
-        std::vector<Token> tokens = lexer.scanTokens();
-
-        // Parsing
-        Parser parser(tokens);
-        ProgramNode *program = parser.parse();
+        std::shared_ptr<Program> program = Program::compileFile(filenames[0], options);
 
-        // Interpreting
-        Interpreter interpreter;
-        interpreter.interpret(program);
+        if (dumpAst)
+        {
+            AstPrinter printer(std::cout);
+            printer.print(program->root());
+            return 0;
+        }
 
-        // Cleanup
-        delete program;
+        // Running, warmed up by the feedback of earlier runs if any
+        Session session(program);
+        Profile &profile = session.profile();
+        uint64_t profileKey = Profile::makeKey(program->source(), options.level, options.inlineThreshold);
+        if (!profilePath.empty())
+        {
+            profile.attach(program->root());
+            bool loaded = profile.load(profilePath, profileKey);
+            if (options.verbose)
+            {
+                if (loaded)
+                    std::cerr << "[profile] loaded " << profilePath << " ("
+                              << profile.specializedSites() << " sites pre-specialized)\n";
+                else
+                    std::cerr << "[profile] no usable profile at " << profilePath << ", starting cold\n";
+            }
+        }
+        session.run();
+        if (!profilePath.empty())
+            profile.save(profilePath, profileKey);
     }
     catch (const std::exception &e)
     {
+        // Whatever the program printed comes before the error
+        try
+        {
+            Output::standard().flush();
+        }
+        catch (const std::exception &)
+        {
+            // stdout is gone; the error still goes to stderr
+        }
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
 
     return 0;
-}
\ No newline at end of file
+}
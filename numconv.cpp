@@ -0,0 +1,111 @@
+#include "numconv.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+
+char *writeInt(char *first, long long value)
+{
+    return std::to_chars(first, first + maxNumberChars, value).ptr;
+}
+
+char *writeFloat(char *first, double value)
+{
+    char *last = first + maxNumberChars;
+    if (std::isnan(value))
+        return std::copy_n("nan", 3, first);
+
+    // The shortest round-trip digits, in scientific form to learn the
+    // exponent; Python switches to that form outside 1e-4 <= |x| < 1e16
+    char *end = std::to_chars(first, last, value, std::chars_format::scientific).ptr;
+    if (std::isinf(value))
+        return end;
+    const char *exponentSign = std::find(first, end, 'e') + 1;
+    int exponent = 0;
+    std::from_chars(exponentSign + (*exponentSign == '+'), end, exponent);
+    if (exponent < -4 || exponent >= 16)
+        return end;
+
+    // Fixed notation with the same shortest digits, plus ".0" for whole
+    // numbers so the result still reads as a float
+    end = std::to_chars(first, last, value, std::chars_format::fixed).ptr;
+    if (std::find(first, end, '.') == end)
+    {
+        *end++ = '.';
+        *end++ = '0';
+    }
+    return end;
+}
+
+std::string intToString(long long value)
+{
+    char buffer[maxNumberChars];
+    return std::string(buffer, writeInt(buffer, value));
+}
+
+std::string floatToString(double value)
+{
+    char buffer[maxNumberChars];
+    return std::string(buffer, writeFloat(buffer, value));
+}
+
+bool stripSeparators(std::string_view text, std::string &out)
+{
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+    out.clear();
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] != '_')
+            out += text[i];
+        else if (i == 0 || i + 1 == text.size() || !isDigit(text[i - 1]) || !isDigit(text[i + 1]))
+            return false;
+    }
+    return true;
+}
+
+// Strips separators (into `stripped`) and a leading '+'; false if what is
+// left cannot start a number
+static bool prepare(std::string_view &text, std::string &stripped)
+{
+    if (text.find('_') != std::string_view::npos)
+    {
+        if (!stripSeparators(text, stripped))
+            return false;
+        text = stripped;
+    }
+    if (!text.empty() && text[0] == '+')
+        text.remove_prefix(1);
+    return !text.empty() && text[0] != '+' && text[0] != '_';
+}
+
+ParseResult parseInt(std::string_view text, long long &out)
+{
+    std::string stripped;
+    if (!prepare(text, stripped))
+        return ParseResult::Invalid;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), out);
+    if (end != text.data() + text.size())
+        return ParseResult::Invalid;
+    if (error == std::errc::result_out_of_range)
+        return ParseResult::Overflow;
+    return error == std::errc() ? ParseResult::Ok : ParseResult::Invalid;
+}
+
+ParseResult parseFloat(std::string_view text, double &out)
+{
+    std::string stripped;
+    if (!prepare(text, stripped))
+        return ParseResult::Invalid;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), out);
+    if (end != text.data() + text.size())
+        return ParseResult::Invalid;
+    // Like Python, a literal too large is infinite and one too small is
+    // zero; from_chars leaves those to the caller, and strtod gets them
+    // right
+    if (error == std::errc::result_out_of_range)
+    {
+        out = std::strtod(std::string(text).c_str(), nullptr);
+        return ParseResult::Ok;
+    }
+    return error == std::errc() ? ParseResult::Ok : ParseResult::Invalid;
+}
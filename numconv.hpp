@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// ==================== Numeric Conversion ====================
+// Number <-> text conversions built on std::from_chars/std::to_chars:
+// no locale, no exceptions on bad input and no temporary strings. Floats
+// are written the way Python's repr() writes them, with the shortest
+// digits that read back as the same double.
+
+// Room for any int64 or float this layer writes
+constexpr size_t maxNumberChars = 32;
+
+// Both return the end of the text written at `first`, which must have
+// room for maxNumberChars
+char *writeInt(char *first, long long value);
+// Fixed notation for exponents -4..15 (always with a '.'), otherwise
+// d.ddde+XX; "inf", "-inf" and "nan"
+char *writeFloat(char *first, double value);
+
+std::string intToString(long long value);
+std::string floatToString(double value);
+
+enum class ParseResult
+{
+    Ok,
+    Overflow, // A valid integer outside the int64 range
+    Invalid
+};
+
+// The whole of `text` must be the number. An optional sign is allowed,
+// and so are '_' separators between digits. parseFloat also accepts an
+// exponent and inf/nan. Surrounding whitespace is the caller's business.
+ParseResult parseInt(std::string_view text, long long &out);
+ParseResult parseFloat(std::string_view text, double &out);
+// `text` without its '_' separators, for digits bound for BigInt; false
+// if a separator is not between two digits
+bool stripSeparators(std::string_view text, std::string &out);
@@ -0,0 +1,1072 @@
+#include "optimizer.hpp"
+#include "interpreter.hpp"
+#include "typeinfer.hpp"
+#include "numconv.hpp"
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+
+// ==================== Helpers ====================
+static bool isLiteral(AstNode *node)
+{
+    switch (node->type)
+    {
+    case AstNodeType::Int:
+    case AstNodeType::Float:
+    case AstNodeType::String:
+    case AstNodeType::Boolean:
+    case AstNodeType::Null:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Value of an int literal; false if it needs a BigInt
+static bool smallIntLiteral(AstNode *node, long long &out)
+{
+    return parseInt(static_cast<IntNode *>(node)->value.lexeme, out) == ParseResult::Ok;
+}
+
+// Value of an int or float literal as a double
+static double numberLiteral(AstNode *node)
+{
+    double value = 0;
+    parseFloat(node->type == AstNodeType::Int ? static_cast<IntNode *>(node)->value.lexeme
+                                              : static_cast<FloatNode *>(node)->value.lexeme,
+               value);
+    return value;
+}
+
+// Truthiness of a literal node, mirroring PyObject::isTruthy()
+static bool literalTruthiness(AstNode *node, bool &out)
+{
+    switch (node->type)
+    {
+    case AstNodeType::Int:
+    {
+        long long value;
+        out = !smallIntLiteral(node, value) || value != 0; // Big literals are never zero
+        return true;
+    }
+    case AstNodeType::Float:
+        out = numberLiteral(node) != 0.0;
+        return true;
+    case AstNodeType::String:
+        out = !static_cast<StringNode *>(node)->value.lexeme.empty();
+        return true;
+    case AstNodeType::Boolean:
+        out = static_cast<BooleanNode *>(node)->value.type == TokenType::True;
+        return true;
+    case AstNodeType::Null:
+        out = false;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool isIntLiteral(AstNode *node, long long expected)
+{
+    long long value;
+    return node->type == AstNodeType::Int && smallIntLiteral(node, value) && value == expected;
+}
+
+// Whether TypeInferencePass proved the node to be a PyInt or PyFloat.
+// Arithmetic on such operands never reaches a user-defined magic method.
+static bool isProvenNumber(AstNode *node)
+{
+    return node->staticType == StaticType::Int || node->staticType == StaticType::Float;
+}
+
+static AstNode *makeBoolean(bool value, int line)
+{
+    return new BooleanNode(value ? Token(TokenType::True, "True", line)
+                                 : Token(TokenType::False, "False", line));
+}
+
+// The shortest text that reads back as `value`
+static AstNode *makeFloat(double value, int line)
+{
+    return new FloatNode(Token(TokenType::Float, floatToString(value), line));
+}
+
+// Names and literals can be duplicated without changing evaluation
+static AstNode *cloneTrivial(AstNode *node)
+{
+    switch (node->type)
+    {
+    case AstNodeType::Name:
+        return new NameNode(static_cast<NameNode *>(node)->name);
+    case AstNodeType::Int:
+        return new IntNode(static_cast<IntNode *>(node)->value);
+    case AstNodeType::Float:
+        return new FloatNode(static_cast<FloatNode *>(node)->value);
+    default:
+        return nullptr;
+    }
+}
+
+// Deep copy of an expression built from literals, names, operators,
+// property reads, indexing and tuples. Names listed in `params` become
+// ParamNodes. Returns nullptr for anything else.
+static AstNode *cloneExpression(AstNode *node, const std::vector<std::string> *params)
+{
+    switch (node->type)
+    {
+    case AstNodeType::Name:
+        if (params)
+        {
+            const std::string &name = static_cast<NameNode *>(node)->name.lexeme;
+            for (size_t i = 0; i < params->size(); ++i)
+                if ((*params)[i] == name)
+                    return new ParamNode(i, name);
+        }
+        return cloneTrivial(node);
+    case AstNodeType::Int:
+    case AstNodeType::Float:
+        return cloneTrivial(node);
+    case AstNodeType::String:
+        return new StringNode(static_cast<StringNode *>(node)->value);
+    case AstNodeType::Boolean:
+        return new BooleanNode(static_cast<BooleanNode *>(node)->value);
+    case AstNodeType::Null:
+        return new NullNode();
+    case AstNodeType::BinaryOp:
+    {
+        auto binary = static_cast<BinaryOpNode *>(node);
+        AstNode *left = cloneExpression(binary->left, params);
+        AstNode *right = cloneExpression(binary->right, params);
+        if (!left || !right)
+            return nullptr;
+        return new BinaryOpNode(left, binary->op, right);
+    }
+    case AstNodeType::UnaryOp:
+    {
+        auto unary = static_cast<UnaryOpNode *>(node);
+        AstNode *operand = cloneExpression(unary->operand, params);
+        return operand ? new UnaryOpNode(unary->op, operand) : nullptr;
+    }
+    case AstNodeType::Property:
+    {
+        auto prop = static_cast<PropertyNode *>(node);
+        AstNode *object = cloneExpression(prop->object, params);
+        return object ? new PropertyNode(object, prop->property) : nullptr;
+    }
+    case AstNodeType::Subscript:
+    {
+        auto subscript = static_cast<SubscriptNode *>(node);
+        if (subscript->index->type == AstNodeType::Slice)
+            return nullptr;
+        AstNode *object = cloneExpression(subscript->object, params);
+        AstNode *index = cloneExpression(subscript->index, params);
+        if (!object || !index)
+            return nullptr;
+        return new SubscriptNode(object, index);
+    }
+    case AstNodeType::Tuple:
+    {
+        std::vector<AstNode *> elements;
+        for (AstNode *element : static_cast<TupleNode *>(node)->elements)
+        {
+            AstNode *copy = cloneExpression(element, params);
+            if (!copy)
+                return nullptr;
+            elements.push_back(copy);
+        }
+        return new TupleNode(elements);
+    }
+    default:
+        return nullptr;
+    }
+}
+
+// ==================== AstRewriter ====================
+AstNode *AstRewriter::rewrite(AstNode *node)
+{
+    if (!node)
+        return nullptr;
+
+    switch (node->type)
+    {
+    case AstNodeType::Program:
+    {
+        auto program = static_cast<ProgramNode *>(node);
+        for (AstNode *&stmt : program->statements)
+            stmt = rewrite(stmt);
+        break;
+    }
+    case AstNodeType::Block:
+    {
+        auto block = static_cast<BlockNode *>(node);
+        for (AstNode *&stmt : block->statements)
+            stmt = rewrite(stmt);
+        break;
+    }
+    case AstNodeType::Print:
+    {
+        auto print = static_cast<PrintNode *>(node);
+        print->expression = rewrite(print->expression);
+        break;
+    }
+    case AstNodeType::Return:
+    {
+        auto ret = static_cast<ReturnNode *>(node);
+        ret->value = rewrite(ret->value);
+        break;
+    }
+    case AstNodeType::If:
+    {
+        auto ifNode = static_cast<IfNode *>(node);
+        ifNode->condition = rewrite(ifNode->condition);
+        ifNode->thenBranch = rewrite(ifNode->thenBranch);
+        for (auto &elifPair : ifNode->elifBranches)
+        {
+            elifPair.first = rewrite(elifPair.first);
+            elifPair.second = rewrite(elifPair.second);
+        }
+        ifNode->elseBranch = rewrite(ifNode->elseBranch);
+        break;
+    }
+    case AstNodeType::While:
+    {
+        auto whileNode = static_cast<WhileNode *>(node);
+        whileNode->condition = rewrite(whileNode->condition);
+        whileNode->body = rewrite(whileNode->body);
+        break;
+    }
+    case AstNodeType::For:
+    {
+        auto forNode = static_cast<ForNode *>(node);
+        forNode->iterable = rewrite(forNode->iterable);
+        forNode->body = rewrite(forNode->body);
+        break;
+    }
+    case AstNodeType::Function:
+    {
+        auto func = static_cast<FunctionNode *>(node);
+        func->body = rewrite(func->body);
+        break;
+    }
+    case AstNodeType::Class:
+    {
+        auto klass = static_cast<ClassNode *>(node);
+        klass->body = rewrite(klass->body);
+        break;
+    }
+    case AstNodeType::Call:
+    {
+        auto call = static_cast<CallNode *>(node);
+        call->callee = rewrite(call->callee);
+        for (AstNode *&arg : call->args)
+            arg = rewrite(arg);
+        break;
+    }
+    case AstNodeType::InlinedCall:
+    {
+        // The fallback call's operands are rewritten in place; the call
+        // itself must stay a plain CallNode
+        auto inlined = static_cast<InlinedCallNode *>(node);
+        inlined->call->callee = rewrite(inlined->call->callee);
+        for (AstNode *&arg : inlined->call->args)
+            arg = rewrite(arg);
+        inlined->inlined = rewrite(inlined->inlined);
+        break;
+    }
+    case AstNodeType::Property:
+    {
+        auto prop = static_cast<PropertyNode *>(node);
+        prop->object = rewrite(prop->object);
+        break;
+    }
+    case AstNodeType::BinaryOp:
+    {
+        auto binary = static_cast<BinaryOpNode *>(node);
+        binary->left = rewrite(binary->left);
+        binary->right = rewrite(binary->right);
+        break;
+    }
+    case AstNodeType::UnaryOp:
+    {
+        auto unary = static_cast<UnaryOpNode *>(node);
+        unary->operand = rewrite(unary->operand);
+        break;
+    }
+    case AstNodeType::Assign:
+    {
+        auto assign = static_cast<AssignNode *>(node);
+        assign->value = rewrite(assign->value);
+        break;
+    }
+    case AstNodeType::PropertyAssign:
+    {
+        auto assign = static_cast<PropertyAssignNode *>(node);
+        assign->object = rewrite(assign->object);
+        assign->value = rewrite(assign->value);
+        break;
+    }
+    case AstNodeType::List:
+    {
+        auto list = static_cast<ListNode *>(node);
+        for (AstNode *&element : list->elements)
+            element = rewrite(element);
+        break;
+    }
+    case AstNodeType::FString:
+        for (FStringSegment &segment : static_cast<FStringNode *>(node)->segments)
+            if (segment.expression)
+                segment.expression = rewrite(segment.expression);
+        break;
+    case AstNodeType::Dict:
+    {
+        auto dict = static_cast<DictNode *>(node);
+        for (size_t i = 0; i < dict->keys.size(); ++i)
+        {
+            dict->keys[i] = rewrite(dict->keys[i]);
+            dict->values[i] = rewrite(dict->values[i]);
+        }
+        break;
+    }
+    case AstNodeType::Subscript:
+    {
+        auto subscript = static_cast<SubscriptNode *>(node);
+        subscript->object = rewrite(subscript->object);
+        subscript->index = rewrite(subscript->index);
+        break;
+    }
+    case AstNodeType::Slice:
+    {
+        auto slice = static_cast<SliceNode *>(node);
+        slice->start = rewrite(slice->start);
+        slice->stop = rewrite(slice->stop);
+        slice->step = rewrite(slice->step);
+        break;
+    }
+    case AstNodeType::SubscriptAssign:
+    {
+        auto assign = static_cast<SubscriptAssignNode *>(node);
+        assign->object = rewrite(assign->object);
+        assign->index = rewrite(assign->index);
+        assign->value = rewrite(assign->value);
+        break;
+    }
+    case AstNodeType::Tuple:
+    {
+        auto tuple = static_cast<TupleNode *>(node);
+        for (AstNode *&element : tuple->elements)
+            element = rewrite(element);
+        break;
+    }
+    case AstNodeType::UnpackAssign:
+    {
+        // Targets stay targets; only the expressions inside them change
+        auto unpack = static_cast<UnpackAssignNode *>(node);
+        unpack->value = rewrite(unpack->value);
+        for (AstNode *target : unpack->targets)
+            rewriteTarget(target);
+        break;
+    }
+    case AstNodeType::AugAssign:
+    {
+        // The operation itself is never replaced: its left operand must
+        // stay the target
+        auto aug = static_cast<AugAssignNode *>(node);
+        rewriteTarget(aug->target);
+        aug->operation->right = rewrite(aug->operation->right);
+        break;
+    }
+    default:
+        break;
+    }
+
+    AstNode *result = transform(node);
+    if (result != node)
+        changed = true;
+    return result;
+}
+
+// Rewrites the expressions inside an assignment target, leaving the
+// target node in place
+void AstRewriter::rewriteTarget(AstNode *target)
+{
+    if (target->type == AstNodeType::Property)
+    {
+        auto prop = static_cast<PropertyNode *>(target);
+        prop->object = rewrite(prop->object);
+    }
+    else if (target->type == AstNodeType::Subscript)
+    {
+        auto subscript = static_cast<SubscriptNode *>(target);
+        subscript->object = rewrite(subscript->object);
+        subscript->index = rewrite(subscript->index);
+    }
+}
+
+bool AstRewriter::rewriteProgram(ProgramNode *program)
+{
+    changed = false;
+    rewrite(program);
+    return changed;
+}
+
+// ==================== Constant Folding ====================
+// Literal subtrees are evaluated with the interpreter itself so folded
+// results are bit-for-bit what the unoptimized program would compute.
+class ConstantFoldingPass : public OptimizationPass, private AstRewriter
+{
+public:
+    const char *name() const override { return "constant-folding"; }
+    bool run(ProgramNode *program) override { return rewriteProgram(program); }
+
+private:
+    static constexpr size_t maxFoldedStringLength = 4096;
+    Interpreter evaluator;
+
+    AstNode *transform(AstNode *node) override
+    {
+        if (node->type == AstNodeType::BinaryOp)
+        {
+            auto binary = static_cast<BinaryOpNode *>(node);
+            bool leftTruthy;
+            if (literalTruthiness(binary->left, leftTruthy))
+            {
+                // Short-circuit operators only need the left operand
+                if (binary->op.type == TokenType::And && !leftTruthy)
+                    return makeBoolean(false, binary->op.line);
+                if (binary->op.type == TokenType::Or && leftTruthy)
+                    return makeBoolean(true, binary->op.line);
+            }
+            if (isLiteral(binary->left) && isLiteral(binary->right))
+                return fold(node, binary->op.line);
+        }
+        else if (node->type == AstNodeType::UnaryOp)
+        {
+            auto unary = static_cast<UnaryOpNode *>(node);
+            if (isLiteral(unary->operand))
+                return fold(node, unary->op.line);
+        }
+        return node;
+    }
+
+    AstNode *fold(AstNode *node, int line)
+    {
+        PyObject *value;
+        try
+        {
+            value = node->accept(&evaluator);
+        }
+        catch (const std::exception &)
+        {
+            return node; // leave the error for runtime
+        }
+
+        if (auto v = dynamic_cast<PyBool *>(value))
+            return makeBoolean(v->value, line);
+        if (auto v = dynamic_cast<PyInt *>(value))
+        {
+            std::string digits = v->toString();
+            if (digits.size() > maxFoldedStringLength)
+                return node;
+            return new IntNode(Token(TokenType::Int, digits, line));
+        }
+        if (auto v = dynamic_cast<PyFloat *>(value))
+            return makeFloat(v->value, line);
+        if (auto v = dynamic_cast<PyStr *>(value))
+        {
+            if (v->size() > maxFoldedStringLength)
+                return node;
+            return new StringNode(Token(TokenType::String, v->toString(), line));
+        }
+        if (dynamic_cast<PyNone *>(value))
+            return new NullNode();
+        return node;
+    }
+};
+
+// ==================== Dead Branch Elimination ====================
+class DeadBranchEliminationPass : public OptimizationPass, private AstRewriter
+{
+public:
+    const char *name() const override { return "dead-branch-elimination"; }
+    bool run(ProgramNode *program) override { return rewriteProgram(program); }
+
+private:
+    AstNode *transform(AstNode *node) override
+    {
+        switch (node->type)
+        {
+        case AstNodeType::If:
+            return simplifyIf(static_cast<IfNode *>(node));
+        case AstNodeType::While:
+        {
+            auto whileNode = static_cast<WhileNode *>(node);
+            bool truthy;
+            if (literalTruthiness(whileNode->condition, truthy) && !truthy)
+                return new PassNode();
+            return node;
+        }
+        case AstNodeType::Block:
+            trimUnreachable(static_cast<BlockNode *>(node)->statements);
+            return node;
+        default:
+            return node;
+        }
+    }
+
+    AstNode *simplifyIf(IfNode *node)
+    {
+        // Flatten into an ordered list of (condition, body) arms, dropping
+        // arms that can never run and cutting off after one that always does
+        std::vector<std::pair<AstNode *, AstNode *>> arms;
+        arms.push_back({node->condition, node->thenBranch});
+        for (auto &elifPair : node->elifBranches)
+            arms.push_back(elifPair);
+
+        std::vector<std::pair<AstNode *, AstNode *>> live;
+        AstNode *elseBranch = node->elseBranch;
+        bool modified = false;
+        for (auto &arm : arms)
+        {
+            bool truthy;
+            if (!literalTruthiness(arm.first, truthy))
+            {
+                live.push_back(arm);
+                continue;
+            }
+            modified = true;
+            if (truthy)
+            {
+                elseBranch = arm.second;
+                break;
+            }
+        }
+
+        if (!modified)
+            return node;
+        if (live.empty())
+            return elseBranch ? elseBranch : new PassNode();
+
+        std::vector<std::pair<AstNode *, AstNode *>> elifs(live.begin() + 1, live.end());
+        return new IfNode(live[0].first, live[0].second, elifs, elseBranch);
+    }
+
+    void trimUnreachable(std::vector<AstNode *> &statements)
+    {
+        for (size_t i = 0; i < statements.size(); ++i)
+        {
+            AstNodeType type = statements[i]->type;
+            if (type == AstNodeType::Return || type == AstNodeType::Break ||
+                type == AstNodeType::Continue)
+            {
+                if (i + 1 < statements.size())
+                {
+                    statements.resize(i + 1);
+                    changed = true;
+                }
+                return;
+            }
+        }
+    }
+};
+
+// ==================== Algebraic Simplification ====================
+// x + 0, 0 + x, x - 0, x * 1, 1 * x  ->  x
+//
+// Only for x proven int or float; x + 0 only for int, since -0.0 + 0 is
+// 0.0. A bool x is left alone: True * 1 is 1, not True.
+class AlgebraicSimplificationPass : public OptimizationPass, private AstRewriter
+{
+public:
+    const char *name() const override { return "algebraic-simplification"; }
+    bool run(ProgramNode *program) override { return rewriteProgram(program); }
+
+private:
+    AstNode *transform(AstNode *node) override
+    {
+        if (node->type != AstNodeType::BinaryOp)
+            return node;
+
+        auto binary = static_cast<BinaryOpNode *>(node);
+        switch (binary->op.type)
+        {
+        case TokenType::Plus:
+            if (isIntLiteral(binary->right, 0) && binary->left->staticType == StaticType::Int)
+                return binary->left;
+            if (isIntLiteral(binary->left, 0) && binary->right->staticType == StaticType::Int)
+                return binary->right;
+            break;
+        case TokenType::Minus:
+            if (isIntLiteral(binary->right, 0) && isProvenNumber(binary->left))
+                return binary->left;
+            break;
+        case TokenType::Star:
+            if (isIntLiteral(binary->right, 1) && isProvenNumber(binary->left))
+                return binary->left;
+            if (isIntLiteral(binary->left, 1) && isProvenNumber(binary->right))
+                return binary->right;
+            break;
+        default:
+            break;
+        }
+        return node;
+    }
+};
+
+// ==================== Strength Reduction ====================
+// x ** 2  ->  x * x                    (x a name or literal)
+// x / c   ->  x * (1 / c)              (c a power of two, so 1 / c is exact)
+//
+// Only for x proven int or float: an object's __pow__ or __truediv__
+// must not turn into a call to its __mul__.
+class StrengthReductionPass : public OptimizationPass, private AstRewriter
+{
+public:
+    const char *name() const override { return "strength-reduction"; }
+    bool run(ProgramNode *program) override { return rewriteProgram(program); }
+
+private:
+    AstNode *transform(AstNode *node) override
+    {
+        if (node->type != AstNodeType::BinaryOp)
+            return node;
+
+        auto binary = static_cast<BinaryOpNode *>(node);
+        int line = binary->op.line;
+        if (!isProvenNumber(binary->left))
+            return node;
+
+        if (binary->op.type == TokenType::DoubleStar && isIntLiteral(binary->right, 2))
+        {
+            if (AstNode *copy = cloneTrivial(binary->left))
+                return new BinaryOpNode(binary->left, Token(TokenType::Star, "*", line), copy);
+        }
+
+        if (binary->op.type == TokenType::Slash)
+        {
+            if (binary->right->type != AstNodeType::Int && binary->right->type != AstNodeType::Float)
+                return node;
+            double divisor = numberLiteral(binary->right);
+
+            int exponent;
+            if (std::isfinite(divisor) && divisor != 0.0 && std::frexp(divisor, &exponent) == 0.5)
+                return new BinaryOpNode(binary->left, Token(TokenType::Star, "*", line),
+                                        makeFloat(1.0 / divisor, line));
+        }
+        return node;
+    }
+};
+
+// ==================== Loop-Invariant Hoisting ====================
+// Safe expressions whose names are not assigned in a call-free loop are
+// computed once before the loop:
+//
+//     while cond:              if cond:
+//         y = x * k + i    ->      __licm0 = x * k
+//                                  while cond:
+//                                      y = __licm0 + i
+//
+// The guard keeps zero-trip loops from evaluating the hoisted expressions.
+// Only expressions evaluated on every iteration are candidates. A hoisted
+// expression runs ahead of the statements before it in the body, so it
+// must be safe: every operator works on proven numbers, which runs no
+// user code, and cannot raise (no /, //, % or **). The condition, which
+// the guard evaluates once more, needs only the former.
+class LoopInvariantHoistingPass : public OptimizationPass, private AstRewriter
+{
+public:
+    const char *name() const override { return "loop-invariant-hoisting"; }
+    bool run(ProgramNode *program) override { return rewriteProgram(program); }
+
+private:
+    int tempCounter = 0;
+    std::set<std::string> assigned;
+    std::vector<AstNode *> hoisted;
+
+    AstNode *transform(AstNode *node) override
+    {
+        if (node->type != AstNodeType::While)
+            return node;
+
+        auto loop = static_cast<WhileNode *>(node);
+        if (containsCall(loop->condition) || containsCall(loop->body) || !runsNoUserCode(loop->condition))
+            return node;
+
+        assigned.clear();
+        hoisted.clear();
+        collectAssigned(loop->body);
+
+        auto &statements = static_cast<BlockNode *>(loop->body)->statements;
+        for (AstNode *stmt : statements)
+        {
+            hoistFromStatement(stmt);
+            if (containsJump(stmt))
+                break;
+        }
+
+        if (hoisted.empty())
+            return node;
+
+        std::vector<AstNode *> preheader = hoisted;
+        preheader.push_back(loop);
+        return new IfNode(cloneExpression(loop->condition, nullptr), new BlockNode(preheader), {}, nullptr);
+    }
+
+    void hoistFromStatement(AstNode *stmt)
+    {
+        switch (stmt->type)
+        {
+        case AstNodeType::Assign:
+            hoistFromExpression(static_cast<AssignNode *>(stmt)->value);
+            break;
+        case AstNodeType::PropertyAssign:
+            hoistFromExpression(static_cast<PropertyAssignNode *>(stmt)->value);
+            break;
+        case AstNodeType::AugAssign:
+            hoistFromExpression(static_cast<AugAssignNode *>(stmt)->operation->right);
+            break;
+        case AstNodeType::Print:
+            hoistFromExpression(static_cast<PrintNode *>(stmt)->expression);
+            break;
+        case AstNodeType::Return:
+            if (static_cast<ReturnNode *>(stmt)->value)
+                hoistFromExpression(static_cast<ReturnNode *>(stmt)->value);
+            break;
+        case AstNodeType::If:
+            hoistFromExpression(static_cast<IfNode *>(stmt)->condition);
+            break;
+        case AstNodeType::While:
+            hoistFromExpression(static_cast<WhileNode *>(stmt)->condition);
+            break;
+        case AstNodeType::BinaryOp:
+        case AstNodeType::UnaryOp:
+            hoistFromExpression(stmt);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void hoistFromExpression(AstNode *&slot)
+    {
+        if (slot->type != AstNodeType::BinaryOp && slot->type != AstNodeType::UnaryOp)
+            return;
+
+        if (isSafe(slot) && isInvariant(slot) && readsName(slot))
+        {
+            std::string temp = "__licm" + std::to_string(tempCounter++);
+            Token tempToken(TokenType::Name, temp, 0);
+            hoisted.push_back(new AssignNode(tempToken, slot));
+            slot = new NameNode(tempToken);
+            return;
+        }
+
+        if (slot->type == AstNodeType::BinaryOp)
+        {
+            hoistFromExpression(static_cast<BinaryOpNode *>(slot)->left);
+            hoistFromExpression(static_cast<BinaryOpNode *>(slot)->right);
+        }
+        else
+        {
+            hoistFromExpression(static_cast<UnaryOpNode *>(slot)->operand);
+        }
+    }
+
+    static bool runsNoUserCode(AstNode *node)
+    {
+        if (isLiteral(node) || node->type == AstNodeType::Name)
+            return true;
+        if (node->type == AstNodeType::BinaryOp)
+        {
+            auto binary = static_cast<BinaryOpNode *>(node);
+            return isProvenNumber(binary->left) && isProvenNumber(binary->right) &&
+                   runsNoUserCode(binary->left) && runsNoUserCode(binary->right);
+        }
+        if (node->type == AstNodeType::UnaryOp)
+        {
+            auto unary = static_cast<UnaryOpNode *>(node);
+            return isProvenNumber(unary->operand) && runsNoUserCode(unary->operand);
+        }
+        return false;
+    }
+
+    static bool isSafe(AstNode *node)
+    {
+        if (!runsNoUserCode(node))
+            return false;
+        return !anyNode(node, [](AstNode *n)
+                        {
+            if (n->type == AstNodeType::BinaryOp)
+                return !cannotRaise(static_cast<BinaryOpNode *>(n)->op.type);
+            if (n->type == AstNodeType::UnaryOp)
+                return !cannotRaise(static_cast<UnaryOpNode *>(n)->op.type);
+            return false; });
+    }
+
+    // Operators that never raise on int and float operands (ints grow
+    // into BigInts instead of overflowing)
+    static bool cannotRaise(TokenType op)
+    {
+        switch (op)
+        {
+        case TokenType::Plus:
+        case TokenType::Minus:
+        case TokenType::Star:
+        case TokenType::EqualEqual:
+        case TokenType::BangEqual:
+        case TokenType::Less:
+        case TokenType::LessEqual:
+        case TokenType::Greater:
+        case TokenType::GreaterEqual:
+        case TokenType::And:
+        case TokenType::Or:
+        case TokenType::Not:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool isInvariant(AstNode *node) const
+    {
+        if (node->type == AstNodeType::Name)
+            return assigned.count(static_cast<NameNode *>(node)->name.lexeme) == 0;
+        if (node->type == AstNodeType::BinaryOp)
+            return isInvariant(static_cast<BinaryOpNode *>(node)->left) &&
+                   isInvariant(static_cast<BinaryOpNode *>(node)->right);
+        if (node->type == AstNodeType::UnaryOp)
+            return isInvariant(static_cast<UnaryOpNode *>(node)->operand);
+        return true;
+    }
+
+    static bool readsName(AstNode *node)
+    {
+        if (node->type == AstNodeType::Name)
+            return true;
+        if (node->type == AstNodeType::BinaryOp)
+            return readsName(static_cast<BinaryOpNode *>(node)->left) ||
+                   readsName(static_cast<BinaryOpNode *>(node)->right);
+        if (node->type == AstNodeType::UnaryOp)
+            return readsName(static_cast<UnaryOpNode *>(node)->operand);
+        return false;
+    }
+
+    void collectAssigned(AstNode *node)
+    {
+        anyNode(node, [this](AstNode *n)
+                {
+            forEachAssignedName(n, [this](const std::string &name)
+                                { assigned.insert(name); });
+            if (n->type == AstNodeType::Function)
+                assigned.insert(static_cast<FunctionNode *>(n)->name);
+            else if (n->type == AstNodeType::Class)
+                assigned.insert(static_cast<ClassNode *>(n)->name);
+            return false; });
+    }
+
+    static bool containsCall(AstNode *node)
+    {
+        return anyNode(node, [](AstNode *n)
+                       { return n->type == AstNodeType::Call || n->type == AstNodeType::InlinedCall; });
+    }
+
+    static bool containsJump(AstNode *node)
+    {
+        return anyNode(node, [](AstNode *n)
+                       { return n->type == AstNodeType::Break || n->type == AstNodeType::Continue ||
+                                 n->type == AstNodeType::Return; });
+    }
+};
+
+// ==================== Inlining ====================
+// Replaces calls to small global functions whose body is a single
+// `return <expr>` with the expression itself. Candidates must be bound
+// exactly once in the whole program and must not call anything (which
+// also rules out recursion). The interpreter re-checks the binding on
+// every execution and falls back to the original call if it changed.
+class InliningPass : public OptimizationPass, private AstRewriter
+{
+public:
+    InliningPass(size_t threshold, bool verbose) : threshold(threshold), verbose(verbose) {}
+    const char *name() const override { return "inlining"; }
+
+    bool run(ProgramNode *program) override
+    {
+        findCandidates(program);
+        if (candidates.empty())
+            return false;
+        return rewriteProgram(program);
+    }
+
+private:
+    struct Candidate
+    {
+        FunctionNode *function;
+        AstNode *expression;
+    };
+
+    size_t threshold;
+    bool verbose;
+    std::map<std::string, Candidate> candidates;
+    std::set<std::string> reported;
+
+    void findCandidates(ProgramNode *program)
+    {
+        candidates.clear();
+
+        std::map<std::string, int> bindings;
+        anyNode(program, [&bindings](AstNode *n)
+                {
+            forEachAssignedName(n, [&bindings](const std::string &name)
+                                { bindings[name]++; });
+            if (n->type == AstNodeType::Function)
+                bindings[static_cast<FunctionNode *>(n)->name]++;
+            else if (n->type == AstNodeType::Class)
+                bindings[static_cast<ClassNode *>(n)->name]++;
+            return false; });
+
+        for (AstNode *stmt : program->statements)
+        {
+            if (stmt->type != AstNodeType::Function)
+                continue;
+
+            auto func = static_cast<FunctionNode *>(stmt);
+            AstNode *expr = returnedExpression(func);
+            std::string reason;
+            if (bindings[func->name] != 1)
+                reason = "name is rebound";
+            else if (!expr)
+                reason = "body is not a single return";
+            else if (callsName(expr, func->name))
+                reason = "recursive";
+            else if (anyNode(expr, [](AstNode *n)
+                             { return n->type == AstNodeType::Call || n->type == AstNodeType::InlinedCall; }))
+                reason = "body contains calls";
+            else if (size_t size = countNodes(expr); size > threshold)
+                reason = "size " + std::to_string(size) + " exceeds threshold " + std::to_string(threshold);
+            else if (!cloneExpression(expr, &func->params))
+                reason = "unsupported expression";
+
+            if (reason.empty())
+                candidates[func->name] = {func, expr};
+            else
+                report(func->name, "not inlining " + func->name + ": " + reason);
+        }
+    }
+
+    AstNode *transform(AstNode *node) override
+    {
+        if (node->type != AstNodeType::Call)
+            return node;
+
+        auto call = static_cast<CallNode *>(node);
+        if (call->callee->type != AstNodeType::Name)
+            return node;
+
+        const Token &callee = static_cast<NameNode *>(call->callee)->name;
+        auto it = candidates.find(callee.lexeme);
+        if (it == candidates.end())
+            return node;
+
+        FunctionNode *func = it->second.function;
+        if (call->args.size() != func->params.size())
+        {
+            report(func->name, "not inlining " + func->name + " at line " +
+                                   std::to_string(callee.line) + ": argument count mismatch");
+            return node;
+        }
+
+        if (verbose)
+            std::cerr << "[inline] inlined " << func->name << " at line " << callee.line << "\n";
+        AstNode *inlined = cloneExpression(it->second.expression, &func->params);
+        return new InlinedCallNode(call, func->name, func->body, inlined);
+    }
+
+    void report(const std::string &key, const std::string &message)
+    {
+        if (verbose && reported.insert(key).second)
+            std::cerr << "[inline] " << message << "\n";
+    }
+
+    static AstNode *returnedExpression(FunctionNode *func)
+    {
+        auto &statements = static_cast<BlockNode *>(func->body)->statements;
+        if (statements.size() != 1 || statements[0]->type != AstNodeType::Return)
+            return nullptr;
+        return static_cast<ReturnNode *>(statements[0])->value;
+    }
+
+    static bool callsName(AstNode *node, const std::string &name)
+    {
+        return anyNode(node, [&name](AstNode *n)
+                       { return n->type == AstNodeType::Call &&
+                                static_cast<CallNode *>(n)->callee->type == AstNodeType::Name &&
+                                static_cast<NameNode *>(static_cast<CallNode *>(n)->callee)->name.lexeme == name; });
+    }
+
+    static size_t countNodes(AstNode *node)
+    {
+        size_t count = 0;
+        anyNode(node, [&count](AstNode *)
+                {
+            count++;
+            return false; });
+        return count;
+    }
+};
+
+// ==================== PassManager ====================
+PassManager::PassManager(const OptimizerOptions &options)
+{
+    int level = options.level;
+    if (level >= 1)
+    {
+        add(std::make_unique<InliningPass>(options.inlineThreshold, options.verbose));
+        add(std::make_unique<ConstantFoldingPass>());
+    }
+    if (level >= 2)
+    {
+        add(std::make_unique<AlgebraicSimplificationPass>());
+        add(std::make_unique<StrengthReductionPass>());
+    }
+    if (level >= 1)
+        add(std::make_unique<DeadBranchEliminationPass>());
+    if (level >= 2)
+        add(std::make_unique<LoopInvariantHoistingPass>());
+    if (level >= 1)
+        addAnalysis(std::make_unique<TypeInferencePass>(options.verbose));
+    if (level >= 2)
+        typeFacts = std::make_unique<TypeInferencePass>(false);
+}
+
+void PassManager::add(std::unique_ptr<OptimizationPass> pass)
+{
+    passes.push_back(std::move(pass));
+}
+
+void PassManager::addAnalysis(std::unique_ptr<OptimizationPass> pass)
+{
+    analyses.push_back(std::move(pass));
+}
+
+void PassManager::run(ProgramNode *program)
+{
+    // Passes feed each other (folding exposes dead branches, simplification
+    // exposes folding), so iterate until the tree stops changing
+    const int maxIterations = 8;
+    for (int i = 0; i < maxIterations; ++i)
+    {
+        bool changed = false;
+        if (typeFacts)
+            typeFacts->run(program);
+        for (auto &pass : passes)
+            changed |= pass->run(program);
+        if (!changed)
+            break;
+    }
+
+    // Analyses annotate the final tree and run exactly once
+    for (auto &analysis : analyses)
+        analysis->run(program);
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "ast.hpp"
+#include <memory>
+#include <vector>
+
+// ==================== Pass Infrastructure ====================
+// Optimization passes rewrite the tree produced by Parser::parse() before
+// it reaches Interpreter::interpret(). Every pass must preserve the
+// observable behaviour of the program at the level it is enabled for:
+//   -O0  no passes
+//   -O1  constant folding, dead-branch elimination, inlining of small
+//        global functions behind a rebinding guard (always exact)
+//   -O2  algebraic simplification, strength reduction and loop-invariant
+//        hoisting; these only touch arithmetic whose operands
+//        TypeInferencePass proved to be int/float, so no user-defined
+//        magic method is skipped or called a different number of times
+struct OptimizerOptions
+{
+    int level = 1;
+    size_t inlineThreshold = 16; // Max AST nodes in an inlined function body
+    bool verbose = false;        // Report optimization decisions on stderr
+};
+
+class OptimizationPass
+{
+public:
+    virtual ~OptimizationPass() = default;
+    virtual const char *name() const = 0;
+    // Rewrites the program in place; returns true if anything changed
+    virtual bool run(ProgramNode *program) = 0;
+};
+
+// Walks the tree bottom-up and replaces every child slot with the result
+// of transform(). Passes override transform() for the nodes they handle.
+class AstRewriter
+{
+public:
+    virtual ~AstRewriter() = default;
+    AstNode *rewrite(AstNode *node);
+    bool rewriteProgram(ProgramNode *program);
+
+protected:
+    virtual AstNode *transform(AstNode *node) { return node; }
+    bool changed = false;
+
+private:
+    void rewriteTarget(AstNode *target);
+};
+
+// Calls fn(child) for each direct child of node in evaluation order;
+// stops and returns true as soon as fn does
+template <typename Fn>
+bool anyChild(AstNode *node, const Fn &fn)
+{
+    switch (node->type)
+    {
+    case AstNodeType::Program:
+        for (AstNode *stmt : static_cast<ProgramNode *>(node)->statements)
+            if (fn(stmt))
+                return true;
+        return false;
+    case AstNodeType::Block:
+        for (AstNode *stmt : static_cast<BlockNode *>(node)->statements)
+            if (fn(stmt))
+                return true;
+        return false;
+    case AstNodeType::Print:
+        return fn(static_cast<PrintNode *>(node)->expression);
+    case AstNodeType::Return:
+        return static_cast<ReturnNode *>(node)->value && fn(static_cast<ReturnNode *>(node)->value);
+    case AstNodeType::If:
+    {
+        auto ifNode = static_cast<IfNode *>(node);
+        if (fn(ifNode->condition) || fn(ifNode->thenBranch))
+            return true;
+        for (auto &elifPair : ifNode->elifBranches)
+            if (fn(elifPair.first) || fn(elifPair.second))
+                return true;
+        return ifNode->elseBranch && fn(ifNode->elseBranch);
+    }
+    case AstNodeType::While:
+        return fn(static_cast<WhileNode *>(node)->condition) ||
+               fn(static_cast<WhileNode *>(node)->body);
+    case AstNodeType::For:
+        return fn(static_cast<ForNode *>(node)->iterable) ||
+               fn(static_cast<ForNode *>(node)->body);
+    case AstNodeType::Function:
+        return fn(static_cast<FunctionNode *>(node)->body);
+    case AstNodeType::Class:
+        return fn(static_cast<ClassNode *>(node)->body);
+    case AstNodeType::Call:
+    {
+        auto call = static_cast<CallNode *>(node);
+        if (fn(call->callee))
+            return true;
+        for (AstNode *arg : call->args)
+            if (fn(arg))
+                return true;
+        return false;
+    }
+    case AstNodeType::InlinedCall:
+    {
+        auto inlined = static_cast<InlinedCallNode *>(node);
+        return fn(inlined->call) || fn(inlined->inlined);
+    }
+    case AstNodeType::Property:
+        return fn(static_cast<PropertyNode *>(node)->object);
+    case AstNodeType::BinaryOp:
+        return fn(static_cast<BinaryOpNode *>(node)->left) ||
+               fn(static_cast<BinaryOpNode *>(node)->right);
+    case AstNodeType::UnaryOp:
+        return fn(static_cast<UnaryOpNode *>(node)->operand);
+    case AstNodeType::Assign:
+        return fn(static_cast<AssignNode *>(node)->value);
+    case AstNodeType::PropertyAssign:
+        return fn(static_cast<PropertyAssignNode *>(node)->object) ||
+               fn(static_cast<PropertyAssignNode *>(node)->value);
+    case AstNodeType::List:
+        for (AstNode *element : static_cast<ListNode *>(node)->elements)
+            if (fn(element))
+                return true;
+        return false;
+    case AstNodeType::Dict:
+    {
+        auto dict = static_cast<DictNode *>(node);
+        for (size_t i = 0; i < dict->keys.size(); ++i)
+            if (fn(dict->keys[i]) || fn(dict->values[i]))
+                return true;
+        return false;
+    }
+    case AstNodeType::Subscript:
+        return fn(static_cast<SubscriptNode *>(node)->object) ||
+               fn(static_cast<SubscriptNode *>(node)->index);
+    case AstNodeType::Slice:
+    {
+        auto slice = static_cast<SliceNode *>(node);
+        return (slice->start && fn(slice->start)) ||
+               (slice->stop && fn(slice->stop)) ||
+               (slice->step && fn(slice->step));
+    }
+    case AstNodeType::SubscriptAssign:
+        return fn(static_cast<SubscriptAssignNode *>(node)->object) ||
+               fn(static_cast<SubscriptAssignNode *>(node)->index) ||
+               fn(static_cast<SubscriptAssignNode *>(node)->value);
+    case AstNodeType::Tuple:
+        for (AstNode *element : static_cast<TupleNode *>(node)->elements)
+            if (fn(element))
+                return true;
+        return false;
+    case AstNodeType::UnpackAssign:
+    {
+        // The value is evaluated before any target
+        auto unpack = static_cast<UnpackAssignNode *>(node);
+        if (fn(unpack->value))
+            return true;
+        for (AstNode *target : unpack->targets)
+            if (fn(target))
+                return true;
+        return false;
+    }
+    case AstNodeType::AugAssign:
+        // The target is reached as the operation's left operand
+        return fn(static_cast<AugAssignNode *>(node)->operation);
+    case AstNodeType::FString:
+        for (const FStringSegment &segment : static_cast<FStringNode *>(node)->segments)
+            if (segment.expression && fn(segment.expression))
+                return true;
+        return false;
+    default:
+        return false;
+    }
+}
+
+// Pre-order walk over a subtree (including nested function and class
+// bodies); stops early and returns true once pred() does
+template <typename Pred>
+bool anyNode(AstNode *node, const Pred &pred)
+{
+    if (!node)
+        return false;
+    if (pred(node))
+        return true;
+    return anyChild(node, [&pred](AstNode *child)
+                    { return anyNode(child, pred); });
+}
+
+// Calls fn(name) for each variable `node` itself binds with Scope::set:
+// assignment, unpacking, augmented assignment and loop targets. Function and class definitions
+// bind their names too; callers handle those separately.
+template <typename Fn>
+void forEachAssignedName(AstNode *node, const Fn &fn)
+{
+    switch (node->type)
+    {
+    case AstNodeType::Assign:
+        fn(static_cast<AssignNode *>(node)->name.lexeme);
+        break;
+    case AstNodeType::For:
+        fn(static_cast<ForNode *>(node)->target.lexeme);
+        break;
+    case AstNodeType::UnpackAssign:
+        for (AstNode *target : static_cast<UnpackAssignNode *>(node)->targets)
+            if (target->type == AstNodeType::Name)
+                fn(static_cast<NameNode *>(target)->name.lexeme);
+        break;
+    case AstNodeType::AugAssign:
+        if (static_cast<AugAssignNode *>(node)->target->type == AstNodeType::Name)
+            fn(static_cast<NameNode *>(static_cast<AugAssignNode *>(node)->target)->name.lexeme);
+        break;
+    default:
+        break;
+    }
+}
+
+class PassManager
+{
+public:
+    PassManager(const OptimizerOptions &options);
+    void add(std::unique_ptr<OptimizationPass> pass);
+    void addAnalysis(std::unique_ptr<OptimizationPass> pass);
+    void run(ProgramNode *program);
+
+private:
+    std::vector<std::unique_ptr<OptimizationPass>> passes;
+    std::vector<std::unique_ptr<OptimizationPass>> analyses;
+    // Re-annotates AstNode::staticType before every round of passes for
+    // the -O2 passes that consult it; null below -O2
+    std::unique_ptr<OptimizationPass> typeFacts;
+};
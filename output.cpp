@@ -0,0 +1,135 @@
+#include "output.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <utility>
+
+Output::Output(int fd, Mode mode) : fd(fd), bufferMode(mode), buffer(new char[capacity]) {}
+
+Output::~Output()
+{
+    try
+    {
+        flush();
+    }
+    catch (const std::runtime_error &)
+    {
+        // Nowhere left to report it
+    }
+}
+
+static std::atomic<Output::Mode> &defaultMode()
+{
+    static std::atomic<Output::Mode> mode(isatty(STDOUT_FILENO) ? Output::Mode::Line : Output::Mode::Full);
+    return mode;
+}
+
+Output &Output::standard()
+{
+    thread_local Output out(STDOUT_FILENO, standardMode());
+    return out;
+}
+
+Output::Mode Output::standardMode()
+{
+    return defaultMode().load(std::memory_order_relaxed);
+}
+
+void Output::setStandardMode(Mode mode)
+{
+    defaultMode().store(mode, std::memory_order_relaxed);
+    standard().setMode(mode);
+}
+
+void Output::setMode(Mode mode)
+{
+    flush();
+    bufferMode = mode;
+}
+
+void Output::capture(std::string *target)
+{
+    if (target)
+        capture([target](std::string_view text) { target->append(text); });
+    else
+        capture(Sink());
+}
+
+void Output::capture(Sink sink)
+{
+    flush();
+    this->sink = std::move(sink);
+}
+
+void Output::write(std::string_view text)
+{
+    if (text.size() > capacity - used)
+    {
+        flush();
+        // Too large to be worth copying
+        if (text.size() >= capacity)
+        {
+            writeAll(text.data(), text.size());
+            return;
+        }
+    }
+    std::memcpy(buffer.get() + used, text.data(), text.size());
+    used += text.size();
+    if (bufferMode == Mode::Unbuffered)
+        flush();
+}
+
+void Output::put(char c)
+{
+    if (used == capacity)
+        flush();
+    buffer[used++] = c;
+    if (bufferMode == Mode::Unbuffered)
+        flush();
+}
+
+char *Output::reserve(size_t n)
+{
+    if (n > capacity - used)
+        flush();
+    return buffer.get() + used;
+}
+
+void Output::endLine()
+{
+    put('\n');
+    if (bufferMode == Mode::Line)
+        flush();
+}
+
+void Output::flush()
+{
+    size_t size = used;
+    used = 0; // A failed write drops the buffer rather than retrying it forever
+    writeAll(buffer.get(), size);
+}
+
+void Output::writeAll(const char *data, size_t size)
+{
+    if (sink)
+    {
+        if (size > 0)
+            sink(std::string_view(data, size));
+        return;
+    }
+    while (size > 0)
+    {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// ==================== Buffered Output ====================
+// Writer for a file descriptor behind `print`. Output collects in a
+// user-space buffer and reaches the descriptor only when the buffer
+// fills, on flush() or when the writer is destroyed at exit, so printing
+// a line costs a copy rather than a write(2). Line mode, the default for
+// a terminal, flushes at the end of every print; Unbuffered flushes after
+// every write.
+class Output
+{
+public:
+    enum class Mode
+    {
+        Full,
+        Line,
+        Unbuffered
+    };
+
+    static constexpr size_t capacity = 64 * 1024;
+
+    Output(int fd, Mode mode);
+    ~Output(); // Flushes, dropping the output if the write fails
+    Output(const Output &) = delete;
+    Output &operator=(const Output &) = delete;
+
+    void write(std::string_view text);
+    void put(char c);
+    // At least n (<= capacity) contiguous bytes to render into, published
+    // by commit(); saves formatting into a temporary first
+    char *reserve(size_t n);
+    void commit(size_t n) { used += n; }
+    // Ends one print: a newline, flushed as the mode requires
+    void endLine();
+    void flush();
+
+    Mode mode() const { return bufferMode; }
+    void setMode(Mode mode);
+
+    // While a sink is set, flushed output goes to it instead of the
+    // descriptor: appended to a string, or handed to a function, which
+    // may throw like a failed write. nullptr (or an empty function) ends
+    // the capture. Output buffered before the change goes where it was
+    // headed.
+    using Sink = std::function<void(std::string_view)>;
+    void capture(std::string *target);
+    void capture(Sink sink);
+
+    // stdout for the calling thread. Each thread has its own buffer, so
+    // threads print without locking and their output interleaves only
+    // where a buffer is flushed. A thread's writer starts in
+    // standardMode(): Line on a terminal, Full otherwise, unless changed.
+    static Output &standard();
+    static Mode standardMode();
+    // For the calling thread's writer and every one created after
+    static void setStandardMode(Mode mode);
+
+private:
+    void writeAll(const char *data, size_t size);
+
+    int fd;
+    Mode bufferMode;
+    Sink sink;
+    std::unique_ptr<char[]> buffer;
+    size_t used = 0;
+};
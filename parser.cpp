@@ -1,5 +1,6 @@
 #include "parser.hpp"
 #include <stdexcept>
+#include <string_view>
 
 Parser::Parser(const std::vector<Token> &tokens) : tokens(tokens) {}
 
@@ -93,11 +94,11 @@ AstNode *Parser::parseSimpleStmt()
         AstNode *value = nullptr;
         if (peek().type != TokenType::Newline && !isAtEnd())
         {
-            value = parseExpr();
+            value = parseExprList();
         }
         return new ReturnNode(value);
     }
-    return parseExpr();
+    return parseExprStmt();
 }
 
 AstNode *Parser::parsePrintStmt()
@@ -124,25 +125,145 @@ AstNode *Parser::parseAssign()
     if (match(TokenType::Assign))
     {
         skipNewlines(); // Skip newlines after =
-        AstNode *value = parseAssign();
-        if (expr->type == AstNodeType::Name)
-        {
-            NameNode *nameNode = static_cast<NameNode *>(expr);
-            return new AssignNode(nameNode->name, value);
-        }
-        else if (expr->type == AstNodeType::Property)
-        {
-            PropertyNode *propNode = static_cast<PropertyNode *>(expr);
-            return new PropertyAssignNode(propNode->object, propNode->property, value);
-        }
-        else
-        {
-            throw std::runtime_error("Invalid assignment target");
-        }
+        return makeAssign(expr, parseAssign());
     }
     return expr;
 }
 
+static bool isAssignable(AstNode *target)
+{
+    return target->type == AstNodeType::Name || target->type == AstNodeType::Property ||
+           (target->type == AstNodeType::Subscript &&
+            static_cast<SubscriptNode *>(target)->index->type != AstNodeType::Slice);
+}
+
+// The binary operator behind an augmented assignment token
+static bool augmentedOperator(TokenType type, TokenType &op)
+{
+    switch (type)
+    {
+    case TokenType::PlusEqual:
+        op = TokenType::Plus;
+        return true;
+    case TokenType::MinusEqual:
+        op = TokenType::Minus;
+        return true;
+    case TokenType::StarEqual:
+        op = TokenType::Star;
+        return true;
+    case TokenType::SlashEqual:
+        op = TokenType::Slash;
+        return true;
+    case TokenType::ModEqual:
+        op = TokenType::Mod;
+        return true;
+    case TokenType::DoubleStarEqual:
+        op = TokenType::DoubleStar;
+        return true;
+    case TokenType::DoubleSlashEqual:
+        op = TokenType::DoubleSlash;
+        return true;
+    case TokenType::PipeEqual:
+        op = TokenType::Pipe;
+        return true;
+    case TokenType::CaretEqual:
+        op = TokenType::Caret;
+        return true;
+    case TokenType::AmpersandEqual:
+        op = TokenType::Ampersand;
+        return true;
+    case TokenType::LeftShiftEqual:
+        op = TokenType::LeftShift;
+        return true;
+    case TokenType::RightShiftEqual:
+        op = TokenType::RightShift;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Statement-level expression: like parseAssign, but bare tuples are
+// allowed on either side of `=` and a tuple target unpacks the value
+AstNode *Parser::parseExprStmt()
+{
+    AstNode *expr = parseExprList();
+    TokenType op;
+    if (augmentedOperator(peek().type, op))
+        return parseAugAssign(expr);
+    if (!match(TokenType::Assign))
+        return expr;
+    skipNewlines(); // Skip newlines after =
+    AstNode *value = parseExprStmt();
+    if (value->type == AstNodeType::UnpackAssign)
+        throw std::runtime_error("Tuple unpacking cannot be chained");
+    if (expr->type != AstNodeType::Tuple)
+        return makeAssign(expr, value);
+
+    std::vector<AstNode *> &targets = static_cast<TupleNode *>(expr)->elements;
+    for (AstNode *target : targets)
+        if (!isAssignable(target))
+            throw std::runtime_error("Invalid assignment target");
+    return new UnpackAssignNode(targets, value);
+}
+
+// target op= value; the node's operation uses the operator without its `=`
+AstNode *Parser::parseAugAssign(AstNode *target)
+{
+    Token token = advance();
+    if (!isAssignable(target))
+        throw std::runtime_error("Invalid augmented assignment target");
+    skipNewlines();
+    AstNode *value = parseExprList();
+
+    TokenType op;
+    augmentedOperator(token.type, op);
+    Token binary(op, token.lexeme.substr(0, token.lexeme.size() - 1), token.line);
+    return new AugAssignNode(target, binary, value);
+}
+
+// expr (',' expr)* [',']; a comma anywhere makes a tuple
+AstNode *Parser::parseExprList()
+{
+    AstNode *first = parseOr();
+    if (peek().type != TokenType::Comma)
+        return first;
+
+    std::vector<AstNode *> elements{first};
+    while (match(TokenType::Comma))
+    {
+        TokenType next = peek().type;
+        if (isAtEnd() || next == TokenType::Newline || next == TokenType::Assign)
+            break;
+        elements.push_back(parseOr());
+    }
+    return new TupleNode(elements);
+}
+
+AstNode *Parser::makeAssign(AstNode *target, AstNode *value)
+{
+    if (target->type == AstNodeType::Name)
+    {
+        NameNode *nameNode = static_cast<NameNode *>(target);
+        return new AssignNode(nameNode->name, value);
+    }
+    else if (target->type == AstNodeType::Property)
+    {
+        PropertyNode *propNode = static_cast<PropertyNode *>(target);
+        return new PropertyAssignNode(propNode->object, propNode->property, value);
+    }
+    else if (target->type == AstNodeType::Subscript &&
+             static_cast<SubscriptNode *>(target)->index->type != AstNodeType::Slice)
+    {
+        SubscriptNode *subscript = static_cast<SubscriptNode *>(target);
+        return new SubscriptAssignNode(subscript->object, subscript->index, value);
+    }
+    else
+    {
+        throw std::runtime_error("Invalid assignment target");
+    }
+}
+
 AstNode *Parser::parseOr()
 {
     AstNode *left = parseAnd();
@@ -169,13 +290,61 @@ AstNode *Parser::parseAnd()
 
 AstNode *Parser::parseComparison()
 {
-    AstNode *left = parseTerm();
+    AstNode *left = parseBitOr();
     while (match({TokenType::EqualEqual, TokenType::BangEqual,
                   TokenType::Less, TokenType::LessEqual,
                   TokenType::Greater, TokenType::GreaterEqual}))
     {
         Token op = previous();
         skipNewlines(); // Skip newlines after comparison operator
+        left = new BinaryOpNode(left, op, parseBitOr());
+    }
+    return left;
+}
+
+AstNode *Parser::parseBitOr()
+{
+    AstNode *left = parseBitXor();
+    while (match(TokenType::Pipe))
+    {
+        Token op = previous();
+        skipNewlines(); // Skip newlines after |
+        left = new BinaryOpNode(left, op, parseBitXor());
+    }
+    return left;
+}
+
+AstNode *Parser::parseBitXor()
+{
+    AstNode *left = parseBitAnd();
+    while (match(TokenType::Caret))
+    {
+        Token op = previous();
+        skipNewlines(); // Skip newlines after ^
+        left = new BinaryOpNode(left, op, parseBitAnd());
+    }
+    return left;
+}
+
+AstNode *Parser::parseBitAnd()
+{
+    AstNode *left = parseShift();
+    while (match(TokenType::Ampersand))
+    {
+        Token op = previous();
+        skipNewlines(); // Skip newlines after &
+        left = new BinaryOpNode(left, op, parseShift());
+    }
+    return left;
+}
+
+AstNode *Parser::parseShift()
+{
+    AstNode *left = parseTerm();
+    while (match({TokenType::LeftShift, TokenType::RightShift}))
+    {
+        Token op = previous();
+        skipNewlines(); // Skip newlines after << or >>
         left = new BinaryOpNode(left, op, parseTerm());
     }
     return left;
@@ -225,7 +394,7 @@ AstNode *Parser::parsePower()
 
 AstNode *Parser::parseUnary()
 {
-    if (match({TokenType::Minus, TokenType::Not}))
+    if (match({TokenType::Minus, TokenType::Tilde, TokenType::Not}))
     {
         Token op = previous();
         skipNewlines(); // Skip newlines after unary operator
@@ -246,6 +415,8 @@ AstNode *Parser::parsePrimary()
         return parseCall(new FloatNode(previous()));
     if (match(TokenType::String))
         return parseCall(new StringNode(previous()));
+    if (match(TokenType::FStringStart))
+        return parseCall(parseFString());
     if (match(TokenType::True))
         return parseCall(new BooleanNode(previous()));
     if (match(TokenType::False))
@@ -256,13 +427,177 @@ AstNode *Parser::parsePrimary()
         return parseCall(new NameNode(previous()));
     if (match(TokenType::LeftParen))
     {
+        // () and (a,) are tuples, (a) is just a
+        if (match(TokenType::RightParen))
+            return parseCall(new TupleNode({}));
         AstNode *expr = parseExpr();
+        if (match(TokenType::Comma))
+        {
+            std::vector<AstNode *> elements{expr};
+            while (peek().type != TokenType::RightParen)
+            {
+                elements.push_back(parseExpr());
+                if (!match(TokenType::Comma))
+                    break;
+            }
+            expr = new TupleNode(elements);
+        }
         consume(TokenType::RightParen);
         return parseCall(expr);
     }
+    if (match(TokenType::LeftBracket))
+        return parseCall(parseList());
+    if (match(TokenType::LeftBrace))
+        return parseCall(parseDict());
     throw std::runtime_error("Expected expression");
 }
 
+// The text after ':' in a replacement field
+static FormatSpec parseFormatSpec(const Token &token)
+{
+    const std::string &text = token.lexeme;
+    size_t n = text.size(), i = 0;
+    auto isAlign = [](char c) { return c == '<' || c == '>' || c == '^' || c == '='; };
+    auto number = [&]()
+    {
+        size_t value = 0;
+        for (; i < n && text[i] >= '0' && text[i] <= '9'; ++i)
+        {
+            value = value * 10 + static_cast<size_t>(text[i] - '0');
+            if (value > 1000000000)
+                throw std::runtime_error("Too many decimal digits in format spec at line " + std::to_string(token.line));
+        }
+        return value;
+    };
+
+    FormatSpec spec;
+    spec.empty = text.empty();
+    if (n >= 2 && isAlign(text[1]))
+    {
+        spec.fill = text[0];
+        spec.align = text[1];
+        i = 2;
+    }
+    else if (n >= 1 && isAlign(text[0]))
+    {
+        spec.align = text[0];
+        i = 1;
+    }
+    if (i < n && (text[i] == '+' || text[i] == '-' || text[i] == ' '))
+        spec.sign = text[i++];
+    spec.alternate = i < n && text[i] == '#';
+    i += spec.alternate;
+    spec.zeroPad = i < n && text[i] == '0';
+    i += spec.zeroPad;
+    // Without a fill of its own, '0' before the width pads with zeros
+    if (spec.zeroPad && !(n >= 2 && isAlign(text[1])))
+        spec.fill = '0';
+    spec.width = number();
+    if (i < n && (text[i] == ',' || text[i] == '_'))
+        spec.grouping = text[i++];
+    if (i < n && text[i] == '.')
+    {
+        size_t digits = ++i;
+        spec.precision = static_cast<int>(number());
+        if (i == digits)
+            throw std::runtime_error("Format spec missing precision at line " + std::to_string(token.line));
+    }
+    if (i < n && std::string_view("bdeEfFgGosxX%").find(text[i]) != std::string_view::npos)
+        spec.type = text[i++];
+    if (i != n)
+        throw std::runtime_error("Invalid format spec '" + text + "' at line " + std::to_string(token.line));
+    return spec;
+}
+
+// After FStringStart; literal chunks and replacement fields up to FStringEnd
+AstNode *Parser::parseFString()
+{
+    std::vector<FStringSegment> segments(1);
+    while (!match(TokenType::FStringEnd))
+    {
+        if (match(TokenType::FStringText))
+        {
+            segments.back().literal = previous().lexeme;
+            continue;
+        }
+        FStringSegment &segment = segments.back();
+        segment.source = consume(TokenType::FStringField).lexeme;
+        segment.expression = parseExprList();
+        if (match(TokenType::FStringConversion))
+            segment.conversion = previous().lexeme[0];
+        segment.spec = parseFormatSpec(consume(TokenType::FStringSpec));
+        segments.emplace_back();
+    }
+    return new FStringNode(std::move(segments));
+}
+
+// After '['; allows a trailing comma
+AstNode *Parser::parseList()
+{
+    std::vector<AstNode *> elements;
+    while (peek().type != TokenType::RightBracket)
+    {
+        elements.push_back(parseExpr());
+        if (!match(TokenType::Comma))
+            break;
+    }
+    consume(TokenType::RightBracket);
+    return new ListNode(elements);
+}
+
+// After '{'; key: value pairs, allowing a trailing comma
+AstNode *Parser::parseDict()
+{
+    std::vector<AstNode *> keys;
+    std::vector<AstNode *> values;
+    while (peek().type != TokenType::RightBrace)
+    {
+        keys.push_back(parseExpr());
+        consume(TokenType::Colon);
+        values.push_back(parseExpr());
+        if (!match(TokenType::Comma))
+            break;
+    }
+    consume(TokenType::RightBrace);
+    return new DictNode(keys, values);
+}
+
+// After '['; object[index] or object[start:stop:step] with any part omitted
+AstNode *Parser::parseSubscript(AstNode *object)
+{
+    AstNode *start = nullptr;
+    if (peek().type != TokenType::Colon)
+        start = parseExpr();
+
+    if (start && match(TokenType::Comma))
+    {
+        // object[a, b] indexes with the tuple (a, b)
+        std::vector<AstNode *> elements{start};
+        while (peek().type != TokenType::RightBracket)
+        {
+            elements.push_back(parseExpr());
+            if (!match(TokenType::Comma))
+                break;
+        }
+        consume(TokenType::RightBracket);
+        return new SubscriptNode(object, new TupleNode(elements));
+    }
+    if (!match(TokenType::Colon))
+    {
+        consume(TokenType::RightBracket);
+        return new SubscriptNode(object, start);
+    }
+
+    AstNode *stop = nullptr;
+    AstNode *step = nullptr;
+    if (peek().type != TokenType::Colon && peek().type != TokenType::RightBracket)
+        stop = parseExpr();
+    if (match(TokenType::Colon) && peek().type != TokenType::RightBracket)
+        step = parseExpr();
+    consume(TokenType::RightBracket);
+    return new SubscriptNode(object, new SliceNode(start, stop, step));
+}
+
 AstNode *Parser::parseStmt()
 {
     // Skip leading newlines
@@ -273,11 +608,13 @@ AstNode *Parser::parseStmt()
     if (isAtEnd())
         return new PassNode();
 
-    // Check for compound statements (if, while, def, class)
+    // Check for compound statements (if, while, for, def, class)
     if (match(TokenType::If))
         return parseIfStmt();
     if (match(TokenType::While))
         return parseWhileStmt();
+    if (match(TokenType::For))
+        return parseForStmt();
     if (match(TokenType::Def))
         return parseFunctionDef();
     if (match(TokenType::Class))
@@ -345,6 +682,16 @@ AstNode *Parser::parseWhileStmt()
     return new WhileNode(condition, body);
 }
 
+AstNode *Parser::parseForStmt()
+{
+    Token target = consume(TokenType::Name);
+    consume(TokenType::In);
+    AstNode *iterable = parseExpr();
+    consume(TokenType::Colon);
+    AstNode *body = parseSuite();
+    return new ForNode(target, iterable, body);
+}
+
 AstNode *Parser::parseFunctionDef()
 {
     Token nameToken = consume(TokenType::Name);
@@ -389,6 +736,10 @@ AstNode *Parser::parseCall(AstNode *callee)
         {
             callee = new PropertyNode(callee, consume(TokenType::Name).lexeme);
         }
+        else if (match(TokenType::LeftBracket))
+        {
+            callee = parseSubscript(callee);
+        }
         else
         {
             break;
@@ -32,17 +32,30 @@ private:
     AstNode *parsePrintStmt();
     AstNode *parseIfStmt();
     AstNode *parseWhileStmt();
+    AstNode *parseForStmt();
     AstNode *parseFunctionDef();
     AstNode *parseClassDef();
     AstNode *parseExpr();
     AstNode *parseAssign();
+    AstNode *parseExprStmt();
+    AstNode *parseExprList();
+    AstNode *parseAugAssign(AstNode *target);
+    AstNode *makeAssign(AstNode *target, AstNode *value);
     AstNode *parseOr();
     AstNode *parseAnd();
     AstNode *parseComparison();
+    AstNode *parseBitOr();
+    AstNode *parseBitXor();
+    AstNode *parseBitAnd();
+    AstNode *parseShift();
     AstNode *parseTerm();
     AstNode *parseFactor();
     AstNode *parsePower();
     AstNode *parseUnary();
     AstNode *parsePrimary();
     AstNode *parseCall(AstNode *callee);
+    AstNode *parseList();
+    AstNode *parseDict();
+    AstNode *parseFString();
+    AstNode *parseSubscript(AstNode *object);
 };
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "profile.hpp"
+#include "optimizer.hpp"
+#include <fstream>
+#include <sstream>
+
+static uint32_t kindBit(PyObject *obj)
+{
+    return 1u << static_cast<unsigned>(obj->kind);
+}
+
+static bool isArithmetic(TokenType op)
+{
+    switch (op)
+    {
+    case TokenType::Plus:
+    case TokenType::Minus:
+    case TokenType::Star:
+    case TokenType::Slash:
+    case TokenType::DoubleSlash:
+    case TokenType::Mod:
+    case TokenType::DoubleStar:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool isBitwise(TokenType op)
+{
+    return op == TokenType::Ampersand || op == TokenType::Pipe || op == TokenType::Caret ||
+           op == TokenType::LeftShift || op == TokenType::RightShift;
+}
+
+static bool isComparison(TokenType op)
+{
+    return op == TokenType::EqualEqual || op == TokenType::BangEqual ||
+           op == TokenType::Less || op == TokenType::LessEqual ||
+           op == TokenType::Greater || op == TokenType::GreaterEqual;
+}
+
+void assignSites(ProgramNode *program)
+{
+    int next = program->siteBase;
+    anyNode(program, [&next](AstNode *n)
+            {
+        if (n->type == AstNodeType::BinaryOp || n->type == AstNodeType::Property ||
+            n->type == AstNodeType::Call)
+            n->site = next++;
+        return false; });
+    program->siteCount = next;
+}
+
+// ==================== Profile ====================
+void Profile::attach(ProgramNode *program)
+{
+    if (this->program == program)
+        return;
+    bool continues = this->program && program->siteBase > 0 && program->siteBase == this->program->siteCount;
+    this->program = program;
+    if (program->siteCount < 0)
+        assignSites(program);
+
+    if (continues)
+    {
+        sites.resize(program->siteCount);
+        siteOps.resize(program->siteCount, TokenType::EndOfFile);
+    }
+    else
+    {
+        sites.assign(program->siteCount, SiteFeedback());
+        siteOps.assign(program->siteCount, TokenType::EndOfFile);
+    }
+    anyNode(program, [this](AstNode *n)
+            {
+        if (n->type == AstNodeType::BinaryOp && n->site >= 0)
+            siteOps[n->site] = static_cast<BinaryOpNode *>(n)->op.type;
+        return false; });
+}
+
+void Profile::recordBinary(SiteFeedback &site, TokenType op, PyObject *left, PyObject *right)
+{
+    site.leftKinds |= kindBit(left);
+    site.rightKinds |= kindBit(right);
+    site.count++;
+    if (site.specialization == Specialization::None && site.count >= warmupThreshold)
+        specialize(site, op);
+}
+
+void Profile::recordTarget(SiteFeedback &site, const std::string &target)
+{
+    site.count++;
+    if (site.target.empty())
+        site.target = target;
+    else if (site.target != target)
+        site.polymorphic = true;
+}
+
+void Profile::specialize(SiteFeedback &site, TokenType op)
+{
+    const uint32_t intBit = 1u << static_cast<unsigned>(ObjectKind::Int);
+    const uint32_t floatBit = 1u << static_cast<unsigned>(ObjectKind::Float);
+    const uint32_t strBit = 1u << static_cast<unsigned>(ObjectKind::Str);
+    uint32_t seen = site.leftKinds | site.rightKinds;
+
+    if (!isArithmetic(op) && !isBitwise(op) && !isComparison(op))
+        site.specialization = Specialization::Generic;
+    else if (site.leftKinds == intBit && site.rightKinds == intBit)
+        site.specialization = Specialization::Int;
+    else if (isBitwise(op))
+        site.specialization = Specialization::Generic;
+    else if ((seen & ~(intBit | floatBit)) == 0 && (seen & floatBit))
+        site.specialization = Specialization::Float;
+    else if (site.leftKinds == strBit && site.rightKinds == strBit &&
+             (op == TokenType::Plus || isComparison(op)))
+        site.specialization = Specialization::Str;
+    else
+        site.specialization = Specialization::Generic;
+}
+
+size_t Profile::specializedSites() const
+{
+    size_t count = 0;
+    for (const SiteFeedback &site : sites)
+        if (site.specialization != Specialization::None &&
+            site.specialization != Specialization::Generic)
+            count++;
+    return count;
+}
+
+uint64_t Profile::makeKey(const std::string &source, int optLevel, size_t inlineThreshold)
+{
+    // FNV-1a over the source, then the optimization level and the inline
+    // threshold (which change the shape of the tree and therefore the
+    // site numbering)
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : source)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    hash ^= static_cast<uint64_t>(optLevel);
+    hash *= 1099511628211ull;
+    hash ^= static_cast<uint64_t>(inlineThreshold);
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+// ==================== Persistence ====================
+// Text format, one record per line:
+//   pyprofile 1
+//   key <hex> <site count>
+//   b <site> <count> <left kinds> <right kinds> <deoptimized>
+//   t <site> <count> <polymorphic> <target>
+bool Profile::load(const std::string &path, uint64_t key)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+
+    std::string magic;
+    int version;
+    std::string keyTag;
+    uint64_t fileKey;
+    size_t siteCount;
+    if (!(in >> magic >> version) || magic != "pyprofile" || version != 1)
+        return false;
+    if (!(in >> keyTag >> std::hex >> fileKey >> std::dec >> siteCount) || keyTag != "key")
+        return false;
+    if (fileKey != key || siteCount != sites.size())
+        return false;
+
+    // Records go into a copy, swapped in only once the whole file has read
+    // back cleanly
+    std::vector<SiteFeedback> loaded = sites;
+    std::string tag;
+    while (in >> tag)
+    {
+        size_t index;
+        uint32_t count;
+        if (!(in >> index >> count) || index >= loaded.size())
+            return false;
+        SiteFeedback &site = loaded[index];
+        site.count = count;
+
+        if (tag == "b")
+        {
+            int deoptimized;
+            if (!(in >> site.leftKinds >> site.rightKinds >> deoptimized))
+                return false;
+            if (deoptimized)
+                site.specialization = Specialization::Generic;
+            else if (site.count >= warmupThreshold)
+                specialize(site, siteOps[index]);
+        }
+        else if (tag == "t")
+        {
+            int polymorphic;
+            if (!(in >> polymorphic) || !std::getline(in >> std::ws, site.target))
+                return false;
+            site.polymorphic = polymorphic != 0;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    sites.swap(loaded);
+    return true;
+}
+
+void Profile::save(const std::string &path, uint64_t key) const
+{
+    std::ostringstream out;
+    out << "pyprofile 1\n";
+    out << "key " << std::hex << key << std::dec << " " << sites.size() << "\n";
+    for (size_t i = 0; i < sites.size(); ++i)
+    {
+        const SiteFeedback &site = sites[i];
+        if (site.count == 0)
+            continue;
+        if (siteOps[i] != TokenType::EndOfFile)
+            out << "b " << i << " " << site.count << " " << site.leftKinds << " " << site.rightKinds << " "
+                << (site.specialization == Specialization::Generic) << "\n";
+        else if (!site.target.empty())
+            out << "t " << i << " " << site.count << " " << site.polymorphic << " " << site.target << "\n";
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    file << out.str();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ast.hpp"
+#include "pyobject.hpp"
+
+// ==================== Type Feedback ====================
+// Binary-op, attribute and call nodes each own a feedback slot. Slots are
+// numbered by assignSites() in a fixed pre-order walk, so feedback saved
+// by one run lines up with the next as long as the source, the
+// optimization level and the inline threshold are unchanged (all are
+// part of the profile key).
+//
+// A binary-op site that has seen the same operand types warmupThreshold
+// times is specialized: the interpreter checks the operand kinds and runs
+// a native kernel, deoptimizing the site to Generic on the first miss.
+// A profile loaded from disk specializes hot sites before the first
+// execution.
+
+enum class Specialization : unsigned char
+{
+    None,    // still collecting feedback
+    Int,     // int op int
+    Float,   // int/float op int/float, at least one float
+    Str,     // str op str
+    Generic  // deoptimized; stop collecting
+};
+
+struct SiteFeedback
+{
+    uint32_t count = 0;
+    uint32_t leftKinds = 0; // Bit (1 << ObjectKind) per operand kind seen
+    uint32_t rightKinds = 0;
+    Specialization specialization = Specialization::None;
+    std::string target; // Attribute shape or call target
+    bool polymorphic = false;
+};
+
+// Numbers every profiled node, from the program's siteBase, and records
+// the end of the range on the program
+void assignSites(ProgramNode *program);
+
+class Profile
+{
+public:
+    static constexpr uint32_t warmupThreshold = 8;
+
+    // Sizes the feedback table for `program`, numbering its sites first
+    // if that has not happened yet; attaching the same program twice keeps
+    // the feedback already collected or loaded, and so does attaching a
+    // program whose sites continue the attached one's
+    void attach(ProgramNode *program);
+
+    SiteFeedback &site(int index) { return sites[index]; }
+
+    void recordBinary(SiteFeedback &site, TokenType op, PyObject *left, PyObject *right);
+    void recordTarget(SiteFeedback &site, const std::string &target);
+
+    // Loads feedback saved for the same key; returns false (and leaves the
+    // table as it was) if the file is missing, was written for other code
+    // or is malformed anywhere
+    bool load(const std::string &path, uint64_t key);
+    void save(const std::string &path, uint64_t key) const;
+
+    size_t specializedSites() const;
+    static uint64_t makeKey(const std::string &source, int optLevel, size_t inlineThreshold);
+
+private:
+    static void specialize(SiteFeedback &site, TokenType op);
+    ProgramNode *program = nullptr;
+    std::vector<SiteFeedback> sites;
+    std::vector<TokenType> siteOps; // Operator of each binary-op site
+};
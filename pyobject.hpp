@@ -3,20 +3,82 @@
 #include <string>
 #include <memory>
 #include <vector>
-#include <map>
 #include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include "bigint.hpp"
+#include "hashtable.hpp"
+#include "heap.hpp"
+#include "numconv.hpp"
 
 // Forward declarations
 class AstNode;
 class Scope;
 
 // ==================== Base PyObject ====================
+// Concrete type tag, so hot paths can test an object's type without a
+// dynamic_cast
+enum class ObjectKind : unsigned char
+{
+    None,
+    Bool,
+    Int,
+    Float,
+    Str,
+    Function,
+    Class,
+    Instance,
+    Builtin,
+    List,
+    Tuple,
+    Dict,
+    Range,
+    Array,
+    Module
+};
+
+// Objects are allocated from the current thread's Heap when there is one
+// (see heap.hpp) and destroyed with it; objects from the global allocator
+// (literals, builtins) are never deleted
 class PyObject
 {
 public:
+    PyObject(ObjectKind kind) : kind(kind) {}
     virtual ~PyObject() = default;
+
+    static void *operator new(size_t size)
+    {
+        if (Heap *heap = Heap::current())
+            return heap->allocate(size);
+        return ::operator new(size);
+    }
+    // Only reached when a constructor throws. The Heap must not destroy the
+    // object again; global memory is kept like any other object's.
+    static void operator delete(void *memory)
+    {
+        if (Heap::current())
+            Heap::abandon(memory);
+    }
+
     virtual std::string toString() const = 0;
+    // Form used inside containers, e.g. strings are quoted
+    virtual std::string repr() const { return toString(); }
     virtual bool isTruthy() const = 0;
+    const ObjectKind kind;
+
+protected:
+    // Allocation for classes whose objects own nothing outside the heap,
+    // which the Heap then need not destroy; such a class declares
+    //   static void *operator new(size_t size) { return allocatePlain(size); }
+    //   static void operator delete(void *) {}
+    static void *allocatePlain(size_t size)
+    {
+        if (Heap *heap = Heap::current())
+            return heap->allocatePlain(size);
+        return ::operator new(size);
+    }
 };
 
 // ==================== PyFunction ====================
@@ -32,7 +94,7 @@ public:
                const std::vector<std::string> &params,
                std::shared_ptr<AstNode> body,
                std::shared_ptr<Scope> closure)
-        : name(name), params(params), body(body), closure(closure) {}
+        : PyObject(ObjectKind::Function), name(name), params(params), body(body), closure(closure) {}
 
     std::string toString() const override
     {
@@ -42,6 +104,62 @@ public:
     bool isTruthy() const override { return true; }
 };
 
+// ==================== PyBuiltin ====================
+// Native function exposed to scripts. Arguments arrive evaluated and the
+// interpreter checks the count before calling; maxArity is SIZE_MAX for
+// functions without an upper limit.
+class PyBuiltin : public PyObject
+{
+public:
+    using Function = PyObject *(*)(const std::vector<PyObject *> &args);
+
+    std::string name;
+    size_t minArity;
+    size_t maxArity;
+    Function function;
+
+    PyBuiltin(const std::string &name, size_t arity, Function function)
+        : PyBuiltin(name, arity, arity, function) {}
+    PyBuiltin(const std::string &name, size_t minArity, size_t maxArity, Function function)
+        : PyObject(ObjectKind::Builtin), name(name), minArity(minArity), maxArity(maxArity), function(function) {}
+
+    std::string toString() const override
+    {
+        return "<built-in function " + name + ">";
+    }
+
+    bool isTruthy() const override { return true; }
+};
+
+// ==================== PyModule ====================
+// Native namespace reached as module.member, such as time and math.
+// Modules are predefined globals; there is no import statement.
+class PyModule : public PyObject
+{
+public:
+    std::string name;
+    HashTable<std::string, PyObject *> members;
+
+    PyModule(const std::string &name) : PyObject(ObjectKind::Module), name(name) {}
+
+    void define(const std::string &member, PyObject *value) { members.insert(member, value); }
+    void define(PyBuiltin *function) { define(function->name, function); }
+
+    PyObject *get(const std::string &member) const
+    {
+        if (PyObject *const *value = members.find(member))
+            return *value;
+        throw std::runtime_error("module '" + name + "' has no attribute '" + member + "'");
+    }
+
+    std::string toString() const override
+    {
+        return "<module '" + name + "' (built-in)>";
+    }
+
+    bool isTruthy() const override { return true; }
+};
+
 // ==================== Control Flow Exceptions ====================
 struct BreakException : public std::exception
 {
@@ -58,37 +176,157 @@ struct ReturnException : public std::exception
 };
 
 // ==================== Basic Types ====================
+// Values that fit in 64 bits are stored inline; anything larger is
+// promoted to a BigInt. The representation is canonical: `big` is set
+// exactly when the value is outside the int64 range.
 class PyInt : public PyObject
 {
 public:
-    PyInt(long long value) : value(value) {}
-    std::string toString() const override { return std::to_string(value); }
-    bool isTruthy() const override { return value != 0; }
-    long long value;
+    static void *operator new(size_t size) { return allocatePlain(size); }
+    static void operator delete(void *) {}
+    PyInt(long long value) : PyObject(ObjectKind::Int), value(value) {}
+    PyInt(const BigInt &value) : PyObject(ObjectKind::Int), value(0)
+    {
+        if (value.fitsInt64())
+        {
+            this->value = value.toInt64();
+        }
+        else if (Heap *heap = Heap::current())
+        {
+            // The digits live as long as the heap holding this object
+            auto digits = std::make_shared<const BigInt>(value);
+            big = digits.get();
+            heap->keep(std::move(digits));
+        }
+        else
+        {
+            big = new BigInt(value);
+        }
+    }
+    std::string toString() const override { return big ? big->toString() : intToString(value); }
+    bool isTruthy() const override { return big || value != 0; }
+    BigInt toBig() const { return big ? *big : BigInt(value); }
+    double toDouble() const { return big ? big->toDouble() : static_cast<double>(value); }
+    long long value;             // Valid unless big is set
+    const BigInt *big = nullptr; // Shared by copies; never mutated
 };
 
 class PyFloat : public PyObject
 {
 public:
-    PyFloat(double value) : value(value) {}
-    std::string toString() const override { return std::to_string(value); }
+    static void *operator new(size_t size) { return allocatePlain(size); }
+    static void operator delete(void *) {}
+    PyFloat(double value) : PyObject(ObjectKind::Float), value(value) {}
+    std::string toString() const override { return floatToString(value); }
     bool isTruthy() const override { return value != 0.0; }
     double value;
 };
 
+// Strings are immutable, but a string's characters may sit at the front of
+// a buffer shared with longer strings. `s + t` appends t to s's buffer in
+// place when s ends where the buffer does, and the result shares the
+// buffer with a longer length while s still sees only its own prefix. A
+// loop of `s = s + piece` thus grows one buffer geometrically instead of
+// copying s on every iteration. Objects are never freed, so the buffer can
+// live in the string that created it. Appending never touches a string's
+// own characters, so the hash cached on first use stays valid. A frozen
+// string (a literal, shared by every thread running the program) is never
+// appended to in place and has its hash computed up front, so nothing
+// writes to it after freeze().
 class PyStr : public PyObject
 {
 public:
-    PyStr(const std::string &value) : value(value) {}
-    std::string toString() const override { return value; }
-    bool isTruthy() const override { return !value.empty(); }
-    std::string value;
+    PyStr(std::string value) : PyObject(ObjectKind::Str), own(std::move(value)), buffer(&own), length(own.size()) {}
+
+    // Valid until the next concat on a string sharing this buffer; copy it
+    // if interpreted code runs in between
+    std::string_view view() const { return std::string_view(buffer->data(), length); }
+    size_t size() const { return length; }
+
+    PyStr *concat(std::string_view tail) const
+    {
+        // A tail inside the buffer would be invalidated by a reallocation
+        bool aliases = !std::less<const char *>()(tail.data(), buffer->data()) &&
+                       std::less<const char *>()(tail.data(), buffer->data() + buffer->capacity());
+        if (!frozen && length == buffer->size() && !aliases)
+        {
+            buffer->append(tail);
+            return new PyStr(buffer, length + tail.size());
+        }
+        std::string joined;
+        joined.reserve(length + tail.size());
+        joined.append(view()).append(tail);
+        return new PyStr(std::move(joined));
+    }
+
+    // `count` copies of `piece`, doubling the filled prefix with each copy
+    static PyStr *repeat(std::string_view piece, size_t count)
+    {
+        if (piece.empty() || count == 0)
+            return new PyStr("");
+        if (count > std::string().max_size() / piece.size())
+            throw std::runtime_error("Repeat count too large");
+        size_t total = piece.size() * count;
+        std::string out(total, '\0');
+        std::memcpy(out.data(), piece.data(), piece.size());
+        for (size_t filled = piece.size(); filled < total; filled *= 2)
+            std::memcpy(out.data() + filled, out.data(), std::min(filled, total - filled));
+        return new PyStr(std::move(out));
+    }
+
+    void freeze()
+    {
+        hash();
+        frozen = true;
+    }
+
+    size_t hash() const
+    {
+        if (!hashed)
+        {
+            hashValue = std::hash<std::string_view>()(view());
+            hashed = true;
+        }
+        return hashValue;
+    }
+    std::string toString() const override { return std::string(view()); }
+    std::string repr() const override
+    {
+        std::string_view value = view();
+        char quote = value.find('\'') != std::string_view::npos && value.find('"') == std::string_view::npos ? '"' : '\'';
+        std::string out(1, quote);
+        for (char c : value)
+        {
+            if (c == quote || c == '\\')
+                out += '\\';
+            if (c == '\n')
+                out += "\\n";
+            else if (c == '\t')
+                out += "\\t";
+            else
+                out += c;
+        }
+        return out + quote;
+    }
+    bool isTruthy() const override { return length != 0; }
+
+private:
+    PyStr(std::string *buffer, size_t length) : PyObject(ObjectKind::Str), buffer(buffer), length(length) {}
+
+    std::string own;
+    std::string *buffer;
+    size_t length;
+    mutable size_t hashValue = 0;
+    mutable bool hashed = false;
+    bool frozen = false;
 };
 
 class PyBool : public PyObject
 {
 public:
-    PyBool(bool value) : value(value) {}
+    static void *operator new(size_t size) { return allocatePlain(size); }
+    static void operator delete(void *) {}
+    PyBool(bool value) : PyObject(ObjectKind::Bool), value(value) {}
     std::string toString() const override { return value ? "True" : "False"; }
     bool isTruthy() const override { return value; }
     bool value;
@@ -97,35 +335,327 @@ public:
 class PyNone : public PyObject
 {
 public:
+    static void *operator new(size_t size) { return allocatePlain(size); }
+    static void operator delete(void *) {}
+    PyNone() : PyObject(ObjectKind::None) {}
     std::string toString() const override { return "None"; }
     bool isTruthy() const override { return false; }
 };
 
+// ==================== PyList ====================
+// Contiguous, growable array of references. Unlike the other builtin
+// types a list is mutable, so list objects are never shared between
+// evaluations of a literal.
+class PyList : public PyObject
+{
+public:
+    PyList() : PyObject(ObjectKind::List) {}
+    PyList(std::vector<PyObject *> items) : PyObject(ObjectKind::List), items(std::move(items)) {}
+
+    std::string toString() const override
+    {
+        if (printing)
+            return "[...]"; // The list contains itself
+        printing = true;
+        std::string out = "[";
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            if (i)
+                out += ", ";
+            out += items[i]->repr();
+        }
+        printing = false;
+        return out + "]";
+    }
+
+    bool isTruthy() const override { return !items.empty(); }
+    std::vector<PyObject *> items;
+
+private:
+    mutable bool printing = false;
+};
+
+// ==================== PyTuple ====================
+// Immutable sequence. Up to inlineCapacity elements live inside the
+// object itself, so a small tuple such as a multi-value return costs one
+// allocation rather than two.
+class PyTuple : public PyObject
+{
+public:
+    static constexpr size_t inlineCapacity = 4;
+
+    PyTuple(PyObject *const *values, size_t count)
+        : PyObject(ObjectKind::Tuple), count(count),
+          items(count <= inlineCapacity ? inlineItems : new PyObject *[count])
+    {
+        std::copy(values, values + count, items);
+    }
+    PyTuple(const PyTuple &) = delete;
+    PyTuple &operator=(const PyTuple &) = delete;
+    ~PyTuple() override
+    {
+        if (items != inlineItems)
+            delete[] items;
+    }
+
+    size_t size() const { return count; }
+    PyObject *operator[](size_t i) const { return items[i]; }
+    PyObject *const *begin() const { return items; }
+    PyObject *const *end() const { return items + count; }
+
+    std::string toString() const override
+    {
+        std::string out = "(";
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i)
+                out += ", ";
+            out += items[i]->repr();
+        }
+        return out + (count == 1 ? ",)" : ")");
+    }
+
+    bool isTruthy() const override { return count != 0; }
+
+private:
+    size_t count;
+    PyObject **items; // inlineItems or a heap array
+    PyObject *inlineItems[inlineCapacity];
+};
+
+// ==================== PyRange ====================
+// Arithmetic progression that is never materialized; `for` loops count
+// through it natively
+class PyRange : public PyObject
+{
+public:
+    static void *operator new(size_t size) { return allocatePlain(size); }
+    static void operator delete(void *) {}
+    PyRange(long long start, long long stop, long long step)
+        : PyObject(ObjectKind::Range), start(start), stop(stop), step(step) {}
+
+    // Number of elements; the difference may not fit in a long long
+    unsigned long long length() const
+    {
+        if (step > 0 && start < stop)
+            return (static_cast<unsigned long long>(stop) - static_cast<unsigned long long>(start) - 1) /
+                       static_cast<unsigned long long>(step) + 1;
+        if (step < 0 && start > stop)
+            return (static_cast<unsigned long long>(start) - static_cast<unsigned long long>(stop) - 1) /
+                       (0ull - static_cast<unsigned long long>(step)) + 1;
+        return 0;
+    }
+
+    // Element i, for i < length(); wraps around instead of overflowing
+    long long at(unsigned long long i) const
+    {
+        return static_cast<long long>(static_cast<unsigned long long>(start) + i * static_cast<unsigned long long>(step));
+    }
+
+    std::string toString() const override
+    {
+        std::string out = "range(" + intToString(start) + ", " + intToString(stop);
+        if (step != 1)
+            out += ", " + intToString(step);
+        return out + ")";
+    }
+
+    bool isTruthy() const override { return length() != 0; }
+    const long long start, stop, step;
+};
+
+// ==================== PyArray ====================
+// array('d', ...) or array('q', ...): unboxed doubles or 64-bit ints in
+// one contiguous block, for the vectorized builtins. Only the vector
+// matching the typecode is used.
+class PyArray : public PyObject
+{
+public:
+    PyArray(char typecode, size_t size) : PyObject(ObjectKind::Array), typecode(typecode)
+    {
+        if (isFloat())
+            floats.resize(size);
+        else
+            ints.resize(size);
+    }
+
+    bool isFloat() const { return typecode == 'd'; }
+    size_t size() const { return isFloat() ? floats.size() : ints.size(); }
+
+    std::string toString() const override
+    {
+        std::string out = "array('";
+        out += typecode;
+        out += "'";
+        if (size() == 0)
+            return out + ")";
+        out += ", [";
+        for (size_t i = 0; i < size(); ++i)
+        {
+            if (i)
+                out += ", ";
+            out += isFloat() ? floatToString(floats[i]) : intToString(ints[i]);
+        }
+        return out + "])";
+    }
+
+    bool isTruthy() const override { return size() != 0; }
+    const char typecode; // 'd' or 'q'
+    std::vector<double> floats;
+    std::vector<long long> ints;
+};
+
+// ==================== PyDict ====================
+// Keys compare by value with Python's numeric rules, so 1, 1.0 and True
+// are the same key; everything else except strings and None compares by
+// identity. Tuples hash and compare element-wise. Lists and dicts are
+// mutable and cannot be keys.
+struct PyKeyHash
+{
+    static size_t numberHash(double value)
+    {
+        if (value == 0.0)
+            return 0; // -0.0 == 0.0
+        if (value == static_cast<double>(static_cast<long long>(value)) && value >= -9223372036854775808.0 &&
+            value < 9223372036854775808.0)
+            return static_cast<size_t>(static_cast<long long>(value));
+        return std::hash<double>()(value);
+    }
+
+    size_t operator()(PyObject *key) const
+    {
+        switch (key->kind)
+        {
+        case ObjectKind::Int:
+        {
+            auto value = static_cast<PyInt *>(key);
+            return value->big ? numberHash(value->big->toDouble()) : static_cast<size_t>(value->value);
+        }
+        case ObjectKind::Bool:
+            return static_cast<PyBool *>(key)->value ? 1 : 0;
+        case ObjectKind::Float:
+            return numberHash(static_cast<PyFloat *>(key)->value);
+        case ObjectKind::Str:
+            return static_cast<PyStr *>(key)->hash();
+        case ObjectKind::None:
+            return 0x9e3779b9;
+        case ObjectKind::Tuple:
+        {
+            size_t hash = 0x345678;
+            for (PyObject *item : *static_cast<PyTuple *>(key))
+                hash = (hash ^ (*this)(item)) * 1000003;
+            return hash;
+        }
+        case ObjectKind::List:
+        case ObjectKind::Dict:
+            throw std::runtime_error("Unhashable type: lists and dicts cannot be dict keys");
+        default:
+            return std::hash<PyObject *>()(key);
+        }
+    }
+};
+
+struct PyKeyEqual
+{
+    static bool isNumber(PyObject *obj)
+    {
+        return obj->kind == ObjectKind::Int || obj->kind == ObjectKind::Bool || obj->kind == ObjectKind::Float;
+    }
+
+    static double toNumber(PyObject *obj)
+    {
+        if (obj->kind == ObjectKind::Int)
+            return static_cast<PyInt *>(obj)->toDouble();
+        if (obj->kind == ObjectKind::Bool)
+            return static_cast<PyBool *>(obj)->value ? 1.0 : 0.0;
+        return static_cast<PyFloat *>(obj)->value;
+    }
+
+    bool operator()(PyObject *a, PyObject *b) const
+    {
+        if (a == b)
+            return true;
+        if (a->kind == ObjectKind::Str)
+            return b->kind == ObjectKind::Str && static_cast<PyStr *>(a)->view() == static_cast<PyStr *>(b)->view();
+        if (a->kind == ObjectKind::Int && b->kind == ObjectKind::Int)
+        {
+            auto x = static_cast<PyInt *>(a), y = static_cast<PyInt *>(b);
+            if (x->big || y->big)
+                return x->big && y->big && BigInt::compare(*x->big, *y->big) == 0;
+            return x->value == y->value;
+        }
+        if (isNumber(a) && isNumber(b))
+            return toNumber(a) == toNumber(b);
+        if (a->kind == ObjectKind::Tuple)
+        {
+            if (b->kind != ObjectKind::Tuple)
+                return false;
+            auto x = static_cast<PyTuple *>(a), y = static_cast<PyTuple *>(b);
+            if (x->size() != y->size())
+                return false;
+            for (size_t i = 0; i < x->size(); ++i)
+                if (!(*this)((*x)[i], (*y)[i]))
+                    return false;
+            return true;
+        }
+        return a->kind == ObjectKind::None && b->kind == ObjectKind::None;
+    }
+};
+
+class PyDict : public PyObject
+{
+public:
+    PyDict() : PyObject(ObjectKind::Dict) {}
+
+    std::string toString() const override
+    {
+        if (printing)
+            return "{...}"; // The dict contains itself
+        printing = true;
+        std::string out = "{";
+        bool first = true;
+        for (auto &entry : items)
+        {
+            if (!first)
+                out += ", ";
+            first = false;
+            out += entry.first->repr() + ": " + entry.second->repr();
+        }
+        printing = false;
+        return out + "}";
+    }
+
+    bool isTruthy() const override { return !items.empty(); }
+    HashTable<PyObject *, PyObject *, PyKeyHash, PyKeyEqual> items;
+
+private:
+    mutable bool printing = false;
+};
+
+using AttributeTable = HashTable<std::string, std::shared_ptr<PyObject>>;
+
 // ==================== PyClass ====================
 class PyClass : public PyObject
 {
 public:
     std::string name;
-    std::map<std::string, std::shared_ptr<PyObject>> methods;
+    AttributeTable methods;
 
-    PyClass(const std::string &name) : name(name) {}
+    PyClass(const std::string &name) : PyObject(ObjectKind::Class), name(name) {}
 
     // Copy constructor - needed for make_shared<PyClass>(*klass)
-    PyClass(const PyClass &other) : name(other.name), methods(other.methods) {}
+    PyClass(const PyClass &other) : PyObject(ObjectKind::Class), name(other.name), methods(other.methods) {}
 
     std::shared_ptr<PyObject> get(const std::string &name)
     {
-        auto it = methods.find(name);
-        if (it != methods.end())
-        {
-            return it->second;
-        }
+        if (auto method = methods.find(name))
+            return *method;
         throw std::runtime_error("Method '" + name + "' not found");
     }
 
     void set(const std::string &name, std::shared_ptr<PyObject> value)
     {
-        methods[name] = value;
+        methods.insert(name, value);
     }
 
     std::string toString() const override
@@ -141,32 +671,26 @@ class PyInstance : public PyObject
 {
 public:
     std::shared_ptr<PyClass> klass; // Changed from raw pointer
-    std::map<std::string, std::shared_ptr<PyObject>> attributes;
+    AttributeTable attributes;
 
-    PyInstance(std::shared_ptr<PyClass> klass) : klass(klass) {}
+    PyInstance(std::shared_ptr<PyClass> klass) : PyObject(ObjectKind::Instance), klass(klass) {}
 
     std::shared_ptr<PyObject> get(const std::string &name)
     {
         // First check instance attributes
-        auto it = attributes.find(name);
-        if (it != attributes.end())
-        {
-            return it->second;
-        }
+        if (auto attribute = attributes.find(name))
+            return *attribute;
 
         // Then check class methods
-        auto method_it = klass->methods.find(name);
-        if (method_it != klass->methods.end())
-        {
-            return method_it->second;
-        }
+        if (auto method = klass->methods.find(name))
+            return *method;
 
         throw std::runtime_error("Attribute '" + name + "' not found");
     }
 
     void set(const std::string &name, std::shared_ptr<PyObject> value)
     {
-        attributes[name] = value;
+        attributes.insert(name, value);
     }
 
     std::string toString() const override
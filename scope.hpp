@@ -1,6 +1,5 @@
 #pragma once
 
-#include <unordered_map>
 #include <memory>
 #include <string>
 #include "pyobject.hpp"
@@ -14,16 +13,16 @@ public:
     {
         // Create non-owning shared_ptr to avoid double-delete
         // The caller is responsible for memory management
-        variables[name] = std::shared_ptr<PyObject>(value, [](PyObject *) {
+        variables.insert(name, std::shared_ptr<PyObject>(value, [](PyObject *) {
             // Empty deleter - don't actually delete
-        });
+        }));
     }
 
     PyObject *get(const std::string &name)
     {
-        if (variables.find(name) != variables.end())
+        if (auto variable = variables.find(name))
         {
-            return variables[name].get();
+            return variable->get();
         }
         if (enclosing != nullptr)
         {
@@ -34,26 +33,41 @@ public:
 
     void set(const std::string &name, PyObject *value)
     {
-        if (variables.find(name) != variables.end())
+        if (auto variable = find(name))
         {
-            variables[name] = std::shared_ptr<PyObject>(value, [](PyObject *) {});
-            return;
-        }
-        if (enclosing != nullptr)
-        {
-            enclosing->set(name, value);
+            *variable = std::shared_ptr<PyObject>(value, [](PyObject *) {});
             return;
         }
         // If not found anywhere, create in current scope
         define(name, value);
     }
 
-    const std::unordered_map<std::string, std::shared_ptr<PyObject>> &getVariables() const
+    // The binding get() would read, or nullptr if `name` is unbound. It
+    // stays valid until a name is added to the scope that holds it.
+    std::shared_ptr<PyObject> *find(const std::string &name)
+    {
+        if (auto variable = variables.find(name))
+            return variable;
+        return enclosing ? enclosing->find(name) : nullptr;
+    }
+
+    // Whether `name` is bound in this scope itself
+    bool hasLocal(const std::string &name) const
+    {
+        return variables.contains(name);
+    }
+
+    const AttributeTable &getVariables() const
     {
         return variables;
     }
 
+    Scope *getEnclosing() const
+    {
+        return enclosing;
+    }
+
 private:
     Scope *enclosing;
-    std::unordered_map<std::string, std::shared_ptr<PyObject>> variables;
+    AttributeTable variables;
 };
\ No newline at end of file
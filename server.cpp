@@ -0,0 +1,446 @@
+#include "server.hpp"
+#include "embed.hpp"
+#include "output.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+// ==================== Wire Format ====================
+
+static std::runtime_error socketError(const char *what)
+{
+    return std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+}
+
+static void sendAll(int fd, const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw socketError("Send failed");
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+}
+
+// False if the stream ends before the first byte; a stream that ends
+// later is an error
+static bool receiveAll(int fd, char *data, size_t size)
+{
+    size_t received = 0;
+    while (received < size)
+    {
+        ssize_t count = ::recv(fd, data + received, size - received, 0);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw socketError("Receive failed");
+        }
+        if (count == 0)
+        {
+            if (received == 0)
+                return false;
+            throw std::runtime_error("Connection closed mid-message");
+        }
+        received += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+static void putLength(char *out, size_t length)
+{
+    for (int i = 0; i < 4; ++i)
+        out[i] = static_cast<char>((length >> (24 - 8 * i)) & 0xff);
+}
+
+static size_t getLength(const char *in)
+{
+    size_t length = 0;
+    for (int i = 0; i < 4; ++i)
+        length = (length << 8) | static_cast<unsigned char>(in[i]);
+    return length;
+}
+
+int wire::connectTo(const std::string &socketPath)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("Socket path too long: " + socketPath);
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw socketError("Cannot create socket");
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        std::runtime_error error = socketError(("Cannot connect to " + socketPath).c_str());
+        ::close(fd);
+        throw error;
+    }
+    return fd;
+}
+
+void wire::sendRequest(int fd, std::string_view source)
+{
+    if (source.size() > maxRequest)
+        throw std::runtime_error("Script too large to send");
+    char header[4];
+    putLength(header, source.size());
+    sendAll(fd, header, sizeof(header));
+    sendAll(fd, source.data(), source.size());
+}
+
+bool wire::readRequest(int fd, std::string &source)
+{
+    char header[4];
+    if (!receiveAll(fd, header, sizeof(header)))
+        return false;
+    size_t length = getLength(header);
+    if (length > maxRequest)
+        throw std::runtime_error("Request too large");
+    source.resize(length);
+    if (length > 0 && !receiveAll(fd, source.data(), length))
+        throw std::runtime_error("Connection closed mid-message");
+    return true;
+}
+
+void wire::sendFrame(int fd, char type, std::string_view payload)
+{
+    char header[5];
+    header[0] = type;
+    putLength(header + 1, payload.size());
+    sendAll(fd, header, sizeof(header));
+    sendAll(fd, payload.data(), payload.size());
+}
+
+bool wire::readFrame(int fd, char &type, std::string &payload)
+{
+    char header[5];
+    if (!receiveAll(fd, header, sizeof(header)))
+        return false;
+    type = header[0];
+    payload.resize(getLength(header + 1));
+    if (!payload.empty() && !receiveAll(fd, payload.data(), payload.size()))
+        throw std::runtime_error("Connection closed mid-message");
+    return true;
+}
+
+// ==================== Server ====================
+
+namespace
+{
+// A compiled script and the type feedback its latest run ended with
+struct CachedProgram
+{
+    std::shared_ptr<Program> program;
+    std::mutex lock; // Guards the feedback
+    Profile profile;
+    bool warmed = false;
+};
+
+class ProgramCache
+{
+public:
+    ProgramCache(const ServerOptions &options, const Program &prelude) : options(options), prelude(prelude)
+    {
+    }
+
+    // Compiles outside the lock, so a slow compile holds up no other
+    // request; of two requests that compile one script at once, the first
+    // to finish is kept
+    std::shared_ptr<CachedProgram> get(const std::string &source)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto found = programs.find(source);
+            if (found != programs.end())
+                return found->second;
+        }
+        auto entry = std::make_shared<CachedProgram>();
+        entry->program = Program::compile(source, options.optimizer, prelude);
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (programs.size() >= options.cacheLimit)
+            programs.clear(); // Running requests keep their entries alive
+        return programs.emplace(source, entry).first->second;
+    }
+
+private:
+    const ServerOptions &options;
+    const Program &prelude; // Scripts are compiled to follow it
+    std::mutex lock;
+    std::unordered_map<std::string, std::shared_ptr<CachedProgram>> programs;
+};
+
+// Sends the thread's stdout to the client as 'O' frames while alive
+class StreamOutput
+{
+public:
+    explicit StreamOutput(int client)
+    {
+        Output::standard().capture([client](std::string_view text) { wire::sendFrame(client, 'O', text); });
+    }
+    ~StreamOutput()
+    {
+        Output &out = Output::standard();
+        try
+        {
+            out.capture(nullptr);
+        }
+        catch (const std::runtime_error &)
+        {
+            // The client is gone; the failed flush emptied the buffer
+            out.capture(nullptr);
+        }
+    }
+    StreamOutput(const StreamOutput &) = delete;
+    StreamOutput &operator=(const StreamOutput &) = delete;
+};
+}
+
+static void sendFailure(int client, const std::string &error)
+{
+    wire::sendFrame(client, 'E', error);
+    wire::sendFrame(client, 'X', std::string_view("\1", 1));
+}
+
+// Runs one request's script, streaming its output, then sends its
+// error if any and its exit status
+static void respond(int client, const std::function<void()> &run)
+{
+    bool failed = false;
+    std::string error;
+    {
+        StreamOutput stream(client);
+        try
+        {
+            run();
+            Output::standard().flush();
+        }
+        catch (const std::exception &e)
+        {
+            failed = true;
+            error = e.what();
+        }
+    }
+    // After the stream is closed, so output printed before the error
+    // arrives first
+    if (failed)
+        sendFailure(client, error);
+    else
+        wire::sendFrame(client, 'X', std::string_view("\0", 1));
+}
+
+// Frames are flushed whole: line buffering would send a frame a line
+static void bufferForFrames()
+{
+    Output &out = Output::standard();
+    if (out.mode() == Output::Mode::Line)
+        out.setMode(Output::Mode::Full);
+}
+
+// Each request starts from a copy of the session that ran the prelude
+static void serveConnection(int client, ProgramCache &cache, const Session &prelude)
+{
+    bufferForFrames();
+    try
+    {
+        std::string source;
+        while (wire::readRequest(client, source))
+            respond(client, [&]
+            {
+                std::shared_ptr<CachedProgram> entry = cache.get(source);
+                Session session(prelude);
+                {
+                    std::lock_guard<std::mutex> guard(entry->lock);
+                    if (entry->warmed)
+                        session.profile() = entry->profile;
+                }
+                session.run(entry->program);
+                std::lock_guard<std::mutex> guard(entry->lock);
+                entry->profile = session.profile();
+                entry->warmed = true;
+            });
+    }
+    catch (const std::exception &)
+    {
+        // The client went away or broke the protocol; drop the connection
+    }
+    ::close(client);
+}
+
+// ==================== Zygote ====================
+// With `--zygote` the prelude runs once, in the server process, before
+// the first connection. Each connection is served by a fork of that
+// process, which compiles the connection's scripts to follow the prelude
+// (keeping them for repeats) and runs every request in a further fork of
+// itself. A request thus starts with the prelude's functions, classes
+// and type feedback already in its session, for the price of a fork, and
+// whatever it does vanishes with its process. The server stays
+// single-threaded, as fork() requires, so pmap runs sequentially here.
+
+// Runs the request in a child and reports a child that died without
+// finishing its response
+static void respondForked(int client, Session &zygote, const std::shared_ptr<Program> &script)
+{
+    pid_t child = ::fork();
+    if (child < 0)
+        throw socketError("Cannot fork");
+    if (child == 0)
+    {
+        int status = 0;
+        try
+        {
+            respond(client, [&] { zygote.run(script); });
+        }
+        catch (const std::exception &)
+        {
+            status = 1; // The client is gone
+        }
+        std::_Exit(status);
+    }
+
+    int status;
+    while (::waitpid(child, &status, 0) < 0)
+        if (errno != EINTR)
+            throw socketError("Cannot wait for request process");
+    if (WIFSIGNALED(status))
+        sendFailure(client, "request process killed by signal " + std::to_string(WTERMSIG(status)));
+    else if (WEXITSTATUS(status) != 0)
+        throw std::runtime_error("Client gone");
+}
+
+[[noreturn]] static void serveForkedConnection(int client, Session &zygote, const ServerOptions &options)
+{
+    ::signal(SIGCHLD, SIG_DFL); // This process waits for its requests
+    std::unordered_map<std::string, std::shared_ptr<Program>> scripts;
+    try
+    {
+        std::string source;
+        while (wire::readRequest(client, source))
+        {
+            auto found = scripts.find(source);
+            if (found == scripts.end())
+            {
+                try
+                {
+                    found = scripts.emplace(source, Program::compile(source, options.optimizer, zygote.program())).first;
+                }
+                catch (const std::exception &e)
+                {
+                    sendFailure(client, e.what());
+                    continue;
+                }
+            }
+            respondForked(client, zygote, found->second);
+        }
+    }
+    catch (const std::exception &)
+    {
+        // The client went away or broke the protocol; drop the connection
+    }
+    ::close(client);
+    std::_Exit(0);
+}
+
+// ==================== Listening ====================
+
+static std::string readPrelude(const ServerOptions &options)
+{
+    if (options.preludePath.empty())
+        return "";
+    std::ifstream file(options.preludePath);
+    if (!file)
+        throw std::runtime_error("could not open prelude '" + options.preludePath + "'");
+    std::string prelude((std::istreambuf_iterator<char>(file)), {});
+    if (!prelude.empty() && prelude.back() != '\n')
+        prelude += '\n';
+    return prelude;
+}
+
+static int listenOn(const ServerOptions &options)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("Socket path too long: " + options.socketPath);
+    std::memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size() + 1);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        throw socketError("Cannot create socket");
+    ::unlink(options.socketPath.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+        throw socketError(("Cannot bind " + options.socketPath).c_str());
+    if (::listen(listener, SOMAXCONN) < 0)
+        throw socketError("Cannot listen");
+    if (options.optimizer.verbose)
+        std::cerr << "[serve] listening on " << options.socketPath << "\n";
+    return listener;
+}
+
+static int acceptClient(int listener)
+{
+    while (true)
+    {
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client >= 0)
+            return client;
+        if (errno != EINTR && errno != ECONNABORTED)
+            throw socketError("Accept failed");
+    }
+}
+
+void serve(const ServerOptions &options)
+{
+    // The prelude runs once, before the first connection, and its output
+    // goes to the server's own stdout rather than to any client
+    Session prelude(Program::compile(readPrelude(options), options.optimizer));
+    prelude.run();
+    Output::standard().flush(); // Or every fork would print it again
+    if (!options.zygote)
+    {
+        prelude.freeze();
+        ProgramCache cache(options, prelude.program());
+        int listener = listenOn(options);
+        while (true)
+            std::thread(serveConnection, acceptClient(listener), std::ref(cache), std::cref(prelude)).detach();
+    }
+
+    bufferForFrames();
+    int listener = listenOn(options);
+    ::signal(SIGCHLD, SIG_IGN); // Connection processes are not waited for
+    while (true)
+    {
+        int client = acceptClient(listener);
+        pid_t child = ::fork();
+        if (child == 0)
+        {
+            ::close(listener);
+            serveForkedConnection(client, prelude, options);
+        }
+        if (child < 0)
+            std::cerr << "[serve] " << socketError("Cannot fork").what() << "\n";
+        ::close(client);
+    }
+}
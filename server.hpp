@@ -0,0 +1,58 @@
+#pragma once
+
+#include "optimizer.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// ==================== Server Mode ====================
+// `--serve path` keeps one warm process answering script requests on a
+// Unix domain socket, so a short script costs neither process start-up
+// nor compilation once it has been seen. Each connection is served on a
+// thread of its own and may send any number of requests, one after
+// another. Each request runs in a fresh Session: nothing a script
+// defines or prints reaches another request. Compiled programs are
+// cached by source text together with the type feedback of their latest
+// run, so a repeated script starts compiled and on its specialized
+// kernels. A prelude, if given, runs once at start-up, printing to the
+// server's stdout; every request starts from a copy of the globals it
+// defined, so a script may use them and change them without affecting
+// other requests. With `zygote`, requests instead start from forks of
+// the process the prelude ran in (see server.cpp).
+//
+// Protocol; lengths are 32-bit big-endian:
+//   request   length, then that many bytes of script source
+//   response  frames of a type byte, a length and a payload:
+//             'O'  stdout, as the script flushes it
+//             'E'  the error that stopped the script (what the command
+//                  line prints after "Error: ")
+//             'X'  the exit status, one byte: 0, or 1 after an error;
+//                  last frame of the response
+
+struct ServerOptions
+{
+    std::string socketPath;
+    std::string preludePath; // Empty for none
+    OptimizerOptions optimizer;
+    size_t cacheLimit = 256; // Programs kept; the cache is emptied when full
+    bool zygote = false;     // Fork per request from a process that ran the prelude
+};
+
+// Serves until the process is killed. Throws if the prelude fails to
+// compile or run, or the socket cannot be set up; a file already at the socket
+// path is replaced.
+void serve(const ServerOptions &options);
+
+// Socket helpers shared by the server and its clients. The senders throw
+// std::runtime_error on failure and never raise SIGPIPE; the readers
+// return false at a clean end of stream.
+namespace wire
+{
+constexpr size_t maxRequest = 64 * 1024 * 1024;
+
+int connectTo(const std::string &socketPath);
+void sendRequest(int fd, std::string_view source);
+bool readRequest(int fd, std::string &source);
+void sendFrame(int fd, char type, std::string_view payload);
+bool readFrame(int fd, char &type, std::string &payload);
+}
@@ -0,0 +1,769 @@
+#include "simd.hpp"
+#include <algorithm>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+// ==================== Scalar ====================
+// Reference versions; the vector versions finish their tails the same way
+static constexpr size_t partialSums = 8;
+
+// Pairs sum i with i + 4, then i with i + 2, then adds the last two,
+// which is the order the SSE2 and AVX2 registers combine in
+static double combinePartials(const double *partial)
+{
+    double c0 = partial[0] + partial[4], c1 = partial[1] + partial[5];
+    double c2 = partial[2] + partial[6], c3 = partial[3] + partial[7];
+    return (c0 + c2) + (c1 + c3);
+}
+
+static double sumFloatScalar(const double *data, size_t n)
+{
+    double partial[partialSums] = {};
+    size_t i = 0;
+    for (; i + partialSums <= n; i += partialSums)
+        for (size_t k = 0; k < partialSums; ++k)
+            partial[k] += data[i + k];
+    double total = combinePartials(partial);
+    for (; i < n; ++i)
+        total += data[i];
+    return total;
+}
+
+static __int128 sumIntScalar(const long long *data, size_t n)
+{
+    __int128 total = 0;
+    for (size_t i = 0; i < n; ++i)
+        total += data[i];
+    return total;
+}
+
+static double minFloatScalar(const double *data, size_t n)
+{
+    double result = data[0];
+    for (size_t i = 1; i < n; ++i)
+        result = data[i] < result ? data[i] : result;
+    return result;
+}
+
+static double maxFloatScalar(const double *data, size_t n)
+{
+    double result = data[0];
+    for (size_t i = 1; i < n; ++i)
+        result = data[i] > result ? data[i] : result;
+    return result;
+}
+
+static long long minIntScalar(const long long *data, size_t n)
+{
+    return *std::min_element(data, data + n);
+}
+
+static long long maxIntScalar(const long long *data, size_t n)
+{
+    return *std::max_element(data, data + n);
+}
+
+// Products and sums are rounded separately; ISO C++ mode keeps the
+// compiler from contracting them into fused multiply-adds
+static double dotFloatScalar(const double *a, const double *b, size_t n)
+{
+    double partial[partialSums] = {};
+    size_t i = 0;
+    for (; i + partialSums <= n; i += partialSums)
+        for (size_t k = 0; k < partialSums; ++k)
+            partial[k] += a[i + k] * b[i + k];
+    double total = combinePartials(partial);
+    for (; i < n; ++i)
+        total += a[i] * b[i];
+    return total;
+}
+
+static void addFloatScalar(const double *a, const double *b, double *out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = a[i] + b[i];
+}
+
+static void mulFloatScalar(const double *a, const double *b, double *out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = a[i] * b[i];
+}
+
+static void scaleFloatScalar(const double *a, double factor, double *out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = a[i] * factor;
+}
+
+static bool addIntScalar(const long long *a, const long long *b, long long *out, size_t n)
+{
+    bool overflow = false;
+    for (size_t i = 0; i < n; ++i)
+        overflow |= __builtin_add_overflow(a[i], b[i], &out[i]);
+    return !overflow;
+}
+
+// Continues a prefix sum from `carry`
+static bool prefixSumIntTail(const long long *data, long long *out, size_t n, long long carry)
+{
+    bool overflow = false;
+    for (size_t i = 0; i < n; ++i)
+    {
+        overflow |= __builtin_add_overflow(carry, data[i], &carry);
+        out[i] = carry;
+    }
+    return !overflow;
+}
+
+static bool prefixSumIntScalar(const long long *data, long long *out, size_t n)
+{
+    return prefixSumIntTail(data, out, n, 0);
+}
+
+bool mulInt(const long long *a, const long long *b, long long *out, size_t n)
+{
+    bool overflow = false;
+    for (size_t i = 0; i < n; ++i)
+        overflow |= __builtin_mul_overflow(a[i], b[i], &out[i]);
+    return !overflow;
+}
+
+bool scaleInt(const long long *a, long long factor, long long *out, size_t n)
+{
+    bool overflow = false;
+    for (size_t i = 0; i < n; ++i)
+        overflow |= __builtin_mul_overflow(a[i], factor, &out[i]);
+    return !overflow;
+}
+
+bool dotInt(const long long *a, const long long *b, size_t n, __int128 &out)
+{
+    __int128 total = 0;
+    for (size_t i = 0; i < n; ++i)
+        if (__builtin_add_overflow(total, static_cast<__int128>(a[i]) * b[i], &total))
+            return false;
+    out = total;
+    return true;
+}
+
+void prefixSumFloat(const double *data, double *out, size_t n)
+{
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        total += data[i];
+        out[i] = total;
+    }
+}
+
+static const ArrayKernels scalarKernels = {
+    SimdLevel::Scalar, "scalar",
+    sumFloatScalar, sumIntScalar, minFloatScalar, maxFloatScalar, minIntScalar, maxIntScalar, dotFloatScalar,
+    addFloatScalar, mulFloatScalar, scaleFloatScalar, addIntScalar, prefixSumIntScalar};
+
+#ifdef SIMD_X86
+// Exact integer sums split every element into its low and high 32 bits
+// and its sign, which 64-bit lanes can add up without overflowing for
+// this many elements at a time
+static constexpr size_t sumChunk = size_t(1) << 30;
+
+static __int128 exactTotal(const unsigned long long *low, const unsigned long long *high,
+                           const unsigned long long *negative, size_t lanes)
+{
+    unsigned __int128 lowSum = 0, highSum = 0, negativeSum = 0;
+    for (size_t k = 0; k < lanes; ++k)
+    {
+        lowSum += low[k];
+        highSum += high[k];
+        negativeSum += negative[k];
+    }
+    return static_cast<__int128>(lowSum + (highSum << 32) - (negativeSum << 64));
+}
+
+// ==================== SSE2 ====================
+#define SSE2_TARGET __attribute__((target("sse2")))
+
+SSE2_TARGET static double sumFloatSSE2(const double *data, size_t n)
+{
+    __m128d r0 = _mm_setzero_pd(), r1 = r0, r2 = r0, r3 = r0;
+    size_t i = 0;
+    for (; i + partialSums <= n; i += partialSums)
+    {
+        r0 = _mm_add_pd(r0, _mm_loadu_pd(data + i));
+        r1 = _mm_add_pd(r1, _mm_loadu_pd(data + i + 2));
+        r2 = _mm_add_pd(r2, _mm_loadu_pd(data + i + 4));
+        r3 = _mm_add_pd(r3, _mm_loadu_pd(data + i + 6));
+    }
+    __m128d pairs = _mm_add_pd(_mm_add_pd(r0, r2), _mm_add_pd(r1, r3));
+    double total = _mm_cvtsd_f64(pairs) + _mm_cvtsd_f64(_mm_unpackhi_pd(pairs, pairs));
+    for (; i < n; ++i)
+        total += data[i];
+    return total;
+}
+
+SSE2_TARGET static __int128 sumIntSSE2(const long long *data, size_t n)
+{
+    const __m128i lowMask = _mm_set1_epi64x(0xFFFFFFFF);
+    __int128 total = 0;
+    size_t i = 0;
+    while (i + 2 <= n)
+    {
+        size_t end = std::min(n & ~size_t(1), i + sumChunk);
+        __m128i low = _mm_setzero_si128(), high = low, negative = low;
+        for (; i < end; i += 2)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            low = _mm_add_epi64(low, _mm_and_si128(x, lowMask));
+            high = _mm_add_epi64(high, _mm_srli_epi64(x, 32));
+            negative = _mm_add_epi64(negative, _mm_srli_epi64(x, 63));
+        }
+        unsigned long long lanes[3][2];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes[0]), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes[1]), high);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes[2]), negative);
+        total += exactTotal(lanes[0], lanes[1], lanes[2], 2);
+    }
+    return total + sumIntScalar(data + i, n - i);
+}
+
+SSE2_TARGET static double minFloatSSE2(const double *data, size_t n)
+{
+    __m128d result = _mm_set1_pd(data[0]);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        result = _mm_min_pd(_mm_loadu_pd(data + i), result);
+    double lanes[2];
+    _mm_storeu_pd(lanes, result);
+    double best = lanes[1] < lanes[0] ? lanes[1] : lanes[0];
+    return i < n ? std::min(best, minFloatScalar(data + i, n - i)) : best;
+}
+
+SSE2_TARGET static double maxFloatSSE2(const double *data, size_t n)
+{
+    __m128d result = _mm_set1_pd(data[0]);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        result = _mm_max_pd(_mm_loadu_pd(data + i), result);
+    double lanes[2];
+    _mm_storeu_pd(lanes, result);
+    double best = lanes[1] > lanes[0] ? lanes[1] : lanes[0];
+    return i < n ? std::max(best, maxFloatScalar(data + i, n - i)) : best;
+}
+
+SSE2_TARGET static double dotFloatSSE2(const double *a, const double *b, size_t n)
+{
+    __m128d r0 = _mm_setzero_pd(), r1 = r0, r2 = r0, r3 = r0;
+    size_t i = 0;
+    for (; i + partialSums <= n; i += partialSums)
+    {
+        r0 = _mm_add_pd(r0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        r1 = _mm_add_pd(r1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+        r2 = _mm_add_pd(r2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+        r3 = _mm_add_pd(r3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+    }
+    __m128d pairs = _mm_add_pd(_mm_add_pd(r0, r2), _mm_add_pd(r1, r3));
+    double total = _mm_cvtsd_f64(pairs) + _mm_cvtsd_f64(_mm_unpackhi_pd(pairs, pairs));
+    for (; i < n; ++i)
+        total += a[i] * b[i];
+    return total;
+}
+
+SSE2_TARGET static void addFloatSSE2(const double *a, const double *b, double *out, size_t n)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    addFloatScalar(a + i, b + i, out + i, n - i);
+}
+
+SSE2_TARGET static void mulFloatSSE2(const double *a, const double *b, double *out, size_t n)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    mulFloatScalar(a + i, b + i, out + i, n - i);
+}
+
+SSE2_TARGET static void scaleFloatSSE2(const double *a, double factor, double *out, size_t n)
+{
+    __m128d k = _mm_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), k));
+    scaleFloatScalar(a + i, factor, out + i, n - i);
+}
+
+// A signed sum overflowed iff both operands differ in sign from it
+SSE2_TARGET static bool addIntSSE2(const long long *a, const long long *b, long long *out, size_t n)
+{
+    __m128i overflow = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        __m128i sum = _mm_add_epi64(x, y);
+        overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_xor_si128(x, sum), _mm_xor_si128(y, sum)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), sum);
+    }
+    bool ok = _mm_movemask_pd(_mm_castsi128_pd(overflow)) == 0;
+    return addIntScalar(a + i, b + i, out + i, n - i) && ok;
+}
+
+// Scans two elements per step: [a, b] becomes [a, a + b], then the
+// running total is added to both. Each output is checked against the one
+// before it, so wrapping in the in-register partial sums is harmless.
+SSE2_TARGET static bool prefixSumIntSSE2(const long long *data, long long *out, size_t n)
+{
+    __m128i carry = _mm_setzero_si128(), overflow = carry;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i x = _mm_add_epi64(in, _mm_slli_si128(in, 8));
+        x = _mm_add_epi64(x, carry);
+        __m128i previous = _mm_unpacklo_epi64(carry, x);
+        overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_xor_si128(previous, x), _mm_xor_si128(in, x)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), x);
+        carry = _mm_unpackhi_epi64(x, x);
+    }
+    bool ok = _mm_movemask_pd(_mm_castsi128_pd(overflow)) == 0;
+    return prefixSumIntTail(data + i, out + i, n - i, i ? out[i - 1] : 0) && ok;
+}
+
+// SSE2 has no 64-bit compare, so integer min and max stay scalar
+static const ArrayKernels sse2Kernels = {
+    SimdLevel::SSE2, "sse2",
+    sumFloatSSE2, sumIntSSE2, minFloatSSE2, maxFloatSSE2, minIntScalar, maxIntScalar, dotFloatSSE2,
+    addFloatSSE2, mulFloatSSE2, scaleFloatSSE2, addIntSSE2, prefixSumIntSSE2};
+
+// ==================== AVX2 ====================
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static double sumFloatAVX2(const double *data, size_t n)
+{
+    __m256d r0 = _mm256_setzero_pd(), r1 = r0;
+    size_t i = 0;
+    for (; i + partialSums <= n; i += partialSums)
+    {
+        r0 = _mm256_add_pd(r0, _mm256_loadu_pd(data + i));
+        r1 = _mm256_add_pd(r1, _mm256_loadu_pd(data + i + 4));
+    }
+    __m256d quads = _mm256_add_pd(r0, r1);
+    __m128d pairs = _mm_add_pd(_mm256_castpd256_pd128(quads), _mm256_extractf128_pd(quads, 1));
+    double total = _mm_cvtsd_f64(pairs) + _mm_cvtsd_f64(_mm_unpackhi_pd(pairs, pairs));
+    for (; i < n; ++i)
+        total += data[i];
+    return total;
+}
+
+AVX2_TARGET static __int128 sumIntAVX2(const long long *data, size_t n)
+{
+    const __m256i lowMask = _mm256_set1_epi64x(0xFFFFFFFF);
+    __int128 total = 0;
+    size_t i = 0;
+    while (i + 4 <= n)
+    {
+        size_t end = std::min(n & ~size_t(3), i + sumChunk);
+        __m256i low = _mm256_setzero_si256(), high = low, negative = low;
+        for (; i < end; i += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            low = _mm256_add_epi64(low, _mm256_and_si256(x, lowMask));
+            high = _mm256_add_epi64(high, _mm256_srli_epi64(x, 32));
+            negative = _mm256_add_epi64(negative, _mm256_srli_epi64(x, 63));
+        }
+        unsigned long long lanes[3][4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes[0]), low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes[1]), high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes[2]), negative);
+        total += exactTotal(lanes[0], lanes[1], lanes[2], 4);
+    }
+    return total + sumIntScalar(data + i, n - i);
+}
+
+AVX2_TARGET static double minFloatAVX2(const double *data, size_t n)
+{
+    __m256d result = _mm256_set1_pd(data[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        result = _mm256_min_pd(_mm256_loadu_pd(data + i), result);
+    double lanes[4];
+    _mm256_storeu_pd(lanes, result);
+    double best = minFloatScalar(lanes, 4);
+    return i < n ? std::min(best, minFloatScalar(data + i, n - i)) : best;
+}
+
+AVX2_TARGET static double maxFloatAVX2(const double *data, size_t n)
+{
+    __m256d result = _mm256_set1_pd(data[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        result = _mm256_max_pd(_mm256_loadu_pd(data + i), result);
+    double lanes[4];
+    _mm256_storeu_pd(lanes, result);
+    double best = maxFloatScalar(lanes, 4);
+    return i < n ? std::max(best, maxFloatScalar(data + i, n - i)) : best;
+}
+
+AVX2_TARGET static long long minIntAVX2(const long long *data, size_t n)
+{
+    __m256i result = _mm256_set1_epi64x(data[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        result = _mm256_blendv_epi8(result, x, _mm256_cmpgt_epi64(result, x));
+    }
+    long long lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), result);
+    long long best = minIntScalar(lanes, 4);
+    return i < n ? std::min(best, minIntScalar(data + i, n - i)) : best;
+}
+
+AVX2_TARGET static long long maxIntAVX2(const long long *data, size_t n)
+{
+    __m256i result = _mm256_set1_epi64x(data[0]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        result = _mm256_blendv_epi8(result, x, _mm256_cmpgt_epi64(x, result));
+    }
+    long long lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), result);
+    long long best = maxIntScalar(lanes, 4);
+    return i < n ? std::max(best, maxIntScalar(data + i, n - i)) : best;
+}
+
+AVX2_TARGET static double dotFloatAVX2(const double *a, const double *b, size_t n)
+{
+    __m256d r0 = _mm256_setzero_pd(), r1 = r0;
+    size_t i = 0;
+    for (; i + partialSums <= n; i += partialSums)
+    {
+        r0 = _mm256_add_pd(r0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        r1 = _mm256_add_pd(r1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    __m256d quads = _mm256_add_pd(r0, r1);
+    __m128d pairs = _mm_add_pd(_mm256_castpd256_pd128(quads), _mm256_extractf128_pd(quads, 1));
+    double total = _mm_cvtsd_f64(pairs) + _mm_cvtsd_f64(_mm_unpackhi_pd(pairs, pairs));
+    for (; i < n; ++i)
+        total += a[i] * b[i];
+    return total;
+}
+
+AVX2_TARGET static void addFloatAVX2(const double *a, const double *b, double *out, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    addFloatScalar(a + i, b + i, out + i, n - i);
+}
+
+AVX2_TARGET static void mulFloatAVX2(const double *a, const double *b, double *out, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    mulFloatScalar(a + i, b + i, out + i, n - i);
+}
+
+AVX2_TARGET static void scaleFloatAVX2(const double *a, double factor, double *out, size_t n)
+{
+    __m256d k = _mm256_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), k));
+    scaleFloatScalar(a + i, factor, out + i, n - i);
+}
+
+AVX2_TARGET static bool addIntAVX2(const long long *a, const long long *b, long long *out, size_t n)
+{
+    __m256i overflow = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i sum = _mm256_add_epi64(x, y);
+        overflow = _mm256_or_si256(overflow, _mm256_and_si256(_mm256_xor_si256(x, sum), _mm256_xor_si256(y, sum)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), sum);
+    }
+    bool ok = _mm256_movemask_pd(_mm256_castsi256_pd(overflow)) == 0;
+    return addIntScalar(a + i, b + i, out + i, n - i) && ok;
+}
+
+// As prefixSumIntSSE2, in two shift-and-add steps over four lanes
+AVX2_TARGET static bool prefixSumIntAVX2(const long long *data, long long *out, size_t n)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i carry = zero, overflow = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        // [a b c d] + [0 a b c], then + [0 0 a a+b]
+        __m256i x = _mm256_add_epi64(
+            in, _mm256_blend_epi32(_mm256_permute4x64_epi64(in, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+        x = _mm256_add_epi64(
+            x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+        x = _mm256_add_epi64(x, carry);
+        __m256i previous = _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 3)), carry, 0x03);
+        overflow = _mm256_or_si256(overflow,
+                                   _mm256_and_si256(_mm256_xor_si256(previous, x), _mm256_xor_si256(in, x)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), x);
+        carry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    bool ok = _mm256_movemask_pd(_mm256_castsi256_pd(overflow)) == 0;
+    return prefixSumIntTail(data + i, out + i, n - i, i ? out[i - 1] : 0) && ok;
+}
+
+static const ArrayKernels avx2Kernels = {
+    SimdLevel::AVX2, "avx2",
+    sumFloatAVX2, sumIntAVX2, minFloatAVX2, maxFloatAVX2, minIntAVX2, maxIntAVX2, dotFloatAVX2,
+    addFloatAVX2, mulFloatAVX2, scaleFloatAVX2, addIntAVX2, prefixSumIntAVX2};
+#endif
+
+// ==================== Dispatch ====================
+const ArrayKernels *arrayKernels(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return &scalarKernels;
+#ifdef SIMD_X86
+    case SimdLevel::SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2") ? &sse2Kernels : nullptr;
+    case SimdLevel::AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? &avx2Kernels : nullptr;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const ArrayKernels &arrayKernels()
+{
+    static const ArrayKernels &best = []() -> const ArrayKernels &
+    {
+        for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::SSE2})
+            if (const ArrayKernels *kernels = arrayKernels(level))
+                return *kernels;
+        return scalarKernels;
+    }();
+    return best;
+}
+
+// ==================== String Kernels ====================
+static size_t findScalar(const char *text, size_t n, const char *needle, size_t m)
+{
+    if (m > n)
+        return notFound;
+    const char *last = text + (n - m) + 1; // One past the last possible start
+    for (const char *p = text; p < last; ++p)
+    {
+        p = static_cast<const char *>(std::memchr(p, needle[0], static_cast<size_t>(last - p)));
+        if (!p)
+            return notFound;
+        if (std::memcmp(p + 1, needle + 1, m - 1) == 0)
+            return static_cast<size_t>(p - text);
+    }
+    return notFound;
+}
+
+// Picks up where a vector loop stopped at offset i
+static size_t findTail(const char *text, size_t n, const char *needle, size_t m, size_t i)
+{
+    size_t rest = findScalar(text + i, n - i, needle, m);
+    return rest == notFound ? notFound : i + rest;
+}
+
+static size_t findByte(const char *text, size_t n, char c)
+{
+    const void *p = std::memchr(text, c, n);
+    return p ? static_cast<size_t>(static_cast<const char *>(p) - text) : notFound;
+}
+
+static size_t countByteScalar(const char *text, size_t n, char c)
+{
+    return static_cast<size_t>(std::count(text, text + n, c));
+}
+
+// Bits for text[i..n), which may end anywhere inside a word
+static void spaceBitsTail(const char *text, size_t n, uint64_t *bits, size_t i)
+{
+    for (; i < n; i += 64)
+    {
+        uint64_t word = 0;
+        for (size_t k = 0; k < 64 && i + k < n; ++k)
+            word |= uint64_t(isSpaceByte(text[i + k])) << k;
+        bits[i / 64] = word;
+    }
+}
+
+static void spaceBitsScalar(const char *text, size_t n, uint64_t *bits)
+{
+    spaceBitsTail(text, n, bits, 0);
+}
+
+static const StringKernels scalarStringKernels = {
+    SimdLevel::Scalar, "scalar", findScalar, countByteScalar, spaceBitsScalar};
+
+#ifdef SIMD_X86
+// Byte counters are summed before any lane can wrap around
+static constexpr size_t countRounds = 255;
+
+// SSE2
+SSE2_TARGET static size_t findSSE2(const char *text, size_t n, const char *needle, size_t m)
+{
+    if (m == 1)
+        return findByte(text, n, needle[0]);
+    if (m > n)
+        return notFound;
+    const __m128i first = _mm_set1_epi8(needle[0]), last = _mm_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m + 15 <= n; i += 16)
+    {
+        __m128i atFirst = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i)), first);
+        __m128i atLast = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i + m - 1)), last);
+        for (unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(atFirst, atLast))); mask;
+             mask &= mask - 1)
+        {
+            size_t at = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (std::memcmp(text + at + 1, needle + 1, m - 2) == 0)
+                return at;
+        }
+    }
+    return findTail(text, n, needle, m, i);
+}
+
+SSE2_TARGET static size_t countByteSSE2(const char *text, size_t n, char c)
+{
+    const __m128i target = _mm_set1_epi8(c), zero = _mm_setzero_si128();
+    size_t total = 0, i = 0;
+    while (i + 16 <= n)
+    {
+        __m128i counts = zero;
+        for (size_t round = 0; round < countRounds && i + 16 <= n; ++round, i += 16)
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i)), target));
+        __m128i sums = _mm_sad_epu8(counts, zero);
+        total += static_cast<size_t>(_mm_extract_epi16(sums, 0) + _mm_extract_epi16(sums, 4));
+    }
+    return total + countByteScalar(text + i, n - i, c);
+}
+
+SSE2_TARGET static unsigned spaceMaskSSE2(const char *text)
+{
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+    __m128i control = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('\t' - 1)),
+                                    _mm_cmplt_epi8(block, _mm_set1_epi8('\r' + 1)));
+    __m128i separator = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('\x1c' - 1)),
+                                      _mm_cmplt_epi8(block, _mm_set1_epi8(' ' + 1)));
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(control, separator)));
+}
+
+SSE2_TARGET static void spaceBitsSSE2(const char *text, size_t n, uint64_t *bits)
+{
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+        bits[i / 64] = uint64_t(spaceMaskSSE2(text + i)) | uint64_t(spaceMaskSSE2(text + i + 16)) << 16 |
+                       uint64_t(spaceMaskSSE2(text + i + 32)) << 32 | uint64_t(spaceMaskSSE2(text + i + 48)) << 48;
+    spaceBitsTail(text, n, bits, i);
+}
+
+static const StringKernels sse2StringKernels = {
+    SimdLevel::SSE2, "sse2", findSSE2, countByteSSE2, spaceBitsSSE2};
+
+// AVX2
+AVX2_TARGET static size_t findAVX2(const char *text, size_t n, const char *needle, size_t m)
+{
+    if (m == 1)
+        return findByte(text, n, needle[0]);
+    if (m > n)
+        return notFound;
+    const __m256i first = _mm256_set1_epi8(needle[0]), last = _mm256_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m + 31 <= n; i += 32)
+    {
+        __m256i atFirst = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i)), first);
+        __m256i atLast =
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i + m - 1)), last);
+        for (unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(atFirst, atLast))); mask;
+             mask &= mask - 1)
+        {
+            size_t at = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (std::memcmp(text + at + 1, needle + 1, m - 2) == 0)
+                return at;
+        }
+    }
+    return findTail(text, n, needle, m, i);
+}
+
+AVX2_TARGET static size_t countByteAVX2(const char *text, size_t n, char c)
+{
+    const __m256i target = _mm256_set1_epi8(c), zero = _mm256_setzero_si256();
+    size_t total = 0, i = 0;
+    while (i + 32 <= n)
+    {
+        __m256i counts = zero;
+        for (size_t round = 0; round < countRounds && i + 32 <= n; ++round, i += 32)
+            counts = _mm256_sub_epi8(
+                counts, _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i)), target));
+        __m256i sums = _mm256_sad_epu8(counts, zero);
+        total += static_cast<size_t>(_mm256_extract_epi16(sums, 0) + _mm256_extract_epi16(sums, 4) +
+                                     _mm256_extract_epi16(sums, 8) + _mm256_extract_epi16(sums, 12));
+    }
+    return total + countByteScalar(text + i, n - i, c);
+}
+
+AVX2_TARGET static unsigned spaceMaskAVX2(const char *text)
+{
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text));
+    __m256i control = _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8('\t' - 1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), block));
+    __m256i separator = _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8('\x1c' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8(' ' + 1), block));
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(control, separator)));
+}
+
+AVX2_TARGET static void spaceBitsAVX2(const char *text, size_t n, uint64_t *bits)
+{
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+        bits[i / 64] = uint64_t(spaceMaskAVX2(text + i)) | uint64_t(spaceMaskAVX2(text + i + 32)) << 32;
+    spaceBitsTail(text, n, bits, i);
+}
+
+static const StringKernels avx2StringKernels = {
+    SimdLevel::AVX2, "avx2", findAVX2, countByteAVX2, spaceBitsAVX2};
+#endif
+
+const StringKernels *stringKernels(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return &scalarStringKernels;
+#ifdef SIMD_X86
+    case SimdLevel::SSE2:
+        return arrayKernels(level) ? &sse2StringKernels : nullptr;
+    case SimdLevel::AVX2:
+        return arrayKernels(level) ? &avx2StringKernels : nullptr;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const StringKernels &stringKernels()
+{
+    static const StringKernels &best = *stringKernels(arrayKernels().level);
+    return best;
+}
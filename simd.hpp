@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ==================== Array Kernels ====================
+// Loops over unboxed double and int64 arrays behind the typed-array
+// builtins. Operations with a vector form exist as scalar, SSE2 and AVX2
+// versions; the best one the CPU supports is picked once, on first use.
+//
+// Float reductions keep eight partial sums (element i goes to sum i % 8)
+// and combine them in the same order at every level, so the result does
+// not depend on which version ran. Integer results are exact: sums come
+// back as 128-bit totals and element-wise operations report overflow.
+enum class SimdLevel
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+struct ArrayKernels
+{
+    SimdLevel level;
+    const char *name;
+
+    double (*sumFloat)(const double *data, size_t n);
+    __int128 (*sumInt)(const long long *data, size_t n);
+    // n must be at least 1
+    double (*minFloat)(const double *data, size_t n);
+    double (*maxFloat)(const double *data, size_t n);
+    long long (*minInt)(const long long *data, size_t n);
+    long long (*maxInt)(const long long *data, size_t n);
+    double (*dotFloat)(const double *a, const double *b, size_t n);
+
+    // `out` may alias an input
+    void (*addFloat)(const double *a, const double *b, double *out, size_t n);
+    void (*mulFloat)(const double *a, const double *b, double *out, size_t n);
+    void (*scaleFloat)(const double *a, double factor, double *out, size_t n);
+    // False if any element overflowed, leaving `out` unspecified
+    bool (*addInt)(const long long *a, const long long *b, long long *out, size_t n);
+    bool (*prefixSumInt)(const long long *data, long long *out, size_t n);
+};
+
+// Kernels for the best level this CPU supports
+const ArrayKernels &arrayKernels();
+// Kernels for one level, or nullptr if this CPU lacks it
+const ArrayKernels *arrayKernels(SimdLevel level);
+
+// Operations without a vector form: x86 has no 64-bit integer multiply
+// before AVX-512, and a float prefix sum is kept sequential so every
+// element is the running total a Python loop would compute.
+bool mulInt(const long long *a, const long long *b, long long *out, size_t n);
+bool scaleInt(const long long *a, long long factor, long long *out, size_t n);
+// False if the total does not fit in 128 bits
+bool dotInt(const long long *a, const long long *b, size_t n, __int128 &out);
+void prefixSumFloat(const double *data, double *out, size_t n);
+
+// ==================== String Kernels ====================
+// Byte searches behind the str methods. Substring search compares the
+// needle's first and last bytes against a whole register of positions at
+// once and checks only the positions where both match; single bytes go
+// to memchr, which the C library already vectorizes. Whitespace is the
+// ASCII set str.split() and str.strip() use: \t through \r, \x1c
+// through \x1f and the space.
+constexpr size_t notFound = static_cast<size_t>(-1);
+
+struct StringKernels
+{
+    SimdLevel level;
+    const char *name;
+
+    // Offset of the first occurrence of the needle, or notFound; m >= 1
+    size_t (*find)(const char *text, size_t n, const char *needle, size_t m);
+    size_t (*countByte)(const char *text, size_t n, char c);
+    // Sets bit i % 64 of bits[i / 64] exactly when text[i] is whitespace;
+    // `bits` holds spaceWords(n) words
+    void (*spaceBits)(const char *text, size_t n, uint64_t *bits);
+};
+
+const StringKernels &stringKernels();
+const StringKernels *stringKernels(SimdLevel level);
+
+inline bool isSpaceByte(char c)
+{
+    return (c >= '\t' && c <= '\r') || (c >= '\x1c' && c <= ' ');
+}
+
+inline size_t spaceWords(size_t n) { return (n + 63) / 64; }
+
+// Calls visit(start, end) for each run of non-whitespace bytes in the
+// bits spaceBits filled, walking the edges between runs a word at a
+// time; visit returns false to stop
+template <typename Visit>
+void forEachWord(const uint64_t *bits, size_t n, Visit visit)
+{
+    uint64_t previous = 1; // As if the text followed whitespace
+    size_t start = notFound;
+    for (size_t w = 0; w < spaceWords(n); ++w)
+    {
+        uint64_t space = bits[w];
+        for (uint64_t edges = space ^ (space << 1 | previous); edges; edges &= edges - 1)
+        {
+            size_t at = w * 64 + static_cast<size_t>(__builtin_ctzll(edges));
+            if (at >= n)
+                break;
+            if (start == notFound)
+            {
+                start = at;
+            }
+            else
+            {
+                if (!visit(start, at))
+                    return;
+                start = notFound;
+            }
+        }
+        previous = space >> 63;
+    }
+    if (start != notFound)
+        visit(start, n);
+}
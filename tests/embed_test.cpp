@@ -0,0 +1,145 @@
+// Embedding API regression tests. Build and run with `make test`; prints
+// each failed check and exits non-zero if there was one.
+#include "embed.hpp"
+#include "output.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string &what)
+{
+    if (!ok)
+    {
+        std::fprintf(stderr, "FAIL: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+// The message `run` fails with, or "" if it does not throw
+template <typename Run>
+static std::string errorOf(Run run)
+{
+    try
+    {
+        run();
+    }
+    catch (const std::runtime_error &e)
+    {
+        return e.what();
+    }
+    return "";
+}
+
+// ==================== Failed Calls ====================
+// A call that throws must leave the session where it was: later runs
+// bind their globals in the session's globals, not in the failed call's
+// scope.
+
+static void failedCallKeepsGlobals()
+{
+    auto program = Program::compile("def bad(x):\n    return 1 // x\n");
+    Session session(program);
+    session.run();
+    check(errorOf([&] { session.call<long long>("bad", 0); }) != "", "bad(0) throws");
+
+    session.run(Program::compile("y = 41\ndef useY():\n    return y + 1\n", {}, *program));
+    long long result = 0;
+    check(errorOf([&] { result = session.call<long long>("useY"); }) == "" && result == 42,
+          "useY() after a failed call");
+    check(errorOf([&] { session.global("y"); }) == "", "y is a global after a failed call");
+}
+
+static void failedInitKeepsGlobals()
+{
+    auto program = Program::compile("class Box:\n    def __init__(self, x):\n        self.x = 1 // x\n");
+    Session session(program);
+    session.run();
+    check(errorOf([&] { session.call("Box", {new PyInt(0LL)}); }) != "", "Box(0) throws");
+
+    session.run(Program::compile("z = Box(1)\n", {}, *program));
+    check(errorOf([&] { session.global("z"); }) == "", "z is a global after a failed __init__");
+}
+
+// pmap runs a chunk of the items on the calling session's interpreter,
+// so a mapped function that throws there must not strand it either
+static void failedMapKeepsGlobals()
+{
+    auto program = Program::compile("def inverse(x):\n    return 12 // x\n");
+    Session session(program);
+    session.run();
+    auto failing = Program::compile("r = pmap(inverse, [1, 2, 3, 4, 0, 6, 7, 8])\n", {}, *program);
+    check(errorOf([&] { session.run(failing); }) != "", "pmap over a zero throws");
+
+    session.run(Program::compile("y = 41\ndef useY():\n    return y + 1\n", {}, *failing));
+    long long result = 0;
+    check(errorOf([&] { result = session.call<long long>("useY"); }) == "" && result == 42,
+          "useY() after a failed pmap");
+    check(errorOf([&] { session.global("y"); }) == "", "y is a global after a failed pmap");
+}
+
+// ==================== Integer Powers ====================
+
+// The value `expression` evaluates to, printed as str() would
+static std::string valueOf(const std::string &expression)
+{
+    Session session(Program::compile("result = " + expression + "\n"));
+    std::string error = errorOf([&] { session.run(); });
+    return error.empty() ? session.global("result")->toString() : "error: " + error;
+}
+
+// 0, 1 and -1 raised to exponents too large for an int64 still have
+// exact values
+static void hugeExponents()
+{
+    const char *cases[][2] = {
+        {"1 ** (2**64)", "1"},
+        {"0 ** (2**64)", "0"},
+        {"(-1) ** (2**64 + 1)", "-1"},
+        {"(-1) ** (2**64)", "1"},
+        {"0 ** 0", "1"},
+        {"2 ** -1", "0.5"},
+    };
+    for (const auto &[expression, expected] : cases)
+        check(valueOf(expression) == expected, std::string(expression) + " == " + expected);
+    check(valueOf("2 ** (2**64)") == "error: Exponent too large", "2 ** (2**64) raises");
+}
+
+// ==================== Int Formatting ====================
+
+// Ints too large for an int64 format in bases 2, 8 and 16 like small
+// ones, and zero padding follows Python's '0' flag
+static void formatBases()
+{
+    const char *cases[][2] = {
+        {"f'{2**70:x}'", "400000000000000000"},
+        {"f'{-(2**70 - 1):#X}'", "-0X3FFFFFFFFFFFFFFFFF"},
+        {"f'{2**64:o}'", "2000000000000000000000"},
+        {"f'{2**65 + 5:b}'", "100000000000000000000000000000000000000000000000000000000000000101"},
+        {"f'{2**64 + 255:_x}'", "1_0000_0000_0000_00ff"},
+        {"f'{123456789:_x}'", "75b_cd15"},
+        {"f'{-255:0=+#010_x}'", "-0x00_00ff"},
+        {"f'{2**63 - 1:040_X}'", "0_0000_0000_0000_0000_7FFF_FFFF_FFFF_FFFF"},
+        {"f'{-1:>010x}'", "00000000-1"},
+        {"f'{1234567:013,}'", "0,001,234,567"},
+    };
+    for (const auto &[expression, expected] : cases)
+        check(valueOf(expression) == expected, std::string(expression) + " == " + expected);
+}
+
+int main()
+{
+    // A pool of four, so pmap runs in parallel even on one core
+    Interpreter::setParallelism(4);
+
+    failedCallKeepsGlobals();
+    failedInitKeepsGlobals();
+    failedMapKeepsGlobals();
+    hugeExponents();
+    formatBases();
+
+    if (failures == 0)
+        std::printf("embed_test: all checks passed\n");
+    return failures == 0 ? 0 : 1;
+}
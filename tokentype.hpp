@@ -3,6 +3,8 @@
 enum class TokenType {
     // Delimiters
     LeftParen, RightParen,
+    LeftBracket, RightBracket,
+    LeftBrace, RightBrace,
     Comma, Dot, Colon,
 
     // Arithmetic Operators
@@ -11,6 +13,10 @@ enum class TokenType {
 
     // Assignment
     Assign,
+    PlusEqual, MinusEqual, StarEqual, SlashEqual, ModEqual,
+    DoubleStarEqual, DoubleSlashEqual,
+    PipeEqual, CaretEqual, AmpersandEqual,
+    LeftShiftEqual, RightShiftEqual,
 
     // Comparison
     EqualEqual, BangEqual,
@@ -24,11 +30,17 @@ enum class TokenType {
     // Literals & Identifiers
     Int, Float, String, Name,
 
+    // f-strings: FStringStart, then FStringText chunks and replacement
+    // fields, then FStringEnd. A field is FStringField (lexeme: its source
+    // text), the expression's tokens, an optional FStringConversion and an
+    // FStringSpec (lexeme: the text after ':', possibly empty).
+    FStringStart, FStringText, FStringField, FStringConversion, FStringSpec, FStringEnd,
+
     // Keywords
     True, False, None,
     And, Or, Not,
     If, Elif, Else,
-    While, Break, Continue,
+    While, For, In, Break, Continue,
     Def, Return, Class, Pass,
 
     // Built-in (optional as keyword)
@@ -0,0 +1,844 @@
+#include "typeinfer.hpp"
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+
+// ==================== Lattice ====================
+// A variable missing from `types` is Unknown. Unreachable states (after
+// return/break/continue) are the identity for join().
+struct FlowState
+{
+    bool reachable = true;
+    std::map<std::string, StaticType> types;
+
+    bool operator==(const FlowState &other) const = default;
+};
+
+static FlowState unreachableState()
+{
+    FlowState state;
+    state.reachable = false;
+    return state;
+}
+
+static FlowState join(const FlowState &a, const FlowState &b)
+{
+    if (!a.reachable)
+        return b;
+    if (!b.reachable)
+        return a;
+
+    FlowState result;
+    for (const auto &entry : a.types)
+    {
+        auto it = b.types.find(entry.first);
+        if (it != b.types.end() && it->second == entry.second)
+            result.types.insert(entry);
+    }
+    return result;
+}
+
+static bool isIntLike(StaticType type)
+{
+    return type == StaticType::Int || type == StaticType::Bool;
+}
+
+static bool isNumeric(StaticType type)
+{
+    return isIntLike(type) || type == StaticType::Float;
+}
+
+static bool isComparison(TokenType op)
+{
+    return op == TokenType::EqualEqual || op == TokenType::BangEqual ||
+           op == TokenType::Less || op == TokenType::LessEqual ||
+           op == TokenType::Greater || op == TokenType::GreaterEqual;
+}
+
+// Mirrors the dispatch in Interpreter::evaluateBinaryOp for operands
+// that are not instances (so no magic method can be involved)
+static StaticType binaryResult(TokenType op, StaticType left, StaticType right)
+{
+    if (op == TokenType::And || op == TokenType::Or)
+        return StaticType::Bool;
+    if (left == StaticType::Unknown)
+        return StaticType::Unknown;
+    if (isComparison(op))
+        return StaticType::Bool;
+    if (right == StaticType::Unknown)
+        return StaticType::Unknown;
+
+    switch (op)
+    {
+    case TokenType::Ampersand:
+    case TokenType::Pipe:
+    case TokenType::Caret:
+        if (left == StaticType::Bool && right == StaticType::Bool)
+            return StaticType::Bool;
+        return isIntLike(left) && isIntLike(right) ? StaticType::Int : StaticType::Unknown;
+    case TokenType::LeftShift:
+    case TokenType::RightShift:
+        return isIntLike(left) && isIntLike(right) ? StaticType::Int : StaticType::Unknown;
+    case TokenType::Plus:
+        if (left == StaticType::Str)
+            return right == StaticType::Str ? StaticType::Str : StaticType::Unknown; // Raises
+        break;
+    case TokenType::Star:
+        if ((left == StaticType::Str && right == StaticType::Int) ||
+            (left == StaticType::Int && right == StaticType::Str))
+            return StaticType::Str;
+        break;
+    case TokenType::Minus:
+    case TokenType::Slash:
+    case TokenType::DoubleSlash:
+    case TokenType::Mod:
+    case TokenType::DoubleStar:
+        break;
+    default:
+        return StaticType::Unknown;
+    }
+
+    if (!isNumeric(left) || !isNumeric(right))
+        return StaticType::Unknown; // Raises
+    if (op == TokenType::Slash)
+        return StaticType::Float;
+    return isIntLike(left) && isIntLike(right) ? StaticType::Int : StaticType::Float;
+}
+
+static bool isNonNegativeLiteral(AstNode *node)
+{
+    if (node->type == AstNodeType::Boolean)
+        return true;
+    return node->type == AstNodeType::Int && static_cast<IntNode *>(node)->value.lexeme[0] != '-';
+}
+
+static StaticType unaryResult(TokenType op, StaticType operand)
+{
+    if (op == TokenType::Not)
+        return StaticType::Bool;
+    if (op == TokenType::Tilde)
+        return isIntLike(operand) ? StaticType::Int : StaticType::Unknown;
+    if (op != TokenType::Minus || operand == StaticType::Unknown)
+        return StaticType::Unknown;
+    if (isIntLike(operand))
+        return StaticType::Int;
+    if (operand == StaticType::Float)
+        return StaticType::Float;
+    return StaticType::None;
+}
+
+static bool isRangeCall(AstNode *node)
+{
+    if (node->type != AstNodeType::Call)
+        return false;
+    AstNode *callee = static_cast<CallNode *>(node)->callee;
+    return callee->type == AstNodeType::Name && static_cast<NameNode *>(callee)->name.lexeme == "range";
+}
+
+// ==================== Scope Walk ====================
+// Visits node and everything evaluated in the same scope: nested function
+// and class nodes are visited but their bodies are not entered
+template <typename Fn>
+static void walkScope(AstNode *node, const Fn &fn)
+{
+    fn(node);
+    if (node->type == AstNodeType::Function || node->type == AstNodeType::Class)
+        return;
+    anyChild(node, [&fn](AstNode *child)
+             {
+        walkScope(child, fn);
+        return false; });
+}
+
+// Names bound by statements executed directly in the scope owning `node`
+static void collectScopeBindings(AstNode *node, std::set<std::string> &out)
+{
+    walkScope(node, [&out](AstNode *n)
+              {
+        forEachAssignedName(n, [&out](const std::string &name)
+                            { out.insert(name); });
+        if (n->type == AstNodeType::Function)
+            out.insert(static_cast<FunctionNode *>(n)->name);
+        else if (n->type == AstNodeType::Class)
+            out.insert(static_cast<ClassNode *>(n)->name); });
+}
+
+// Names assigned anywhere inside function or class bodies below `node`.
+// Scope::set rebinds an existing variable in an enclosing scope, so
+// running any of those bodies may change these names.
+static void collectNestedAssignments(AstNode *node, std::set<std::string> &out)
+{
+    anyChild(node, [&out](AstNode *child)
+             {
+        anyNode(child, [&out](AstNode *n)
+                {
+            if (n->type == AstNodeType::Function || n->type == AstNodeType::Class)
+            {
+                anyChild(n, [&out](AstNode *body)
+                         {
+                    anyNode(body, [&out](AstNode *inner)
+                            {
+                        forEachAssignedName(inner, [&out](const std::string &name)
+                                            { out.insert(name); });
+                        return false; });
+                    return false; });
+            }
+            return false; });
+        return false; });
+}
+
+// ==================== Scope Analyzer ====================
+class ScopeAnalyzer
+{
+public:
+    struct Definition
+    {
+        AstNode *node; // FunctionNode or ClassNode
+        std::string qualifiedName;
+    };
+
+    ScopeAnalyzer(const std::set<std::string> &clobbered, const std::string &prefix, bool builtinRange)
+        : clobbered(clobbered), prefix(prefix), builtinRange(builtinRange) {}
+
+    void analyze(const std::vector<AstNode *> &statements)
+    {
+        FlowState state;
+        block(statements, state);
+    }
+
+    std::vector<Definition> definitions;
+
+private:
+    struct LoopContext
+    {
+        FlowState breaks = unreachableState();
+        FlowState continues = unreachableState();
+    };
+
+    const std::set<std::string> &clobbered;
+    std::string prefix;
+    bool builtinRange; // `range` is never rebound, so range(...) yields ints
+    std::vector<LoopContext> loops;
+    std::set<AstNode *> defined;
+
+    // User code may run here: forget anything it could rebind. A call can
+    // also raise Break/ContinueException into the enclosing loop.
+    void mayCall(FlowState &state)
+    {
+        for (const std::string &name : clobbered)
+            state.types.erase(name);
+        if (!loops.empty())
+        {
+            loops.back().breaks = join(loops.back().breaks, state);
+            loops.back().continues = join(loops.back().continues, state);
+        }
+    }
+
+    void define(AstNode *node, const std::string &name)
+    {
+        if (defined.insert(node).second)
+            definitions.push_back({node, prefix + name});
+    }
+
+    void block(const std::vector<AstNode *> &statements, FlowState &state)
+    {
+        for (AstNode *stmt : statements)
+        {
+            if (!state.reachable)
+                return;
+            statement(stmt, state);
+        }
+    }
+
+    void statement(AstNode *node, FlowState &state)
+    {
+        switch (node->type)
+        {
+        case AstNodeType::Block:
+            block(static_cast<BlockNode *>(node)->statements, state);
+            return;
+        case AstNodeType::Return:
+            if (static_cast<ReturnNode *>(node)->value)
+                expression(static_cast<ReturnNode *>(node)->value, state);
+            state = unreachableState();
+            return;
+        case AstNodeType::Break:
+            if (!loops.empty())
+                loops.back().breaks = join(loops.back().breaks, state);
+            state = unreachableState();
+            return;
+        case AstNodeType::Continue:
+            if (!loops.empty())
+                loops.back().continues = join(loops.back().continues, state);
+            state = unreachableState();
+            return;
+        case AstNodeType::If:
+            ifStatement(static_cast<IfNode *>(node), state);
+            return;
+        case AstNodeType::While:
+            whileStatement(static_cast<WhileNode *>(node), state);
+            return;
+        case AstNodeType::For:
+            forStatement(static_cast<ForNode *>(node), state);
+            return;
+        case AstNodeType::Function:
+        {
+            auto func = static_cast<FunctionNode *>(node);
+            state.types.erase(func->name);
+            define(func, func->name);
+            return;
+        }
+        case AstNodeType::Class:
+        {
+            // The body runs now, in a scope that can rebind ours
+            auto klass = static_cast<ClassNode *>(node);
+            mayCall(state);
+            state.types.erase(klass->name);
+            define(klass, klass->name);
+            return;
+        }
+        default:
+            expression(node, state);
+            return;
+        }
+    }
+
+    void ifStatement(IfNode *node, FlowState &state)
+    {
+        expression(node->condition, state);
+        FlowState thenState = state;
+        statement(node->thenBranch, thenState);
+        FlowState merged = thenState;
+
+        for (auto &elifPair : node->elifBranches)
+        {
+            expression(elifPair.first, state);
+            FlowState branchState = state;
+            statement(elifPair.second, branchState);
+            merged = join(merged, branchState);
+        }
+
+        if (node->elseBranch)
+            statement(node->elseBranch, state);
+        state = join(merged, state);
+    }
+
+    void whileStatement(WhileNode *node, FlowState &state)
+    {
+        // Iterate to a fixpoint at the loop head. Annotations written by
+        // the final (converged) iteration are the ones that stick.
+        FlowState entry = state;
+        FlowState head = entry;
+        FlowState exit;
+        while (true)
+        {
+            loops.push_back(LoopContext());
+            FlowState condState = head;
+            expression(node->condition, condState);
+            FlowState bodyState = condState;
+            statement(node->body, bodyState);
+            LoopContext context = loops.back();
+            loops.pop_back();
+
+            FlowState next = join(entry, join(bodyState, context.continues));
+            if (next == head)
+            {
+                exit = join(condState, context.breaks);
+                break;
+            }
+            head = next;
+        }
+        state = exit;
+    }
+
+    static void bind(FlowState &state, const std::string &name, StaticType type)
+    {
+        if (type == StaticType::Unknown)
+            state.types.erase(name);
+        else
+            state.types[name] = type;
+    }
+
+    // Same fixpoint as whileStatement; the target is bound at the top of
+    // every iteration and keeps its previous type if the loop runs zero
+    // times
+    void forStatement(ForNode *node, FlowState &state)
+    {
+        StaticType iterable = expression(node->iterable, state);
+        StaticType element = StaticType::Unknown;
+        if (builtinRange && isRangeCall(node->iterable))
+            element = StaticType::Int;
+        else if (iterable == StaticType::Str)
+            element = StaticType::Str;
+
+        FlowState entry = state;
+        FlowState head = entry;
+        while (true)
+        {
+            loops.push_back(LoopContext());
+            FlowState bodyState = head;
+            bind(bodyState, node->target.lexeme, element);
+            statement(node->body, bodyState);
+            LoopContext context = loops.back();
+            loops.pop_back();
+
+            FlowState next = join(entry, join(bodyState, context.continues));
+            if (next == head)
+            {
+                state = join(head, context.breaks);
+                return;
+            }
+            head = next;
+        }
+    }
+
+    StaticType expression(AstNode *node, FlowState &state)
+    {
+        StaticType type = StaticType::Unknown;
+
+        switch (node->type)
+        {
+        case AstNodeType::Int:
+            type = StaticType::Int;
+            break;
+        case AstNodeType::Float:
+            type = StaticType::Float;
+            break;
+        case AstNodeType::String:
+            type = StaticType::Str;
+            break;
+        case AstNodeType::FString:
+            for (const FStringSegment &segment : static_cast<FStringNode *>(node)->segments)
+                if (segment.expression)
+                    expression(segment.expression, state);
+            type = StaticType::Str;
+            break;
+        case AstNodeType::Boolean:
+            type = StaticType::Bool;
+            break;
+        case AstNodeType::Null:
+            type = StaticType::None;
+            break;
+        case AstNodeType::Name:
+        {
+            auto it = state.types.find(static_cast<NameNode *>(node)->name.lexeme);
+            if (it != state.types.end())
+                type = it->second;
+            break;
+        }
+        case AstNodeType::BinaryOp:
+        {
+            auto binary = static_cast<BinaryOpNode *>(node);
+            StaticType left = expression(binary->left, state);
+            StaticType right = expression(binary->right, state);
+            type = binaryResult(binary->op.type, left, right);
+            // int ** int is a float when the exponent is negative
+            if (binary->op.type == TokenType::DoubleStar && type == StaticType::Int &&
+                !isNonNegativeLiteral(binary->right))
+                type = StaticType::Unknown;
+            // An instance on the left dispatches to a magic method
+            if (left == StaticType::Unknown && binary->op.type != TokenType::And &&
+                binary->op.type != TokenType::Or)
+                mayCall(state);
+            break;
+        }
+        case AstNodeType::UnaryOp:
+        {
+            auto unary = static_cast<UnaryOpNode *>(node);
+            type = unaryResult(unary->op.type, expression(unary->operand, state));
+            break;
+        }
+        case AstNodeType::Assign:
+        {
+            auto assign = static_cast<AssignNode *>(node);
+            type = expression(assign->value, state);
+            bind(state, assign->name.lexeme, type);
+            break;
+        }
+        case AstNodeType::AugAssign:
+        {
+            // The operation reads the target; a Name target takes the result
+            auto aug = static_cast<AugAssignNode *>(node);
+            type = expression(aug->operation, state);
+            if (aug->target->type == AstNodeType::Name)
+                bind(state, static_cast<NameNode *>(aug->target)->name.lexeme, type);
+            break;
+        }
+        case AstNodeType::PropertyAssign:
+        {
+            auto assign = static_cast<PropertyAssignNode *>(node);
+            expression(assign->object, state);
+            type = expression(assign->value, state);
+            break;
+        }
+        case AstNodeType::Print:
+            expression(static_cast<PrintNode *>(node)->expression, state);
+            break;
+        case AstNodeType::Property:
+            expression(static_cast<PropertyNode *>(node)->object, state);
+            break;
+        case AstNodeType::List:
+            for (AstNode *element : static_cast<ListNode *>(node)->elements)
+                expression(element, state);
+            break;
+        case AstNodeType::Dict:
+        {
+            auto dict = static_cast<DictNode *>(node);
+            for (size_t i = 0; i < dict->keys.size(); ++i)
+            {
+                expression(dict->keys[i], state);
+                expression(dict->values[i], state);
+            }
+            break;
+        }
+        case AstNodeType::Subscript:
+        {
+            // Elements are not tracked, so the result stays Unknown
+            auto subscript = static_cast<SubscriptNode *>(node);
+            expression(subscript->object, state);
+            expression(subscript->index, state);
+            break;
+        }
+        case AstNodeType::Slice:
+        {
+            auto slice = static_cast<SliceNode *>(node);
+            for (AstNode *part : {slice->start, slice->stop, slice->step})
+                if (part)
+                    expression(part, state);
+            break;
+        }
+        case AstNodeType::SubscriptAssign:
+        {
+            auto assign = static_cast<SubscriptAssignNode *>(node);
+            expression(assign->object, state);
+            expression(assign->index, state);
+            type = expression(assign->value, state);
+            break;
+        }
+        case AstNodeType::Tuple:
+            for (AstNode *element : static_cast<TupleNode *>(node)->elements)
+                expression(element, state);
+            break;
+        case AstNodeType::UnpackAssign:
+        {
+            // Element types are only known when unpacking a tuple literal
+            auto unpack = static_cast<UnpackAssignNode *>(node);
+            std::vector<StaticType> types(unpack->targets.size(), StaticType::Unknown);
+            if (unpack->value->type == AstNodeType::Tuple &&
+                static_cast<TupleNode *>(unpack->value)->elements.size() == types.size())
+            {
+                auto &elements = static_cast<TupleNode *>(unpack->value)->elements;
+                for (size_t i = 0; i < types.size(); ++i)
+                    types[i] = expression(elements[i], state);
+            }
+            else
+            {
+                expression(unpack->value, state);
+            }
+            for (size_t i = 0; i < types.size(); ++i)
+            {
+                AstNode *target = unpack->targets[i];
+                if (target->type == AstNodeType::Name)
+                    bind(state, static_cast<NameNode *>(target)->name.lexeme, types[i]);
+                else
+                    anyChild(target, [&](AstNode *part)
+                             {
+                        expression(part, state);
+                        return false; });
+            }
+            break;
+        }
+        case AstNodeType::Call:
+        {
+            auto call = static_cast<CallNode *>(node);
+            expression(call->callee, state);
+            for (AstNode *arg : call->args)
+                expression(arg, state);
+            mayCall(state);
+            break;
+        }
+        case AstNodeType::InlinedCall:
+        {
+            auto inlined = static_cast<InlinedCallNode *>(node);
+            expression(inlined->call->callee, state);
+            for (AstNode *arg : inlined->call->args)
+                expression(arg, state);
+            mayCall(state);
+
+            // The body runs in the callee's closure, where none of our
+            // facts hold
+            std::vector<LoopContext> outerLoops;
+            outerLoops.swap(loops);
+            FlowState calleeState;
+            expression(inlined->inlined, calleeState);
+            loops.swap(outerLoops);
+            break;
+        }
+        default:
+            break;
+        }
+
+        node->staticType = type;
+        return type;
+    }
+};
+
+// ==================== Loop Variable Reuse ====================
+// A range loop can update one int box in place only if nothing keeps a
+// reference to the box while the loop runs. Reads that just consume the
+// value (arithmetic, comparisons, indexing, printing) are safe; binding
+// it elsewhere, passing it to a call or storing it in a container is not.
+static bool isPrimitive(StaticType type)
+{
+    return type != StaticType::Unknown;
+}
+
+static bool isTarget(AstNode *node, const std::string &name)
+{
+    return node->type == AstNodeType::Name && static_cast<NameNode *>(node)->name.lexeme == name;
+}
+
+static bool consumesValue(AstNode *parent, AstNode *child)
+{
+    switch (parent->type)
+    {
+    case AstNodeType::BinaryOp:
+    {
+        // and/or return an operand; a non-primitive left operand may pass
+        // the right one to a magic method
+        auto binary = static_cast<BinaryOpNode *>(parent);
+        if (binary->op.type == TokenType::And || binary->op.type == TokenType::Or)
+            return false;
+        return child == binary->left || isPrimitive(binary->left->staticType);
+    }
+    case AstNodeType::UnaryOp:
+    case AstNodeType::Print:
+    case AstNodeType::If:
+    case AstNodeType::While:
+        return true;
+    case AstNodeType::Subscript:
+        return child == static_cast<SubscriptNode *>(parent)->index;
+    default:
+        return false;
+    }
+}
+
+static bool targetMayEscape(AstNode *node, const std::string &name)
+{
+    return anyChild(node, [&](AstNode *child)
+                    {
+        if (isTarget(child, name))
+            return !consumesValue(node, child);
+        if (child->type == AstNodeType::Function || child->type == AstNodeType::Class)
+            return true;
+        bool rebinds = false;
+        forEachAssignedName(child, [&](const std::string &bound)
+                            { rebinds = rebinds || bound == name; });
+        return rebinds || targetMayEscape(child, name); });
+}
+
+// Whether evaluating `node` can run user code, which could read the
+// variable from an enclosing scope
+static bool mayRunUserCode(AstNode *node, bool builtinRange)
+{
+    return anyNode(node, [builtinRange](AstNode *n)
+                   {
+        if (n->type == AstNodeType::Call)
+            return !(builtinRange && isRangeCall(n));
+        if (n->type == AstNodeType::InlinedCall)
+            return true;
+        if (n->type != AstNodeType::BinaryOp)
+            return false;
+        auto binary = static_cast<BinaryOpNode *>(n);
+        return binary->op.type != TokenType::And && binary->op.type != TokenType::Or &&
+               !isPrimitive(binary->left->staticType); });
+}
+
+// Decides TargetReuse for the loops that run directly in one scope.
+// Inside a function with no nested functions or classes, nothing but
+// the function itself can see its frame.
+static void decideTargetReuse(AstNode *scope, bool privateFrame, bool builtinRange)
+{
+    walkScope(scope, [privateFrame, builtinRange](AstNode *n)
+              {
+        if (n->type != AstNodeType::For)
+            return;
+        auto loop = static_cast<ForNode *>(n);
+        if (targetMayEscape(loop->body, loop->target.lexeme))
+            loop->reuse = TargetReuse::Never;
+        else if (!mayRunUserCode(loop->body, builtinRange))
+            loop->reuse = TargetReuse::Always;
+        else
+            loop->reuse = privateFrame ? TargetReuse::IfLocal : TargetReuse::Never; });
+}
+
+// ==================== Augmented Assignment ====================
+// `x op= value` finds x's binding once unless the value binds names, which
+// could move it. An Int or Float result may also overwrite the box the
+// statement stored last time if no reference to x's value can leave the
+// frame: every read of x in the function just consumes it.
+static bool valueMayEscape(AstNode *node, const std::string &name)
+{
+    return anyChild(node, [&](AstNode *child)
+                    {
+        if (isTarget(child, name))
+            return !consumesValue(node, child);
+        if (child->type == AstNodeType::Function || child->type == AstNodeType::Class)
+            return true;
+        return valueMayEscape(child, name); });
+}
+
+static bool bindsNames(AstNode *node)
+{
+    return anyNode(node, [](AstNode *n)
+                   {
+        bool binds = false;
+        forEachAssignedName(n, [&binds](const std::string &) { binds = true; });
+        return binds; });
+}
+
+static void decideAugmentedAssignments(AstNode *scope, bool privateFrame)
+{
+    walkScope(scope, [scope, privateFrame](AstNode *n)
+              {
+        if (n->type != AstNodeType::AugAssign)
+            return;
+        auto aug = static_cast<AugAssignNode *>(n);
+        if (aug->target->type != AstNodeType::Name)
+            return;
+        StaticType type = aug->operation->staticType;
+        aug->stableBinding = !bindsNames(aug->operation->right);
+        aug->reuseBox = privateFrame && (type == StaticType::Int || type == StaticType::Float) &&
+                        !valueMayEscape(scope, static_cast<NameNode *>(aug->target)->name.lexeme); });
+}
+
+// ==================== TypeInferencePass ====================
+static bool isSpecialized(StaticType type)
+{
+    return type == StaticType::Int || type == StaticType::Float || type == StaticType::Bool;
+}
+
+bool TypeInferencePass::run(ProgramNode *program)
+{
+    anyNode(program, [](AstNode *n)
+            {
+        n->staticType = StaticType::Unknown;
+        return false; });
+
+    // Variables that can exist outside a function's own frame: globals and
+    // class attributes. Assigning one of these inside any function or class
+    // body rebinds it for everybody.
+    std::set<std::string> sharedNames;
+    collectScopeBindings(program, sharedNames);
+    anyNode(program, [&sharedNames](AstNode *n)
+            {
+        if (n->type == AstNodeType::Class)
+            collectScopeBindings(static_cast<ClassNode *>(n)->body, sharedNames);
+        return false; });
+
+    std::set<std::string> assignedInBodies;
+    collectNestedAssignments(program, assignedInBodies);
+
+    bool builtinRange = !anyNode(program, [](AstNode *n)
+                                 {
+        bool rebinds = false;
+        forEachAssignedName(n, [&rebinds](const std::string &name)
+                            { rebinds = rebinds || name == "range"; });
+        if (rebinds)
+            return true;
+        if (n->type == AstNodeType::Function)
+        {
+            auto func = static_cast<FunctionNode *>(n);
+            for (const std::string &param : func->params)
+                if (param == "range")
+                    return true;
+            return func->name == "range";
+        }
+        return n->type == AstNodeType::Class && static_cast<ClassNode *>(n)->name == "range"; });
+
+    ScopeAnalyzer global(assignedInBodies, "", builtinRange);
+    global.analyze(program->statements);
+    decideTargetReuse(program, false, builtinRange);
+    decideAugmentedAssignments(program, false);
+
+    struct Pending
+    {
+        ScopeAnalyzer::Definition definition;
+        bool nested; // defined inside a function body
+    };
+    std::vector<Pending> worklist;
+    for (auto &definition : global.definitions)
+        worklist.push_back({definition, false});
+
+    std::vector<std::pair<std::string, FunctionNode *>> functions;
+    while (!worklist.empty())
+    {
+        Pending item = worklist.back();
+        worklist.pop_back();
+        AstNode *node = item.definition.node;
+        std::string qualified = item.definition.qualifiedName;
+
+        // Functions nested in another function may see that function's
+        // locals, so anything assigned in any body can affect them
+        std::set<std::string> clobbered = assignedInBodies;
+        if (!item.nested)
+        {
+            clobbered.clear();
+            for (const std::string &name : assignedInBodies)
+                if (sharedNames.count(name))
+                    clobbered.insert(name);
+            collectNestedAssignments(node, clobbered);
+        }
+
+        ScopeAnalyzer analyzer(clobbered, qualified + ".", builtinRange);
+        bool isFunction = node->type == AstNodeType::Function;
+        if (isFunction)
+        {
+            auto func = static_cast<FunctionNode *>(node);
+            analyzer.analyze(static_cast<BlockNode *>(func->body)->statements);
+            functions.push_back({qualified, func});
+            bool nestedScopes = anyChild(func->body, [](AstNode *child)
+                                         { return anyNode(child, [](AstNode *n)
+                                                          { return n->type == AstNodeType::Function ||
+                                                                   n->type == AstNodeType::Class; }); });
+            decideTargetReuse(func->body, !nestedScopes, builtinRange);
+            decideAugmentedAssignments(func->body, !nestedScopes);
+        }
+        else
+        {
+            AstNode *body = static_cast<ClassNode *>(node)->body;
+            analyzer.analyze(static_cast<BlockNode *>(body)->statements);
+            decideTargetReuse(body, false, builtinRange);
+            decideAugmentedAssignments(body, false);
+        }
+
+        for (auto &definition : analyzer.definitions)
+            worklist.push_back({definition, item.nested || isFunction});
+    }
+
+    if (verbose)
+    {
+        for (auto &entry : functions)
+        {
+            size_t operations = 0, specialized = 0;
+            walkScope(entry.second->body, [&](AstNode *n)
+                      {
+                if (n->type != AstNodeType::BinaryOp && n->type != AstNodeType::UnaryOp)
+                    return;
+                operations++;
+                if (isSpecialized(n->staticType))
+                    specialized++; });
+
+            if (operations == 0)
+                continue;
+            std::cerr << "[types] " << entry.first << ": ";
+            if (specialized == operations)
+                std::cerr << "fully specialized (" << operations << " operations)\n";
+            else
+                std::cerr << specialized << "/" << operations << " operations specialized\n";
+        }
+    }
+
+    return false;
+}
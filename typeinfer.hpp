@@ -0,0 +1,25 @@
+#pragma once
+
+#include "optimizer.hpp"
+
+// ==================== Type Inference ====================
+// Flow-sensitive analysis that proves the runtime type of variables and
+// expressions without executing anything, and records the result in
+// AstNode::staticType. The interpreter evaluates proven int/float/bool
+// expressions with native arithmetic and only boxes the final value.
+//
+// Each function body is analysed on its own; parameters, attributes and
+// call results are Unknown. A variable loses its type at any point that
+// may run user code (calls, operators on non-primitive operands, class
+// bodies) if some function or class body could rebind it.
+class TypeInferencePass : public OptimizationPass
+{
+public:
+    TypeInferencePass(bool verbose) : verbose(verbose) {}
+    const char *name() const override { return "type-inference"; }
+    // Annotates only; never changes the shape of the tree
+    bool run(ProgramNode *program) override;
+
+private:
+    bool verbose;
+};
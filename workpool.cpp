@@ -0,0 +1,133 @@
+#include "workpool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+static constexpr size_t noWorker = SIZE_MAX;
+static thread_local size_t runningWorker = noWorker;
+
+WorkPool::WorkPool(size_t threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < threads; ++i)
+        queues.push_back(std::make_unique<Queue>());
+    for (size_t i = 1; i < threads; ++i)
+        this->threads.emplace_back(&WorkPool::workerLoop, this, i);
+}
+
+WorkPool::~WorkPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+bool WorkPool::insideTask()
+{
+    return runningWorker != noWorker;
+}
+
+size_t WorkPool::worker()
+{
+    return runningWorker;
+}
+
+void WorkPool::run(size_t count, const std::function<void(size_t)> &task)
+{
+    if (count == 0)
+        return;
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        current = &task;
+        remaining = count;
+        failure = nullptr;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Queue &queue = *queues[i % queues.size()];
+            std::lock_guard<std::mutex> queueGuard(queue.lock);
+            queue.tasks.push_back(i);
+        }
+        ++generation;
+    }
+    wake.notify_all();
+
+    drain(0);
+    std::unique_lock<std::mutex> lock(stateLock);
+    finished.wait(lock, [this] { return remaining == 0; });
+    current = nullptr;
+    if (failure)
+        std::rethrow_exception(std::exchange(failure, nullptr));
+}
+
+// The front of our own deque, else the back of the first non-empty one
+// after ours
+bool WorkPool::take(size_t self, size_t &task)
+{
+    {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset)
+    {
+        Queue &victim = *queues[(self + offset) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkPool::drain(size_t self)
+{
+    size_t task;
+    while (take(self, task))
+    {
+        runningWorker = self;
+        try
+        {
+            (*current)(task);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            if (!failure)
+                failure = std::current_exception();
+        }
+        runningWorker = noWorker;
+
+        std::lock_guard<std::mutex> guard(stateLock);
+        if (--remaining == 0)
+            finished.notify_all();
+    }
+}
+
+void WorkPool::workerLoop(size_t self)
+{
+    size_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(stateLock);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+        drain(self);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ==================== Work-Stealing Pool ====================
+// Fixed set of worker threads that run batches of indexed tasks. run()
+// deals the indices out round-robin, one deque per worker, and the
+// calling thread works as one of them. A worker takes its own tasks from
+// the front, lowest index first, and when its deque is empty steals from
+// the back of another's. Tasks of very different lengths thus still keep
+// every thread busy, while the lowest indices tend to finish first.
+// Deques are touched once per task, so a plain mutex on each is enough.
+class WorkPool
+{
+public:
+    // `threads` counts the caller; 0 means one per hardware thread
+    explicit WorkPool(size_t threads);
+    ~WorkPool();
+    WorkPool(const WorkPool &) = delete;
+    WorkPool &operator=(const WorkPool &) = delete;
+
+    size_t size() const { return queues.size(); }
+
+    // Runs task(i) for every i in [0, count) and returns once all have
+    // finished. If tasks throw, the remaining ones still run and the first
+    // exception is rethrown here. Not reentrant: a task must not call
+    // run() on the same pool.
+    void run(size_t count, const std::function<void(size_t)> &task);
+
+    // Whether the calling thread is running a task of some pool
+    static bool insideTask();
+    // Index in [0, size()) of the pool thread running the calling task,
+    // 0 being the caller of run(); meaningful only inside a task
+    static size_t worker();
+
+private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    bool take(size_t self, size_t &task);
+    void drain(size_t self);
+    void workerLoop(size_t self);
+
+    std::vector<std::unique_ptr<Queue>> queues; // Queue 0 belongs to the caller of run()
+    std::vector<std::thread> threads;
+
+    std::mutex stateLock;
+    std::condition_variable wake;     // A batch was posted, or the pool is stopping
+    std::condition_variable finished; // The last task of the batch finished
+    const std::function<void(size_t)> *current = nullptr;
+    size_t generation = 0;
+    size_t remaining = 0;
+    std::exception_ptr failure;
+    bool stopping = false;
+};